@@ -10,6 +10,9 @@
 // OpenMP
 #include <omp.h>
 
+// Local
+#include "../../Profiling/PerfCounters.h"
+
 #define CUTOFF 100  // arbitrary
 
 template<typename T>
@@ -38,6 +41,8 @@ class RecursiveTransformEngine {
     }
 	#pragma omp parallel
     {
+      //Each thread counts the tasks it executes
+      PERF_SCOPE("RecursiveTransformEngine::Launch");
       #pragma omp single nowait
       {
 		RecurseTransform(src, size, dst, op);
@@ -96,6 +101,8 @@ class RecursiveTransformEngine {
 
 //Compile with openmp support using
 //g++ ./test.cpp -o test -fopenmp
+//Per thread hardware counters are reported at exit when compiled with
+//g++ ./test.cpp -o test -fopenmp -DUSE_PERF_COUNTERS
 int main( int argc, char* argv[]) {
 
   std::vector<float> v(1<<24,1);
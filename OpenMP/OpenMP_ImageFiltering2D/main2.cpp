@@ -17,19 +17,27 @@
 #include <algorithm>
 #include <functional>
 #include <numeric>
-#include <chrono>
+#include <vector>
+
+//Local
+#include "../../Profiling/Benchmark.h"
+#include "../../Profiling/PerfCounters.h"
 
 #define SIZEX 1024
 #define SIZEY 1024
 #define KERX 1
 #define KERY 1
-#define NRUN 100
 
 //Compile using
 //g++ ./main2.cpp -O3 -std=c++11 -fopenmp -o test
 
 //Execute using
 //OMP_NUM_THREADS=4 ./test
+//or, restricting threads to the first 4 cores and saving results
+//OMP_NUM_THREADS=4 OMP_PROC_BIND=close ./test --cpu 0-3 --json filtering.json
+
+//Per thread hardware counters of every variant are reported at exit with
+//g++ ./main2.cpp -O3 -std=c++14 -fopenmp -DUSE_PERF_COUNTERS -o test
 
 /*
  * This code intend to benchmark various flavour of the small image
@@ -43,6 +51,7 @@
  */
 bool PerformWorkSequentially( const std::vector<float>& vec, std::vector<float>& out )
 {
+	PERF_SCOPE("PerformWorkSequentially");
 	for(int j=0; j<SIZEY; j++ )
 	{
 		for(int i = 0; i<SIZEX; i++ )
@@ -75,27 +84,32 @@ bool PerformWorkSequentially( const std::vector<float>& vec, std::vector<float>&
  */
 bool PerformWorkNaiveOMP( const std::vector<float>& vec, std::vector<float>& out )
 {
-	#pragma omp parallel for
-	for(int j=0; j<SIZEY; j++ )
+	#pragma omp parallel
 	{
-		for(int i = 0; i<SIZEX; i++ )
+		//Each thread counts its own share of the work
+		PERF_SCOPE("PerformWorkNaiveOMP");
+		#pragma omp for
+		for(int j=0; j<SIZEY; j++ )
 		{
-			float sum = 0;
-			for(int j2 = -KERY; j2<=KERY; j2++ )
+			for(int i = 0; i<SIZEX; i++ )
 			{
-				for(int i2 = -KERX; i2<=KERX; i2++ )
+				float sum = 0;
+				for(int j2 = -KERY; j2<=KERY; j2++ )
 				{
-					int idX = i+i2;
-					int idY = j+j2;
-					if( ( idX >= 0 ) && ( idX < SIZEX ) &&
-						( idY >= 0 ) && ( idY < SIZEY ) )
+					for(int i2 = -KERX; i2<=KERX; i2++ )
 					{
-						out[i+j*SIZEX] += vec[idX+idY*SIZEX];
-						sum = sum+1;
+						int idX = i+i2;
+						int idY = j+j2;
+						if( ( idX >= 0 ) && ( idX < SIZEX ) &&
+							( idY >= 0 ) && ( idY < SIZEY ) )
+						{
+							out[i+j*SIZEX] += vec[idX+idY*SIZEX];
+							sum = sum+1;
+						}
 					}
 				}
+				out[i+j*SIZEX] /= sum;
 			}
-			out[i+j*SIZEX] /= sum;
 		}
 	}
 	return true;
@@ -110,27 +124,32 @@ bool PerformWorkNaiveOMP( const std::vector<float>& vec, std::vector<float>& out
  */
 bool PerformWorkCollapseOMP( const std::vector<float>& vec, std::vector<float>& out )
 {
-	#pragma omp parallel for collapse(2)
-	for(int j=0; j<SIZEY; j++ )
+	#pragma omp parallel
 	{
-		for(int i = 0; i<SIZEX; i++ )
+		//Each thread counts its own share of the work
+		PERF_SCOPE("PerformWorkCollapseOMP");
+		#pragma omp for collapse(2)
+		for(int j=0; j<SIZEY; j++ )
 		{
-			float sum = 0;
-			for(int j2 = -KERY; j2<=KERY; j2++ )
+			for(int i = 0; i<SIZEX; i++ )
 			{
-				for(int i2 = -KERX; i2<=KERX; i2++ )
+				float sum = 0;
+				for(int j2 = -KERY; j2<=KERY; j2++ )
 				{
-					int idX = i+i2;
-					int idY = j+j2;
-					if( ( idX >= 0 ) && ( idX < SIZEX ) &&
-						( idY >= 0 ) && ( idY < SIZEY ) )
+					for(int i2 = -KERX; i2<=KERX; i2++ )
 					{
-						out[i+j*SIZEX] += vec[idX+idY*SIZEX];
-						sum = sum+1;
+						int idX = i+i2;
+						int idY = j+j2;
+						if( ( idX >= 0 ) && ( idX < SIZEX ) &&
+							( idY >= 0 ) && ( idY < SIZEY ) )
+						{
+							out[i+j*SIZEX] += vec[idX+idY*SIZEX];
+							sum = sum+1;
+						}
 					}
 				}
+				out[i+j*SIZEX] /= sum;
 			}
-			out[i+j*SIZEX] /= sum;
 		}
 	}
 	return true;
@@ -150,39 +169,44 @@ bool PerformWorkCollapseOMP( const std::vector<float>& vec, std::vector<float>&
  */
 bool PerformWorkCacheOMP( const std::vector<float>& vec, std::vector<float>& out )
 {
-	#pragma omp parallel for
-	for(int j=1; j<SIZEY-1; j++ )
+	#pragma omp parallel
 	{
-		//First 2 columns
-		float a0 = vec[(j-1)*SIZEX];
-		float a1 = vec[(j)*SIZEX];
-		float a2 = vec[(j+1)*SIZEX];
+		//Each thread counts its own share of the work
+		PERF_SCOPE("PerformWorkCacheOMP");
+		#pragma omp for
+		for(int j=1; j<SIZEY-1; j++ )
+		{
+			//First 2 columns
+			float a0 = vec[(j-1)*SIZEX];
+			float a1 = vec[(j)*SIZEX];
+			float a2 = vec[(j+1)*SIZEX];
 
-		//Second column
-		float b0 = vec[(j-1)*SIZEX+1];
-		float b1 = vec[(j)*SIZEX+1];
-		float b2 = vec[(j+1)*SIZEX+1];
+			//Second column
+			float b0 = vec[(j-1)*SIZEX+1];
+			float b1 = vec[(j)*SIZEX+1];
+			float b2 = vec[(j+1)*SIZEX+1];
 
-		for(int i = 1; i<SIZEX; i++ )
-		{
-			//third column
-			float c0 = vec[(j-1)*SIZEX+i+1];
-			float c1 = vec[(j)*SIZEX+i+1];
-			float c2 = vec[(j+1)*SIZEX+i+1];
+			for(int i = 1; i<SIZEX; i++ )
+			{
+				//third column
+				float c0 = vec[(j-1)*SIZEX+i+1];
+				float c1 = vec[(j)*SIZEX+i+1];
+				float c2 = vec[(j+1)*SIZEX+i+1];
 
-			//Computations : make a simple sum
-			out[i+j*SIZEX] = (a0+a1+a2+b0+b1+b2+c0+c1+c2)/9.0f;
+				//Computations : make a simple sum
+				out[i+j*SIZEX] = (a0+a1+a2+b0+b1+b2+c0+c1+c2)/9.0f;
 
-			//At the end of the computation, we need to
-			//swap the 2 first lines
-			a0 = b0;
-			a1 = b1;
-			a2 = b2;
+				//At the end of the computation, we need to
+				//swap the 2 first lines
+				a0 = b0;
+				a1 = b1;
+				a2 = b2;
 
-			//Second column
-			b0 = c0;
-			b1 = c1;
-			b2 = c2;
+				//Second column
+				b0 = c0;
+				b1 = c1;
+				b2 = c2;
+			}
 		}
 	}
 	return true;
@@ -196,113 +220,78 @@ bool PerformWorkCacheOMP( const std::vector<float>& vec, std::vector<float>& out
  */
 bool PerformWorkCache2OMP( const std::vector<float>& vec, std::vector<float>& out )
 {
-	#pragma omp parallel for
-	for(int j=1; j<SIZEY-1; j++ )
+	#pragma omp parallel
 	{
-		//First 2 columns
-		float a0 = vec[(j-1)*SIZEX]+vec[(j)*SIZEX]+vec[(j+1)*SIZEX];
+		//Each thread counts its own share of the work
+		PERF_SCOPE("PerformWorkCache2OMP");
+		#pragma omp for
+		for(int j=1; j<SIZEY-1; j++ )
+		{
+			//First 2 columns
+			float a0 = vec[(j-1)*SIZEX]+vec[(j)*SIZEX]+vec[(j+1)*SIZEX];
 
-		//Second column
-		float b0 = vec[(j-1)*SIZEX+1]+vec[(j)*SIZEX+1]+vec[(j+1)*SIZEX+1];
+			//Second column
+			float b0 = vec[(j-1)*SIZEX+1]+vec[(j)*SIZEX+1]+vec[(j+1)*SIZEX+1];
 
-		for(int i = 1; i<SIZEX; i++ )
-		{
-			//third column
-			float c0 = vec[(j-1)*SIZEX+i+1]+vec[(j)*SIZEX+i+1]+vec[(j+1)*SIZEX+i+1];
+			for(int i = 1; i<SIZEX; i++ )
+			{
+				//third column
+				float c0 = vec[(j-1)*SIZEX+i+1]+vec[(j)*SIZEX+i+1]+vec[(j+1)*SIZEX+i+1];
 
-			//Computations : make a simple sum
-			out[i+j*SIZEX] = (a0+b0+c0)/9.0f;
+				//Computations : make a simple sum
+				out[i+j*SIZEX] = (a0+b0+c0)/9.0f;
 
-			//At the end of the computation, we need to
-			//swap the 2 first lines
-			a0 = b0;
+				//At the end of the computation, we need to
+				//swap the 2 first lines
+				a0 = b0;
 
-			//Second column
-			b0 = c0;
+				//Second column
+				b0 = c0;
+			}
 		}
 	}
 	return true;
 }
 
-int main()
+int main( int argc, char* argv[] )
 {
+	BenchmarkRunner runner( argc, argv );
 	std::vector<float> vec(SIZEX*SIZEY,1.);
 	std::vector<float> out(SIZEX*SIZEY,0.);
 
-	auto start = std::chrono::steady_clock::now();
-	auto stop = std::chrono::steady_clock::now();
-	auto diff = stop - start;
-	double msec = 0;
+	//9 additions and one division per pixel, one read and one write
+	const double bytes = 2.0*SIZEX*SIZEY*sizeof(float);
+	const double flops = 10.0*SIZEX*SIZEY;
 
-	for(int k = 0; k< NRUN; k++)
+	//Output is not reset between runs, it does not change the amount of work
+	double seqMsec = runner.Run( "sequential", [&]()
 	{
-		start = std::chrono::steady_clock::now();
 		PerformWorkSequentially(vec, out);
-		stop = std::chrono::steady_clock::now();
-		diff = stop - start;
-		msec += std::chrono::duration<double, std::milli>(diff).count();
-		//Reset to zero before the next run
-		std::fill( out.begin(), out.end(), 0.);
-	}
-	double seqMsec = msec/(double)NRUN;
-	std::cout << "Runtime for sequential version is "<< seqMsec << " msec "<< std::endl;
-	msec = 0;
+	}, bytes, flops ).median;
 
-	for(int k = 0; k< NRUN; k++)
+	double Nsec = runner.Run( "naive omp", [&]()
 	{
-		start = std::chrono::steady_clock::now();
 		PerformWorkNaiveOMP(vec, out);
-		stop = std::chrono::steady_clock::now();
-		diff = stop - start;
-		msec += std::chrono::duration<double, std::milli>(diff).count();
-		//Reset to zero before the next run
-		std::fill( out.begin(), out.end(), 0.);
-	}
-	double Nsec = msec/(double)NRUN;
+	}, bytes, flops ).median;
 	std::cout << "Acceleration for Naive OMP  is "<< seqMsec/Nsec << std::endl;
-	msec = 0;
 
-	for(int k = 0; k< NRUN; k++)
+	Nsec = runner.Run( "collapse omp", [&]()
 	{
-		start = std::chrono::steady_clock::now();
 		PerformWorkCollapseOMP(vec, out);
-		stop = std::chrono::steady_clock::now();
-		diff = stop - start;
-		msec += std::chrono::duration<double, std::milli>(diff).count();
-		//Reset to zero before the next run
-		std::fill( out.begin(), out.end(), 0.);
-	}
-	Nsec = msec/(double)NRUN;
+	}, bytes, flops ).median;
 	std::cout << "Acceleration for collapse OMP  is "<< seqMsec/Nsec << std::endl;
-	msec = 0;
 
-	for(int k = 0; k< NRUN; k++)
+	Nsec = runner.Run( "cache omp", [&]()
 	{
-		start = std::chrono::steady_clock::now();
 		PerformWorkCacheOMP(vec, out);
-		stop = std::chrono::steady_clock::now();
-		diff = stop - start;
-		msec += std::chrono::duration<double, std::milli>(diff).count();
-		//Reset to zero before the next run
-		std::fill( out.begin(), out.end(), 0.);
-	}
-	Nsec = msec/(double)NRUN;
+	}, bytes, flops ).median;
 	std::cout << "Acceleration for Cache OMP  is "<< seqMsec/Nsec << std::endl;
-	msec = 0;
 
-	for(int k = 0; k< NRUN; k++)
+	Nsec = runner.Run( "cache 2 omp", [&]()
 	{
-		start = std::chrono::steady_clock::now();
 		PerformWorkCache2OMP(vec, out);
-		stop = std::chrono::steady_clock::now();
-		diff = stop - start;
-		msec += std::chrono::duration<double, std::milli>(diff).count();
-		//Reset to zero before the next run
-		std::fill( out.begin(), out.end(), 0.);
-	}
-	Nsec = msec/(double)NRUN;
+	}, bytes, flops ).median;
 	std::cout << "Acceleration for Cache 2 OMP  is "<< seqMsec/Nsec << std::endl;
-	msec = 0;
 
 	//Optionally check
 	/*PerformWorkCache2OMP(vec, out);
@@ -315,5 +304,5 @@ int main()
 		std::cout << std::endl;
 	}*/
 
-	return 0;
+	return runner.Finish() ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -13,18 +13,21 @@
 #include <algorithm>
 #include <functional>
 #include <numeric>
-#include <chrono>
 
 
 //Boost
 #include <boost/iterator/transform_iterator.hpp>
 #include <boost/iterator/counting_iterator.hpp>
 
+//Local
+#include "../../Profiling/Benchmark.h"
+
 //Compile using
 //g++ ./main2.cpp -O3 -o test -fopenmp -std=c++11
 
 //Run for instance using 4 Threads using
 //OMP_NUM_THREADS=4 ./test
+//Results can be saved with ./test --json integration.json
 
 /*
  * This new version is way more compact than the one in main.cpp
@@ -34,7 +37,6 @@
  * operator, that should be associative is +, and is used over
  * the variable sum
  */
-#define NRUN 20
 
 /*
  * We will use this struct in order to
@@ -55,23 +57,19 @@ struct Integrator
 	const T m_step;
 };
 
-int main()
+int main( int argc, char* argv[] )
 {
+	BenchmarkRunner runner( argc, argv );
 	static const int nb_steps = 100000000;
 	double pi, sum = 0.0, step = 1./nb_steps;
-
-	//Initialize chrono helpers
-	auto start = std::chrono::steady_clock::now();
-	auto stop = std::chrono::steady_clock::now();
-	auto diff = stop - start;
-	double msec=std::numeric_limits<double>::max();	//Set mininum runtime to ridiculously high value
 	Integrator<double> op(step);
 
-	//Perform multiple run in order to get minimal runtime
-	for(int k = 0; k< NRUN; k++)
+	//Per step: 1 add and 1 mul for x, then 1 mul, 1 add, 1 div and the sum
+	const double flops = 6.0*nb_steps;
+
+	runner.Run( "parallel integration", [&]()
 	{
 		sum = 0;
-		start = std::chrono::steady_clock::now();
 
 		//With this construction, no more need to use the explicit integral bound calculation !
 
@@ -88,34 +86,19 @@ int main()
 		{
 			sum += op(i);
 		}
-		stop = std::chrono::steady_clock::now();
-		diff = stop - start;
-		//Compute minimum runtime
-		msec = std::min( msec, std::chrono::duration<double, std::milli>(diff).count() );
-	}
+	}, 0., flops );
 
 	pi = sum*step;
 	std::cout << "Parallel version : Pi has value "<<std::setprecision(10)<<pi<< std::endl;
-	std::cout << "Parallel version : Minimal Runtime was "<< msec << " msec "<< std::endl;
-	msec=std::numeric_limits<double>::max(); //Reset min runtime to ridiculously high value
 
-	//Perform multiple run in order to get minimal runtime
-	for(int k = 0; k< NRUN; k++)
+	runner.Run( "sequential functional integration", [&]()
 	{
-		start = std::chrono::steady_clock::now();
-
 		//Functional way to express the summation
 		sum = std::accumulate( 	boost::make_transform_iterator(boost::make_counting_iterator(0), op ),
 						boost::make_transform_iterator(boost::make_counting_iterator(nb_steps), op ),
 						0.0, std::plus<double>() );
-
-		stop = std::chrono::steady_clock::now();
-		diff = stop - start;
-		//Compute minimum runtime
-		msec = std::min( msec, std::chrono::duration<double, std::milli>(diff).count() );
-	}
+	}, 0., flops );
 	pi = sum*step;
 	std::cout << "Sequential version : Pi has value "<<std::setprecision(10)<<pi<< std::endl;
-	std::cout << "Sequential version : Minimal Runtime was "<< msec << " msec "<< std::endl;
-	return EXIT_SUCCESS;
+	return runner.Finish() ? EXIT_SUCCESS : EXIT_FAILURE;
 }
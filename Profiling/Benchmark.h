@@ -0,0 +1,401 @@
+/*
+ * Benchmark.h
+ *
+ *  Created on: 16 oct. 2026
+ *      Author: gnthibault
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+//STL
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+//System
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+//Local
+#include "Roofline.h"
+
+/*
+ * Small micro benchmark harness shared by the examples, replacing the
+ * hand written min-of-NRUN chrono loops:
+ * - the kernel is first run for a warm-up period (caches, page faults, cpu
+ *   frequency ramp up)
+ * - the number of iterations per sample is then doubled until a sample
+ *   lasts at least MinSampleTime, such that timer resolution is not an issue
+ *   for tiny kernels
+ * - Samples are collected, and the per iteration median, 5th and 95th
+ *   percentiles are reported, along with the minimum
+ * - declared bytes and flops per iteration are converted to GB/s and GFLOP/s
+ * - --cpu pins the process before any measurement, threads spawned
+ *   afterwards, such as OpenMP ones, inherit this affinity
+ * - --json writes all results, along with a description of the host, to a
+ *   file that can be compared across machines and releases
+ * - --roofline first measures the peaks of the host (see Roofline.h), then
+ *   reports for each kernel its arithmetic intensity, the memory level its
+ *   working set fits in, and the achieved fraction of the roof
+ *
+ * Usage:
+ *   BenchmarkRunner runner(argc, argv);
+ *   runner.Run("copy", [&]() { Copy(src, dst, size); }, 2*size*sizeof(float));
+ *   return runner.Finish() ? EXIT_SUCCESS : EXIT_FAILURE;
+ *
+ * Command line options:
+ *   --json <file>       write results as json
+ *   --cpu <list>        cpu affinity, such as 0 or 0-3 or 0,2,4
+ *   --filter <text>     only run benchmarks whose name contains text
+ *   --samples <n>       number of samples (default 21)
+ *   --min-time <msec>   minimum duration of a sample (default 10)
+ *   --warmup <msec>     warm-up duration (default 50)
+ *   --roofline          roofline characterization of every kernel
+ */
+
+/*
+ * Prevent the compiler from optimizing away a result, or from moving
+ * computations out of the timed region
+ */
+template<typename T>
+inline void DoNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline void ClobberMemory() {
+  asm volatile("" : : : "memory");
+}
+
+struct BenchmarkResult {
+  std::string name;
+  //Iterations per sample, and number of samples
+  long iterations = 0;
+  int samples = 0;
+  //Per iteration timings in msec
+  double median = 0.;
+  double p5 = 0.;
+  double p95 = 0.;
+  double min = 0.;
+  //Declared work per iteration
+  double bytes = 0.;
+  double flops = 0.;
+  //Roofline mode only: memory level serving the working set, and attainable
+  //GFLOP/s for this kernel
+  std::string level;
+  double roofGFlops = 0.;
+
+  double GBs() const {
+    return bytes > 0. ? bytes/(median*1e6) : 0.;
+  }
+  double GFlops() const {
+    return flops > 0. ? flops/(median*1e6) : 0.;
+  }
+  //Flop per byte, infinite for kernels that do not access memory
+  double Intensity() const {
+    return bytes > 0. ? flops/bytes : std::numeric_limits<double>::infinity();
+  }
+  double RoofFraction() const {
+    return roofGFlops > 0. ? GFlops()/roofGFlops : 0.;
+  }
+};
+
+class BenchmarkRunner {
+ public:
+  BenchmarkRunner(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+      const std::string arg = argv[i];
+      if (arg == "--roofline") {
+        m_roofline = true;
+        continue;
+      }
+      const char* value = i+1 < argc ? argv[i+1] : nullptr;
+      if (value == nullptr) {
+        continue;
+      }
+      if (arg == "--json") {
+        m_jsonFile = value;
+      } else if (arg == "--cpu") {
+        m_cpuList = value;
+      } else if (arg == "--filter") {
+        m_filter = value;
+      } else if (arg == "--samples") {
+        m_samples = std::max(1, std::atoi(value));
+      } else if (arg == "--min-time") {
+        m_minSampleTime = std::max(0., std::atof(value));
+      } else if (arg == "--warmup") {
+        m_warmupTime = std::max(0., std::atof(value));
+      } else {
+        continue;
+      }
+      i++;
+    }
+    if (!m_cpuList.empty() && !SetAffinity(m_cpuList)) {
+      std::cerr << "WARNING : could not set cpu affinity to " << m_cpuList
+        << std::endl;
+    }
+    if (m_roofline) {
+      EnableRoofline();
+    }
+  }
+
+  //Measure the machine peaks, once, such that Run reports roofline data
+  void EnableRoofline() {
+    if (m_machine.levels.empty()) {
+      m_machine = RooflineMachine::Measure();
+      m_machine.Print(std::cout);
+    }
+    m_roofline = true;
+  }
+
+  const RooflineMachine& Machine() const {
+    return m_machine;
+  }
+
+  /*
+   * Measure func, bytes and flops are the amount of memory traffic and
+   * floating point operations of a single call.
+   * In roofline mode, the working set defaults to bytes, it selects the
+   * memory level whose bandwidth bounds the kernel.
+   * The returned reference stays valid until the runner is destroyed
+   */
+  template<typename FuncT>
+  const BenchmarkResult& Run(const std::string& name, FuncT func,
+      double bytes = 0., double flops = 0., double workingSet = -1.) {
+    m_results.emplace_back();
+    BenchmarkResult& result = m_results.back();
+    result.name = name;
+    result.bytes = bytes;
+    result.flops = flops;
+    if (!m_filter.empty() && name.find(m_filter) == std::string::npos) {
+      return result;
+    }
+
+    //Warm-up, at least one call
+    const double warmupEnd = Now()+m_warmupTime;
+    do {
+      func();
+      ClobberMemory();
+    } while (Now() < warmupEnd);
+
+    //Calibrate the number of iterations per sample
+    long iterations = 1;
+    while (TimeIterations(func, iterations) < m_minSampleTime &&
+        iterations < (1L<<30)) {
+      iterations *= 2;
+    }
+
+    std::vector<double> timings(m_samples);
+    for (double& timing : timings) {
+      timing = TimeIterations(func, iterations)/iterations;
+    }
+    std::sort(timings.begin(), timings.end());
+    result.iterations = iterations;
+    result.samples = m_samples;
+    result.min = timings.front();
+    result.median = Percentile(timings, 0.5);
+    result.p5 = Percentile(timings, 0.05);
+    result.p95 = Percentile(timings, 0.95);
+    if (m_roofline && flops > 0.) {
+      workingSet = workingSet < 0. ? bytes : workingSet;
+      result.level = bytes > 0. ? m_machine.LevelFor(workingSet).name :
+        "compute";
+      result.roofGFlops = m_machine.Roof(flops, bytes, workingSet);
+    }
+    Print(result);
+    return result;
+  }
+
+  const std::deque<BenchmarkResult>& Results() const {
+    return m_results;
+  }
+
+  /*
+   * Write the json report if requested, returns false if it could not be
+   * written
+   */
+  bool Finish() const {
+    if (m_jsonFile.empty()) {
+      return true;
+    }
+    std::ofstream file(m_jsonFile);
+    if (!file) {
+      std::cerr << "WARNING : could not open " << m_jsonFile << std::endl;
+      return false;
+    }
+    WriteJson(file);
+    return static_cast<bool>(file);
+  }
+
+  void WriteJson(std::ostream& os) const {
+    os << std::setprecision(9) << "{\n  \"context\": {\n"
+      << "    \"date\": \"" << Date() << "\",\n"
+      << "    \"host\": \"" << Escape(HostName()) << "\",\n"
+      << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+      << "    \"affinity\": \"" << Escape(m_cpuList) << "\",\n"
+#ifdef __VERSION__
+      << "    \"compiler\": \"" << Escape(__VERSION__) << "\",\n"
+#endif
+      << "    \"samples\": " << m_samples << ",\n"
+      << "    \"min_sample_time_ms\": " << m_minSampleTime << "\n"
+      << "  },\n";
+    if (m_roofline) {
+      os << "  \"roofline\": ";
+      m_machine.WriteJson(os);
+      os << ",\n";
+    }
+    os << "  \"benchmarks\": [";
+    bool first = true;
+    for (const BenchmarkResult& result : m_results) {
+      if (result.samples == 0) {
+        continue;
+      }
+      os << (first ? "\n" : ",\n") << "    {\"name\": \""
+        << Escape(result.name) << "\", \"iterations\": " << result.iterations
+        << ", \"samples\": " << result.samples
+        << ", \"median_ms\": " << result.median
+        << ", \"p5_ms\": " << result.p5
+        << ", \"p95_ms\": " << result.p95
+        << ", \"min_ms\": " << result.min
+        << ", \"bytes\": " << result.bytes
+        << ", \"flops\": " << result.flops
+        << ", \"GBs\": " << result.GBs()
+        << ", \"GFlops\": " << result.GFlops();
+      if (!result.level.empty()) {
+        os << ", \"intensity\": ";
+        if (result.bytes > 0.) {
+          os << result.Intensity();
+        } else {
+          os << "null";
+        }
+        os << ", \"level\": \"" << result.level << "\""
+          << ", \"roof_GFlops\": " << result.roofGFlops
+          << ", \"roof_fraction\": " << result.RoofFraction();
+      }
+      os << "}";
+      first = false;
+    }
+    os << "\n  ]\n}\n";
+  }
+
+ protected:
+  //Current time in msec
+  static double Now() {
+    return std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  template<typename FuncT>
+  static double TimeIterations(FuncT& func, long iterations) {
+    const double start = Now();
+    for (long k = 0; k < iterations; k++) {
+      func();
+      ClobberMemory();
+    }
+    return Now()-start;
+  }
+
+  //Linear interpolation between the closest ranks of a sorted vector
+  static double Percentile(const std::vector<double>& sorted, double p) {
+    const double rank = p*(sorted.size()-1);
+    const size_t low = static_cast<size_t>(rank);
+    const size_t high = std::min(low+1, sorted.size()-1);
+    return sorted[low]+(rank-low)*(sorted[high]-sorted[low]);
+  }
+
+  //Formatted apart, such that the caller stream settings are not involved
+  static void Print(const BenchmarkResult& result) {
+    std::ostringstream line;
+    line << std::left << std::setw(40) << result.name << std::right
+      << " median " << std::setw(10) << result.median << " msec [p5 "
+      << result.p5 << ", p95 " << result.p95 << "]";
+    if (result.bytes > 0.) {
+      line << " " << result.GBs() << " GB/s";
+    }
+    if (result.flops > 0.) {
+      line << " " << result.GFlops() << " GFLOP/s";
+    }
+    if (!result.level.empty()) {
+      line << " AI " << result.Intensity() << " (" << result.level << ") "
+        << 100.*result.RoofFraction() << "% of roof";
+    }
+    std::cout << line.str() << std::endl;
+  }
+
+  //Parse lists such as 0-3,8 and pin the process on those cpus
+  static bool SetAffinity(const std::string& list) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    std::stringstream stream(list);
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+      const size_t dash = range.find('-');
+      const int first = std::atoi(range.substr(0, dash).c_str());
+      const int last = dash == std::string::npos ? first :
+        std::atoi(range.substr(dash+1).c_str());
+      for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++) {
+        CPU_SET(cpu, &set);
+      }
+    }
+    return CPU_COUNT(&set) > 0 && sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+  }
+
+  static std::string HostName() {
+#ifdef __linux__
+    char name[256] = {};
+    if (gethostname(name, sizeof(name)-1) == 0) {
+      return name;
+    }
+#endif
+    return "unknown";
+  }
+
+  static std::string Date() {
+    const std::time_t now = std::time(nullptr);
+    char buffer[32] = {};
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S",
+      std::localtime(&now));
+    return buffer;
+  }
+
+  static std::string Escape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+      if (c == '"' || c == '\\') {
+        escaped += '\\';
+      }
+      escaped += c;
+    }
+    return escaped;
+  }
+
+  //deque: references returned by Run stay valid when adding results
+  std::deque<BenchmarkResult> m_results;
+  std::string m_jsonFile;
+  std::string m_cpuList;
+  std::string m_filter;
+  bool m_roofline = false;
+  RooflineMachine m_machine;
+  int m_samples = 21;
+  double m_minSampleTime = 10.;
+  double m_warmupTime = 50.;
+};
+
+#endif //BENCHMARK_H
@@ -0,0 +1,335 @@
+/*
+ * PerfCounters.h
+ *
+ *  Created on: 16 oct. 2026
+ *      Author: gnthibault
+ */
+
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+//STL
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+//System
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Hardware performance counters, read through the linux perf_event_open
+ * system call, around a region of code:
+ *
+ *   {
+ *     PERF_SCOPE("MyKernel");
+ *     ... work ...
+ *   }
+ *
+ * PERF_SCOPE expands to nothing unless USE_PERF_COUNTERS is defined, such
+ * that instrumented kernels cost nothing in regular builds.
+ * Counters are per thread: in a parallel region, each thread should open its
+ * own scope, results are then reported per thread, and aggregated over all
+ * threads, when the program exits (or through PerfReport::Instance().Print).
+ *
+ * When counters cannot be opened (perf_event_paranoid, containers, virtual
+ * machines, non linux hosts), only the wall-clock time is reported, the same
+ * binary thus runs everywhere. Counters that are multiplexed by the kernel
+ * are scaled by their enabled/running time ratio.
+ * FpOps counts retired floating point arithmetic instructions, whatever
+ * their width, it is only available on Intel cores (FP_ARITH_INST_RETIRED)
+ */
+
+/*
+ * Counter indices, scoped such that the short names do not leak into the
+ * global namespace of the including code
+ */
+namespace PerfEvent {
+enum Id {
+  Cycles = 0,
+  Instructions,
+  L1DMisses,
+  LLCMisses,
+  BranchMisses,
+  FpOps,
+  NbEvents
+};
+} //namespace PerfEvent
+
+struct PerfSample {
+  long calls = 0;
+  double msec = 0.;
+  //Negative if the counter is not available
+  double counts[PerfEvent::NbEvents] = {};
+
+  void Add(const PerfSample& other) {
+    calls += other.calls;
+    msec += other.msec;
+    for (int i = 0; i < PerfEvent::NbEvents; i++) {
+      counts[i] = counts[i] < 0. || other.counts[i] < 0. ? -1. :
+        counts[i]+other.counts[i];
+    }
+  }
+};
+
+/*
+ * Counters of the calling thread, opened once per thread on first use
+ */
+class PerfCounters {
+ public:
+  static PerfCounters& ThreadLocal() {
+    thread_local PerfCounters counters;
+    return counters;
+  }
+
+  bool Available(int event) const {
+    return m_fd[event] >= 0;
+  }
+
+  //Current counter values, -1 for unavailable counters
+  void Read(double* values) const {
+    for (int i = 0; i < PerfEvent::NbEvents; i++) {
+      values[i] = -1.;
+#ifdef __linux__
+      //value, time enabled, time running
+      uint64_t data[3];
+      if (m_fd[i] >= 0 && read(m_fd[i], data, sizeof(data)) ==
+          static_cast<ssize_t>(sizeof(data))) {
+        values[i] = data[2] > 0 ? static_cast<double>(data[0])*
+          (static_cast<double>(data[1])/static_cast<double>(data[2])) : 0.;
+      }
+#endif
+    }
+  }
+
+  ~PerfCounters() {
+#ifdef __linux__
+    for (int fd : m_fd) {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+#endif
+  }
+
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+ protected:
+  PerfCounters() {
+    for (int i = 0; i < PerfEvent::NbEvents; i++) {
+      m_fd[i] = Open(i);
+    }
+  }
+
+  static int Open(int event) {
+#ifdef __linux__
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+      PERF_FORMAT_TOTAL_TIME_RUNNING;
+    switch (event) {
+      case PerfEvent::Cycles:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+      case PerfEvent::Instructions:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+      case PerfEvent::L1DMisses:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_L1D |
+          (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        break;
+      case PerfEvent::LLCMisses:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        break;
+      case PerfEvent::BranchMisses:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+        break;
+      case PerfEvent::FpOps:
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_cpu_init();
+        if (!__builtin_cpu_is("intel")) {
+          return -1;
+        }
+        //FP_ARITH_INST_RETIRED, all umasks: scalar and packed, all widths
+        attr.type = PERF_TYPE_RAW;
+        attr.config = 0xFFC7;
+        break;
+#else
+        return -1;
+#endif
+      default:
+        return -1;
+    }
+    //Calling thread, any cpu
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1,
+      0));
+#else
+    return -1;
+#endif
+  }
+
+  int m_fd[PerfEvent::NbEvents];
+};
+
+/*
+ * Process wide accumulation of the samples, per scope name and per thread
+ */
+class PerfReport {
+ public:
+  static PerfReport& Instance() {
+    static PerfReport report;
+    return report;
+  }
+
+  void Add(const std::string& name, const PerfSample& sample) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_samples[name][ThreadId()].Add(sample);
+  }
+
+  void Reset() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_samples.clear();
+  }
+
+  void Print(std::ostream& os) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& scope : m_samples) {
+      os << "== " << scope.first << "\n" << std::setw(12) << "thread"
+        << std::setw(10) << "calls" << std::setw(12) << "wall ms";
+      for (const char* name : {"cycles", "instructions", "IPC", "L1D miss",
+          "LLC miss", "branch miss", "fp inst"}) {
+        os << std::setw(14) << name;
+      }
+      os << "\n";
+      PerfSample total;
+      bool first = true;
+      for (const auto& thread : scope.second) {
+        PrintLine(os, std::to_string(thread.first), thread.second);
+        if (first) {
+          total = thread.second;
+          first = false;
+        } else {
+          total.Add(thread.second);
+        }
+      }
+      //Wall time of the threads overlap, the total is a sum of thread times
+      PrintLine(os, "total", total);
+    }
+    os << std::flush;
+  }
+
+  ~PerfReport() {
+    if (!m_samples.empty()) {
+      Print(std::cout);
+    }
+  }
+
+ protected:
+  PerfReport() = default;
+
+  static long ThreadId() {
+#ifdef __linux__
+    return static_cast<long>(syscall(SYS_gettid));
+#else
+    return static_cast<long>(
+      std::hash<std::thread::id>()(std::this_thread::get_id()));
+#endif
+  }
+
+  static void PrintLine(std::ostream& os, const std::string& thread,
+      const PerfSample& sample) {
+    std::ostringstream line;
+    line << std::setprecision(4) << std::setw(12) << thread << std::setw(10)
+      << sample.calls << std::setw(12) << sample.msec;
+    for (int i = 0; i < PerfEvent::NbEvents; i++) {
+      line << std::setw(14);
+      if (sample.counts[i] < 0.) {
+        line << "n/a";
+      } else {
+        line << sample.counts[i];
+      }
+      //IPC after instructions
+      if (i == PerfEvent::Instructions) {
+        line << std::setw(14);
+        const double cycles = sample.counts[PerfEvent::Cycles];
+        const double instructions = sample.counts[PerfEvent::Instructions];
+        if (cycles > 0. && instructions >= 0.) {
+          line << instructions/cycles;
+        } else {
+          line << "n/a";
+        }
+      }
+    }
+    os << line.str() << "\n";
+  }
+
+  std::mutex m_mutex;
+  std::map<std::string, std::map<long, PerfSample>> m_samples;
+};
+
+/*
+ * RAII region, counters are read on construction and destruction
+ */
+class PerfScope {
+ public:
+  explicit PerfScope(const char* name) : m_name(name),
+      m_counters(PerfCounters::ThreadLocal()) {
+    m_counters.Read(m_start);
+    m_startTime = std::chrono::steady_clock::now();
+  }
+
+  ~PerfScope() {
+    const auto stopTime = std::chrono::steady_clock::now();
+    double stop[PerfEvent::NbEvents];
+    m_counters.Read(stop);
+    PerfSample sample;
+    sample.calls = 1;
+    sample.msec = std::chrono::duration<double, std::milli>(
+      stopTime-m_startTime).count();
+    for (int i = 0; i < PerfEvent::NbEvents; i++) {
+      sample.counts[i] = stop[i] < 0. ? -1. : stop[i]-m_start[i];
+    }
+    PerfReport::Instance().Add(m_name, sample);
+  }
+
+  PerfScope(const PerfScope&) = delete;
+  PerfScope& operator=(const PerfScope&) = delete;
+
+ protected:
+  const char* m_name;
+  const PerfCounters& m_counters;
+  double m_start[PerfEvent::NbEvents];
+  std::chrono::steady_clock::time_point m_startTime;
+};
+
+#define PERF_SCOPE_CONCAT_IMPL(a, b) a##b
+#define PERF_SCOPE_CONCAT(a, b) PERF_SCOPE_CONCAT_IMPL(a, b)
+#ifdef USE_PERF_COUNTERS
+  #define PERF_SCOPE(name) \
+    PerfScope PERF_SCOPE_CONCAT(perfScope, __LINE__)(name)
+#else
+  #define PERF_SCOPE(name)
+#endif
+
+#endif //PERFCOUNTERS_H
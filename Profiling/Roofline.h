@@ -0,0 +1,209 @@
+/*
+ * Roofline.h
+ *
+ *  Created on: 16 oct. 2026
+ *      Author: gnthibault
+ */
+
+#ifndef ROOFLINE_H
+#define ROOFLINE_H
+
+//STL
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//System
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+/*
+ * Roofline model of the host: the attainable performance of a kernel with
+ * arithmetic intensity I (flop per byte), whose working set fits in a given
+ * memory level, is min(peak flops, I*bandwidth of that level).
+ * Peaks are measured with the instruction set the binary is compiled for,
+ * on a single thread:
+ * - floating point peak: independent chains of a*x+b on the widest native
+ *   vector, that compile to fma with -mfma (2 flops per element)
+ * - bandwidth: vectorized read-only sum of a buffer that fits half of each
+ *   cache level, and of a buffer way larger than the last level cache
+ * Cache sizes are queried from the system, with usual defaults otherwise
+ */
+struct MemoryLevel {
+  std::string name;
+  //Capacity of the level, a working set up to this size is served by it
+  double bytes;
+  double GBs;
+};
+
+class RooflineMachine {
+ public:
+  double peakGFlops = 0.;
+  std::vector<MemoryLevel> levels;
+
+  static RooflineMachine Measure() {
+    RooflineMachine machine;
+    machine.peakGFlops = MeasurePeakGFlops();
+    const char* names[] = {"L1", "L2", "L3"};
+    double lastLevel = 0.;
+    for (int level = 1; level <= 3; level++) {
+      const double bytes = CacheSize(level);
+      if (bytes <= lastLevel) {
+        continue;
+      }
+      machine.levels.push_back({names[level-1], bytes,
+        MeasureReadGBs(static_cast<size_t>(bytes/2))});
+      lastLevel = bytes;
+    }
+    //Way larger than the last level, but within the memory of small hosts
+    const double dram = std::min(std::max(4.*lastLevel, 64.*1024.*1024.),
+      1024.*1024.*1024.);
+    machine.levels.push_back({"DRAM", std::numeric_limits<double>::max(),
+      MeasureReadGBs(static_cast<size_t>(dram))});
+    return machine;
+  }
+
+  //Smallest memory level the working set fits in
+  const MemoryLevel& LevelFor(double workingSet) const {
+    for (const MemoryLevel& level : levels) {
+      if (workingSet <= level.bytes) {
+        return level;
+      }
+    }
+    return levels.back();
+  }
+
+  //Attainable GFLOP/s, intensity is in flop per byte, 0 bytes means infinite
+  double Roof(double flops, double bytes, double workingSet) const {
+    if (bytes <= 0.) {
+      return peakGFlops;
+    }
+    return std::min(peakGFlops, flops/bytes*LevelFor(workingSet).GBs);
+  }
+
+  void Print(std::ostream& os) const {
+    std::ostringstream text;
+    text << "Roofline: peak " << peakGFlops << " GFLOP/s";
+    for (const MemoryLevel& level : levels) {
+      text << ", " << level.name << " " << level.GBs << " GB/s";
+      if (level.bytes < std::numeric_limits<double>::max()) {
+        text << " (" << level.bytes/1024. << " KB)";
+      }
+    }
+    os << text.str() << std::endl;
+  }
+
+  void WriteJson(std::ostream& os) const {
+    os << "{\"peak_GFlops\": " << peakGFlops << ", \"levels\": [";
+    for (size_t i = 0; i < levels.size(); i++) {
+      os << (i > 0 ? ", " : "") << "{\"name\": \"" << levels[i].name
+        << "\", \"bytes\": ";
+      if (levels[i].bytes < std::numeric_limits<double>::max()) {
+        os << levels[i].bytes;
+      } else {
+        os << "null";
+      }
+      os << ", \"GBs\": " << levels[i].GBs << "}";
+    }
+    os << "]}";
+  }
+
+ protected:
+  //Native vector of floats, the compiler splits wider ones
+#if defined __AVX512F__
+  typedef float NativeVec __attribute__((vector_size(64)));
+#elif defined __AVX__
+  typedef float NativeVec __attribute__((vector_size(32)));
+#else
+  typedef float NativeVec __attribute__((vector_size(16)));
+#endif
+  constexpr static int VecSize = sizeof(NativeVec)/sizeof(float);
+
+  //Best of a few runs, in seconds
+  template<typename FuncT>
+  static double BestTime(FuncT func, int nrun = 5) {
+    double best = std::numeric_limits<double>::max();
+    for (int k = 0; k < nrun; k++) {
+      const auto start = std::chrono::steady_clock::now();
+      func();
+      const auto stop = std::chrono::steady_clock::now();
+      best = std::min(best, std::chrono::duration<double>(stop-start).count());
+    }
+    return best;
+  }
+
+  static double MeasurePeakGFlops() {
+    //Enough independent chains to hide the fma latency (4 cycles, 2 ports)
+    constexpr int NbChains = 10;
+    constexpr long NbIter = 1L<<22;
+    NativeVec acc[NbChains];
+    for (int j = 0; j < NbChains; j++) {
+      acc[j] = NativeVec{} + static_cast<float>(j);
+    }
+    const NativeVec a = NativeVec{} + 0.999999f;
+    const NativeVec b = NativeVec{} + 1e-6f;
+    const double sec = BestTime([&]() {
+      for (long k = 0; k < NbIter; k++) {
+        for (int j = 0; j < NbChains; j++) {
+          acc[j] = acc[j]*a+b;
+        }
+        //Keep the chains in registers, but forbid to collapse iterations
+        asm volatile("" : "+m"(acc));
+      }
+    });
+    return 2.*NbChains*VecSize*static_cast<double>(NbIter)/sec*1e-9;
+  }
+
+  //Read bandwidth of a buffer of the given size
+  static double MeasureReadGBs(size_t bytes) {
+    const size_t size = std::max<size_t>(bytes/sizeof(NativeVec), 8);
+    //std::allocator does not honor the vector alignment before C++17
+    NativeVec* buffer = static_cast<NativeVec*>(aligned_alloc(
+      sizeof(NativeVec), size*sizeof(NativeVec)));
+    std::fill(buffer, buffer+size, NativeVec{} + 1.f);
+    //Read at least 1GB per run, such that timer resolution is not an issue
+    const size_t nbPass = std::max<size_t>(1, (1UL<<30)/(size*
+      sizeof(NativeVec)));
+    //Independent sums, such that the add latency does not limit the loads
+    constexpr int NbSums = 8;
+    NativeVec sum[NbSums] = {};
+    const double sec = BestTime([&]() {
+      for (size_t pass = 0; pass < nbPass; pass++) {
+        for (size_t i = 0; i+NbSums <= size; i += NbSums) {
+          for (int j = 0; j < NbSums; j++) {
+            sum[j] += buffer[i+j];
+          }
+        }
+        asm volatile("" : "+m"(sum));
+      }
+    }, 3);
+    free(buffer);
+    return static_cast<double>(nbPass)*(size/NbSums*NbSums)*
+      sizeof(NativeVec)/sec*1e-9;
+  }
+
+  static double CacheSize(int level) {
+    long bytes = 0;
+#if defined __linux__ && defined _SC_LEVEL1_DCACHE_SIZE
+    switch (level) {
+      case 1: bytes = sysconf(_SC_LEVEL1_DCACHE_SIZE); break;
+      case 2: bytes = sysconf(_SC_LEVEL2_CACHE_SIZE); break;
+      case 3: bytes = sysconf(_SC_LEVEL3_CACHE_SIZE); break;
+    }
+#endif
+    if (bytes > 0) {
+      return static_cast<double>(bytes);
+    }
+    const double defaults[] = {32.*1024., 1024.*1024., 8.*1024.*1024.};
+    return defaults[level-1];
+  }
+};
+
+#endif //ROOFLINE_H
@@ -0,0 +1,185 @@
+#ifndef AUTOTUNER_H
+#define AUTOTUNER_H
+
+//STL
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+ * Decisions of the autotuners, shared by all of them: each key describes a
+ * kernel and the sizes it was tuned for, and maps to the name of its
+ * fastest variant. They are loaded from File() on first use, and the whole
+ * file is written again every time a decision is made, such that later
+ * process starts skip the tuning.
+ * One line per decision, "key variant msec", keys and variant names having
+ * no spaces. Decisions whose variant does not exist anymore are tuned again.
+ * The VECTORIZATION_TUNING_FILE environment variable gives the path of the
+ * file, vectorization_tuning.txt in the working directory by default, an
+ * empty value disables persistence
+ */
+class TuningCache {
+public:
+  static TuningCache& Instance() {
+    static TuningCache cache;
+    return cache;
+  }
+
+  static std::string File() {
+    const char* env = std::getenv("VECTORIZATION_TUNING_FILE");
+    return env != nullptr ? env : "vectorization_tuning.txt";
+  }
+
+  //Variant chosen for key, empty when it has not been tuned yet
+  std::string Find(const std::string& key) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_entries.find(key);
+    return it != m_entries.end() ? it->second.variant : std::string();
+  }
+
+  //Record a decision, and persist all of them
+  void Store(const std::string& key, const std::string& variant,
+      const double msec) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries[key] = Entry{variant, msec};
+    Save();
+  }
+
+  //Forget all decisions, in memory only
+  void Clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+  }
+
+  //Decisions read from the file again, dropping the ones in memory
+  void Reload() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    Load();
+  }
+
+protected:
+  struct Entry {
+    std::string variant;
+    double msec;
+  };
+
+  TuningCache() {
+    Load();
+  }
+
+  void Load() {
+    const std::string file = File();
+    if (file.empty()) {
+      return;
+    }
+    std::ifstream stream(file);
+    std::string line;
+    while (std::getline(stream, line)) {
+      std::istringstream fields(line);
+      std::string key;
+      Entry entry;
+      if (fields >> key >> entry.variant >> entry.msec) {
+        m_entries[key] = entry;
+      }
+    }
+  }
+
+  //A failure to write only costs a tuning at the next start
+  void Save() const {
+    const std::string file = File();
+    if (file.empty()) {
+      return;
+    }
+    std::ofstream stream(file);
+    for (const auto& entry : m_entries) {
+      stream << entry.first << " " << entry.second.variant << " " <<
+        entry.second.msec << "\n";
+    }
+  }
+
+  std::mutex m_mutex;
+  std::map<std::string,Entry> m_entries;
+};
+
+/*
+ * Choice of the fastest variant of a kernel for key, in the spirit of the
+ * grain size trials of RecursiveTransformEngine (see OpenMPTaskBased), but
+ * done once, on first use, and persisted by TuningCache.
+ * run(i) must run variant i on the actual data of the call, that all
+ * variants are expected to process identically. Each variant is run once
+ * to warm up, then timed NbTrial times, each time over enough iterations to
+ * last MinTrialTime, the minimum being kept. Tunings are serialized, such
+ * that concurrent ones do not disturb each other
+ */
+class Autotuner {
+public:
+  constexpr static int NbTrial = 3;
+  constexpr static double MinTrialTime = 0.2; //msec
+
+  template<class RunT>
+  static int Select(const std::string& key,
+      const std::vector<std::string>& variants, RunT run) {
+    const int cached = Index(variants, TuningCache::Instance().Find(key));
+    if (cached >= 0) {
+      return cached;
+    }
+    static std::mutex tuning;
+    std::lock_guard<std::mutex> lock(tuning);
+    //Another thread may have tuned it in the meantime
+    const int tuned = Index(variants, TuningCache::Instance().Find(key));
+    if (tuned >= 0) {
+      return tuned;
+    }
+    int best = 0;
+    double bestMsec = std::numeric_limits<double>::max();
+    for (int i = 0; i < static_cast<int>(variants.size()); i++) {
+      run(i);
+      long iterations = 1;
+      while (Time(run, i, iterations) < MinTrialTime &&
+          iterations < (1L << 20)) {
+        iterations *= 2;
+      }
+      double msec = std::numeric_limits<double>::max();
+      for (int trial = 0; trial < NbTrial; trial++) {
+        msec = std::min(msec, Time(run, i, iterations)/iterations);
+      }
+      if (msec < bestMsec) {
+        best = i;
+        bestMsec = msec;
+      }
+    }
+    TuningCache::Instance().Store(key, variants[best], bestMsec);
+    return best;
+  }
+
+protected:
+  static int Index(const std::vector<std::string>& variants,
+      const std::string& name) {
+    for (int i = 0; i < static_cast<int>(variants.size()); i++) {
+      if (variants[i] == name) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  template<class RunT>
+  static double Time(RunT& run, const int variant, const long iterations) {
+    const auto start = std::chrono::steady_clock::now();
+    for (long k = 0; k < iterations; k++) {
+      run(variant);
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop-start).count();
+  }
+};
+
+#endif //AUTOTUNER_H
@@ -0,0 +1,124 @@
+#ifndef BOUNDARY_H
+#define BOUNDARY_H
+
+// STL
+#include <algorithm>
+
+// Local
+#include "vectorization.h"
+
+VECTORIZATION_NAMESPACE_BEGIN
+
+inline int positive_modulo(int i, int n) {
+  return (i % n + n) % n;
+}
+
+/*
+ * Boundary policies, that extend a line of n elements beyond [0,n):
+ * - PeriodicBoundary: in[i mod n], ... x y z | a b c ... x y z | a b c ...
+ * - MirrorBoundary: half sample symmetric extension, the edge element is
+ *   repeated, ... c b a | a b c ... x y z | z y x ..., with period 2n
+ * - ClampBoundary: the edge element is repeated, ... a a | a b c ...
+ * - ZeroBoundary: zeros outside of the line
+ * Index(i,n) is the input element that stands for index i, or -1 for a zero,
+ * it is only meant for reference code.
+ * Extend(in,n,first,dst,size) writes elements [first,first+size) of the
+ * extended line to dst, with a few contiguous copies and fills instead of
+ * one modulo per element, converting them from IN_T to T
+ */
+struct PeriodicBoundary {
+  static int Index(int i, int n) {
+    return positive_modulo(i,n);
+  }
+
+  template<typename IN_T, typename T>
+  static void Extend(const IN_T* in, const int n, const int first, T* dst,
+      const int size) {
+    int src = positive_modulo(first,n);
+    for (int i = 0; i < size; ) {
+      const int chunk = std::min(size-i, n-src);
+      std::copy(in+src, in+src+chunk, dst+i);
+      i += chunk;
+      src = 0;
+    }
+  }
+};
+
+struct MirrorBoundary {
+  static int Index(int i, int n) {
+    const int j = positive_modulo(i,2*n);
+    return j < n ? j : 2*n-1-j;
+  }
+
+  template<typename IN_T, typename T>
+  static void Extend(const IN_T* in, const int n, const int first, T* dst,
+      const int size) {
+    //Alternate forward copies of [0,n) and backward ones
+    int src = positive_modulo(first,2*n);
+    for (int i = 0; i < size; ) {
+      int chunk;
+      if (src < n) {
+        chunk = std::min(size-i, n-src);
+        std::copy(in+src, in+src+chunk, dst+i);
+      } else {
+        chunk = std::min(size-i, 2*n-src);
+        std::reverse_copy(in+2*n-src-chunk, in+2*n-src, dst+i);
+      }
+      i += chunk;
+      src += chunk;
+      if (src == 2*n) {
+        src = 0;
+      }
+    }
+  }
+};
+
+/*
+ * Common part of the boundaries that are constant on each side: fills with
+ * left, the part of the line that is in [first,first+size), then right
+ */
+struct ConstantBoundary {
+  template<typename IN_T, typename T>
+  static void Extend(const IN_T* in, const int n, const int first, T* dst,
+      const int size, const T left, const T right) {
+    const int nbLeft = std::min(size, std::max(0, -first));
+    std::fill(dst, dst+nbLeft, left);
+    const int begin = std::max(first, 0);
+    const int end = std::min(first+size, n);
+    int i = nbLeft;
+    if (begin < end) {
+      std::copy(in+begin, in+end, dst+i);
+      i += end-begin;
+    }
+    std::fill(dst+i, dst+size, right);
+  }
+};
+
+struct ClampBoundary : protected ConstantBoundary {
+  static int Index(int i, int n) {
+    return std::min(std::max(i, 0), n-1);
+  }
+
+  template<typename IN_T, typename T>
+  static void Extend(const IN_T* in, const int n, const int first, T* dst,
+      const int size) {
+    const T left = in[0];
+    const T right = in[n-1];
+    ConstantBoundary::Extend(in, n, first, dst, size, left, right);
+  }
+};
+
+struct ZeroBoundary : protected ConstantBoundary {
+  static int Index(int i, int n) {
+    return i < 0 || i >= n ? -1 : i;
+  }
+
+  template<typename IN_T, typename T>
+  static void Extend(const IN_T* in, const int n, const int first, T* dst,
+      const int size) {
+    ConstantBoundary::Extend(in, n, first, dst, size, T(0), T(0));
+  }
+};
+
+VECTORIZATION_NAMESPACE_END
+#endif //BOUNDARY_H
@@ -0,0 +1,127 @@
+#ifndef COMPLEXARITHMETIC_H
+#define COMPLEXARITHMETIC_H
+
+// Local
+#include "vectorization.h"
+
+VECTORIZATION_NAMESPACE_BEGIN
+
+/*
+ * Vectors of interleaved complex numbers, as loaded from std::complex<T>
+ * arrays: real parts in the even lanes, imaginary parts in the odd ones.
+ * - Swap(a) exchanges the real and imaginary parts, (re,im) -> (im,re)
+ * - AddSub(a,b) is a-b in the even lanes and a+b in the odd ones
+ * such that the product of a complex c = cr+i*ci with the vector x is
+ * AddSub(cr*x, ci*Swap(x)). Vectorized is false when a vector does not hold
+ * a whole complex, the generic version is then not meant to be used
+ */
+template<typename T, class VecT>
+class ComplexOps {
+ public:
+  constexpr static bool Vectorized = false;
+};
+
+#ifdef USE_AVX
+template<>
+class ComplexOps<float,__m128> {
+ public:
+  constexpr static bool Vectorized = true;
+  static __m128 Swap( __m128 a ) {
+    return _mm_shuffle_ps(a,a, _MM_SHUFFLE(2,3,0,1));
+  }
+  static __m128 AddSub( __m128 a, __m128 b ) {
+    return _mm_addsub_ps(a,b);
+  }
+};
+template<>
+class ComplexOps<double,__m128d> {
+ public:
+  constexpr static bool Vectorized = true;
+  static __m128d Swap( __m128d a ) {
+    return _mm_shuffle_pd(a,a,1);
+  }
+  static __m128d AddSub( __m128d a, __m128d b ) {
+    return _mm_addsub_pd(a,b);
+  }
+};
+#elif defined USE_AVX2
+template<>
+class ComplexOps<float,__m256> {
+ public:
+  constexpr static bool Vectorized = true;
+  static __m256 Swap( __m256 a ) {
+    return _mm256_permute_ps(a, _MM_SHUFFLE(2,3,0,1));
+  }
+  static __m256 AddSub( __m256 a, __m256 b ) {
+    return _mm256_addsub_ps(a,b);
+  }
+};
+template<>
+class ComplexOps<double,__m256d> {
+ public:
+  constexpr static bool Vectorized = true;
+  static __m256d Swap( __m256d a ) {
+    return _mm256_permute_pd(a,0x5);
+  }
+  static __m256d AddSub( __m256d a, __m256d b ) {
+    return _mm256_addsub_pd(a,b);
+  }
+};
+#elif defined USE_AVX512
+/*
+ * There is no addsub in AVX512, the sum is computed in all lanes, then
+ * replaced by the difference in the even ones
+ */
+template<>
+class ComplexOps<float,__m512> {
+ public:
+  constexpr static bool Vectorized = true;
+  static __m512 Swap( __m512 a ) {
+    return _mm512_permute_ps(a, _MM_SHUFFLE(2,3,0,1));
+  }
+  static __m512 AddSub( __m512 a, __m512 b ) {
+    return _mm512_mask_sub_ps(_mm512_add_ps(a,b), 0x5555, a, b);
+  }
+};
+template<>
+class ComplexOps<double,__m512d> {
+ public:
+  constexpr static bool Vectorized = true;
+  static __m512d Swap( __m512d a ) {
+    return _mm512_permute_pd(a,0x55);
+  }
+  static __m512d AddSub( __m512d a, __m512d b ) {
+    return _mm512_mask_sub_pd(_mm512_add_pd(a,b), 0x55, a, b);
+  }
+};
+#elif defined USE_NEON
+template<>
+class ComplexOps<float,float32x4_t> {
+ public:
+  constexpr static bool Vectorized = true;
+  static float32x4_t Swap( float32x4_t a ) {
+    return vrev64q_f32(a);
+  }
+  static float32x4_t AddSub( float32x4_t a, float32x4_t b ) {
+    const float32x4_t sign = {-1.f,1.f,-1.f,1.f};
+    return vmlaq_f32(a,b,sign);
+  }
+};
+#ifdef __aarch64__
+template<>
+class ComplexOps<double,float64x2_t> {
+ public:
+  constexpr static bool Vectorized = true;
+  static float64x2_t Swap( float64x2_t a ) {
+    return vextq_f64(a,a,1);
+  }
+  static float64x2_t AddSub( float64x2_t a, float64x2_t b ) {
+    const float64x2_t sign = {-1.,1.};
+    return vmlaq_f64(a,b,sign);
+  }
+};
+#endif //__aarch64__
+#endif
+
+VECTORIZATION_NAMESPACE_END
+#endif //COMPLEXARITHMETIC_H
@@ -0,0 +1,324 @@
+#ifndef COMPLEXCONVOLUTION_H
+#define COMPLEXCONVOLUTION_H
+
+//STL
+#include <algorithm>
+#include <complex>
+#include <type_traits>
+#include <vector>
+
+//Local
+#include "ComplexArithmetic.h"
+#include "Convolution.h"
+#include "Reduce.h"
+
+VECTORIZATION_NAMESPACE_BEGIN
+
+/*
+ * Filter of complex coefficients, known at runtime, for std::complex<T>
+ * lines: out[i] = sum over k of Buf[k]*in[i+k-TapSizeLeft]
+ */
+template<typename T, int TAP_SIZE_LEFT, int TAP_SIZE_RIGHT>
+class ComplexFilter {
+public:
+  static_assert(std::is_floating_point<T>::value,
+    "ComplexFilter needs float or double parts");
+  typedef T ScalarType;
+  typedef PackType<T> VectorType;
+  typedef std::complex<T> CoefficientType;
+  constexpr static int TapSize = TAP_SIZE_LEFT+TAP_SIZE_RIGHT+1;
+  constexpr static int TapSizeLeft = TAP_SIZE_LEFT;
+  constexpr static int TapSizeRight = TAP_SIZE_RIGHT;
+
+  explicit ComplexFilter(const CoefficientType* coefficients) {
+    std::copy(coefficients, coefficients+TapSize, Buf);
+  }
+
+  CoefficientType Buf[TapSize];
+};
+
+/*
+ * Sums of the taps of an output vector, whose first tap is element
+ * PREFETCH_BEGIN_IDX of the window, tap k being 2*k elements further: the
+ * real and imaginary parts of each coefficient, broadcast, multiply the
+ * inputs into two accumulators, that ComplexOps combines once all taps have
+ * been summed
+ */
+template<typename T, int PREFETCH_BEGIN_IDX, int SUPPORT_IDX>
+class ComplexAccumulator {
+public:
+  typedef PackType<T> VecT;
+
+  template<class WINDOW>
+  static void Accumulate(const WINDOW& prefetch, const VecT* re,
+      const VecT* im, VecT& accRe, VecT& accIm) {
+    //Recursive call over all previous index of filter support
+    ComplexAccumulator<T,PREFETCH_BEGIN_IDX,SUPPORT_IDX-1>::Accumulate(
+      prefetch, re, im, accRe, accIm);
+    const VecT x = ConvolutionShifter<T,PREFETCH_BEGIN_IDX,2*SUPPORT_IDX>::
+      generateNewVec(prefetch);
+    accRe = FmaOps<T>::MultiplyAdd(re[SUPPORT_IDX], x, accRe);
+    accIm = FmaOps<T>::MultiplyAdd(im[SUPPORT_IDX], x, accIm);
+  }
+};
+
+//Partial template specialization for iteration 0 of the loop
+template<typename T, int PREFETCH_BEGIN_IDX>
+class ComplexAccumulator<T,PREFETCH_BEGIN_IDX,0> {
+public:
+  typedef PackType<T> VecT;
+
+  template<class WINDOW>
+  static void Accumulate(const WINDOW& prefetch, const VecT* re,
+      const VecT* im, VecT& accRe, VecT& accIm) {
+    const VecT x = ConvolutionShifter<T,PREFETCH_BEGIN_IDX,0>::
+      generateNewVec(prefetch);
+    accRe = re[0]*x;
+    accIm = im[0]*x;
+  }
+};
+
+/*
+ * Convolution of a line of n std::complex<T> by a ComplexFilter, whose ends
+ * are extended by BOUNDARY_POLICY, and correlation, the same with the
+ * conjugate coefficients, that is the matched filter of Buf.
+ * The line is seen as 2*n interleaved real and imaginary parts, where tap k
+ * is 2*k elements away. With cr+i*ci a coefficient and x the vector of
+ * inputs of its tap, cr*x holds the products cr*xr and cr*xi, and ci*x the
+ * products ci*xr and ci*xi, that only need their real and imaginary lanes
+ * exchanged to be added to, or subtracted from, the ones of cr*x. This
+ * exchange commutes with the sum over the taps, such that each tap costs two
+ * multiply-adds, and each output vector a single Swap and AddSub.
+ * Output vectors are computed by groups of GroupSize, from one window of
+ * input vectors loaded per group, the line being processed by blocks of
+ * BlockSize complex outputs, extended near its ends only.
+ * Instruction sets whose vectors do not hold a whole complex, and the
+ * scalar backend, use a std::complex loop
+ */
+template<class FILT, class BOUNDARY_POLICY=PeriodicBoundary>
+class ComplexConvolution {
+public:
+  typedef typename FILT::ScalarType T;
+  typedef typename FILT::VectorType VecT;
+  typedef std::complex<T> ComplexT;
+  constexpr static int VecSize = sizeof(VecT)/sizeof(T);
+  constexpr static int TapSize = FILT::TapSize;
+  //Output vectors per window, 4 run out of registers with their 8
+  //accumulators
+  constexpr static int GroupSize = 2;
+  //Complex outputs per block, a whole number of groups
+  constexpr static int BlockSize = 128*VecSize;
+
+  static void Convolve(const FILT& filter, const ComplexT* in, ComplexT* out,
+      const int n) {
+    ConvolveLine(filter.Buf, false, in, out, n);
+  }
+
+  //Sum of conj(Buf[k])*in[i+k-TapSizeLeft]
+  static void Correlate(const FILT& filter, const ComplexT* in,
+      ComplexT* out, const int n) {
+    ConvolveLine(filter.Buf, true, in, out, n);
+  }
+
+protected:
+  typedef VectorizedMemOp<T,VecT,UnalignedMemory> MemOp;
+  typedef ComplexOps<T,VecT> Ops;
+  //Whole vectors of the window before and after the ones of the group
+  constexpr static int LeftVec = (2*FILT::TapSizeLeft+VecSize-1)/VecSize;
+  constexpr static int RightVec = (2*FILT::TapSizeRight+VecSize-1)/VecSize;
+  //Element of the window that holds the first tap of the group
+  constexpr static int PrefetchBeginIdx = LeftVec*VecSize-2*FILT::TapSizeLeft;
+  //Vectors loaded per group
+  constexpr static int GroupCardinality = LeftVec+GroupSize+RightVec;
+
+  static void ConvolveLine(const ComplexT* buf, const bool conjugate,
+      const ComplexT* in, ComplexT* out, const int n) {
+    if (n <= 0) {
+      return;
+    }
+    PERF_SCOPE("ComplexConvolution::Convolve");
+    ComplexT coefs[TapSize];
+    for (int k = 0; k < TapSize; k++) {
+      coefs[k] = conjugate ? std::conj(buf[k]) : buf[k];
+    }
+    std::vector<ComplexT> extended;
+    for (int first = 0; first < n; first += BlockSize) {
+      const int blockSize = std::min(BlockSize, n-first);
+      //Inputs of the block, with the whole window of its last group
+      const int begin = first-LeftMargin;
+      const int srcSize = Padded(blockSize)+LeftMargin+RightMargin;
+      const ComplexT* src;
+      if (begin < 0 || begin+srcSize > n) {
+        extended.resize(srcSize);
+        BOUNDARY_POLICY::Extend(in, n, begin, extended.data(), srcSize);
+        src = extended.data();
+      } else {
+        src = in+begin;
+      }
+      ConvolveBlock(coefs, src, out+first, blockSize,
+        std::integral_constant<bool,Ops::Vectorized>());
+    }
+  }
+
+  //Complex inputs read before and after the outputs of a block
+  constexpr static int LeftMargin = Ops::Vectorized ? LeftVec*VecSize/2 :
+    FILT::TapSizeLeft;
+  constexpr static int RightMargin = Ops::Vectorized ? RightVec*VecSize/2 :
+    FILT::TapSizeRight;
+
+  //Complex outputs computed for a block, the last group being whole
+  static int Padded(const int blockSize) {
+    return Ops::Vectorized ? (2*blockSize+GroupSize*VecSize-1)/
+      (GroupSize*VecSize)*GroupSize*VecSize/2 : blockSize;
+  }
+
+  //src begins LeftMargin inputs before the first output
+  static void ConvolveBlock(const ComplexT* coefs, const ComplexT* src,
+      ComplexT* out, const int blockSize, std::false_type) {
+    for (int i = 0; i < blockSize; i++) {
+      ComplexT sum = ComplexT(0);
+      for (int k = 0; k < TapSize; k++) {
+        sum += coefs[k]*src[i+k];
+      }
+      out[i] = sum;
+    }
+  }
+
+  static void ConvolveBlock(const ComplexT* coefs, const ComplexT* src,
+      ComplexT* out, const int blockSize, std::true_type) {
+    VecT re[TapSize], im[TapSize];
+    for (int k = 0; k < TapSize; k++) {
+      re[k] = VecT() + coefs[k].real();
+      im[k] = VecT() + coefs[k].imag();
+    }
+    const T* parts = reinterpret_cast<const T*>(src);
+    T* outParts = reinterpret_cast<T*>(out);
+    const int size = 2*blockSize;
+    for (int i = 0; i < size; i += GroupSize*VecSize) {
+      VecT window[GroupCardinality];
+      for (int v = 0; v < GroupCardinality; v++) {
+        window[v] = MemOp::load(parts+i+v*VecSize);
+      }
+      ProcessGroup(re, im, PrefetchWindow<VecT,GroupCardinality,0>(window),
+        outParts+i, size-i, std::integral_constant<int,0>());
+    }
+  }
+
+  /*
+   * Vectors PHASE to GroupSize-1 of a group, of which count elements, at
+   * most, are written
+   */
+  template<class WINDOW, int PHASE>
+  static void ProcessGroup(const VecT* re, const VecT* im,
+      const WINDOW& prefetch, T* out, const int count,
+      std::integral_constant<int,PHASE>) {
+    const int remaining = count-PHASE*VecSize;
+    if (remaining <= 0) {
+      return;
+    }
+    VecT accRe, accIm;
+    ComplexAccumulator<T,PrefetchBeginIdx+PHASE*VecSize,TapSize-1>::
+      Accumulate(prefetch, re, im, accRe, accIm);
+    const VecT result = Ops::AddSub(accRe, Ops::Swap(accIm));
+    if (remaining >= VecSize) {
+      MemOp::store(out+PHASE*VecSize, result);
+    } else {
+      MemOp::maskstore(out+PHASE*VecSize, result, remaining);
+    }
+    ProcessGroup(re, im, prefetch, out, count,
+      std::integral_constant<int,PHASE+1>());
+  }
+
+  template<class WINDOW>
+  static void ProcessGroup(const VecT*, const VecT*, const WINDOW&, T*,
+      const int, std::integral_constant<int,GroupSize>) {}
+};
+
+/*
+ * Complex dot products, in the spirit of the InnerProduct example: with
+ * x and y vectors of interleaved parts, x*y holds xr*yr and xi*yi, whose
+ * difference is the real part, and x*Swap(y) holds xr*yi and xi*yr, whose
+ * sum is the imaginary part. Both are accumulated over the lines, in
+ * NbAccumulator independent pairs, and the lanes are only combined once,
+ * by ComplexOps::AddSub and VectorSum.
+ * Conjugate is the sum of conj(x)*y, the correlation of x and y, whose real
+ * part is the sum of x*y and imaginary part the difference of x*Swap(y)
+ */
+template<typename T>
+class ComplexInnerProduct {
+public:
+  typedef PackType<T> VecT;
+  typedef std::complex<T> ComplexT;
+  constexpr static int VecSize = sizeof(VecT)/sizeof(T);
+  constexpr static int NbAccumulator = 2;
+
+  static ComplexT Dot(const ComplexT* x, const ComplexT* y, const int n) {
+    return Sum(x, y, n, false, std::integral_constant<bool,
+      ComplexOps<T,VecT>::Vectorized>());
+  }
+
+  static ComplexT Conjugate(const ComplexT* x, const ComplexT* y,
+      const int n) {
+    return Sum(x, y, n, true, std::integral_constant<bool,
+      ComplexOps<T,VecT>::Vectorized>());
+  }
+
+protected:
+  typedef VectorizedMemOp<T,VecT,UnalignedMemory> MemOp;
+  typedef ComplexOps<T,VecT> Ops;
+
+  static ComplexT Sum(const ComplexT* x, const ComplexT* y, const int n,
+      const bool conjugate, std::false_type) {
+    ComplexT sum = ComplexT(0);
+    for (int i = 0; i < n; i++) {
+      sum += (conjugate ? std::conj(x[i]) : x[i])*y[i];
+    }
+    return sum;
+  }
+
+  static ComplexT Sum(const ComplexT* x, const ComplexT* y, const int n,
+      const bool conjugate, std::true_type) {
+    const T* xParts = reinterpret_cast<const T*>(x);
+    const T* yParts = reinterpret_cast<const T*>(y);
+    const int size = 2*n;
+    VecT direct[NbAccumulator], swapped[NbAccumulator];
+    for (int a = 0; a < NbAccumulator; a++) {
+      direct[a] = VecT() + T(0);
+      swapped[a] = VecT() + T(0);
+    }
+    int i = 0;
+    for (; i+NbAccumulator*VecSize <= size; i += NbAccumulator*VecSize) {
+      for (int a = 0; a < NbAccumulator; a++) {
+        const VecT xv = MemOp::load(xParts+i+a*VecSize);
+        const VecT yv = MemOp::load(yParts+i+a*VecSize);
+        direct[a] = FmaOps<T>::MultiplyAdd(xv, yv, direct[a]);
+        swapped[a] = FmaOps<T>::MultiplyAdd(xv, Ops::Swap(yv),
+          swapped[a]);
+      }
+    }
+    //Missing lanes are loaded as zeros
+    for (; i < size; i += VecSize) {
+      const int count = std::min(VecSize, size-i);
+      const VecT xv = MemOp::maskload(xParts+i, count);
+      const VecT yv = MemOp::maskload(yParts+i, count);
+      direct[0] = FmaOps<T>::MultiplyAdd(xv, yv, direct[0]);
+      swapped[0] = FmaOps<T>::MultiplyAdd(xv, Ops::Swap(yv), swapped[0]);
+    }
+    for (int a = 1; a < NbAccumulator; a++) {
+      direct[0] += direct[a];
+      swapped[0] += swapped[a];
+    }
+    //AddSub(0,v) negates the even lanes, its sum is the odd lanes minus
+    //the even ones
+    const VecT zero = VecT() + T(0);
+    if (conjugate) {
+      return ComplexT(VectorSum<T,VecT>::ReduceSum(direct[0]),
+        -VectorSum<T,VecT>::ReduceSum(Ops::AddSub(zero, swapped[0])));
+    }
+    return ComplexT(-VectorSum<T,VecT>::ReduceSum(Ops::AddSub(zero,
+      direct[0])), VectorSum<T,VecT>::ReduceSum(swapped[0]));
+  }
+};
+
+VECTORIZATION_NAMESPACE_END
+#endif //COMPLEXCONVOLUTION_H
@@ -0,0 +1,206 @@
+/*
+ * main.cpp
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: gnthibault
+ */
+
+//STL
+#include <algorithm>
+#include <complex>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//Local
+#include "../ComplexConvolution.h"
+#include "../../Profiling/Benchmark.h"
+
+/*
+ * Complex filters, convolution and correlation, are checked against a
+ * std::complex loop over the extended line, and dot products against
+ * std::complex sums, exactly: parts are small integers and coefficients are
+ * dyadic. Both are then timed against the std::complex loops, for a 31 taps
+ * filter and vectors of 2^20 samples
+ */
+#define SIZE (1024*1024)
+
+//build with
+//g++ ./main.cpp -std=c++14 -O3 -mavx2 -mfma -o test -DUSE_AVX2
+//g++ ./main.cpp -std=c++14 -O3 -march=skylake-avx512 -o test -DUSE_AVX512
+//./test --json complexconvolution.json
+
+template<typename T>
+std::complex<T> RandomSample() {
+  return std::complex<T>(static_cast<T>(rand()%16-8),
+    static_cast<T>(rand()%16-8));
+}
+
+template<typename T>
+std::complex<T> RandomCoefficient() {
+  return std::complex<T>(static_cast<T>(rand()%129-64)/T(64),
+    static_cast<T>(rand()%129-64)/T(64));
+}
+
+//out[i] = sum of c_k*in[i+k-TapSizeLeft], c_k conjugated for correlations
+template<class FILT, class BOUNDARY>
+void Reference(const FILT& filter, const bool conjugate,
+    const std::complex<typename FILT::ScalarType>* in,
+    std::complex<typename FILT::ScalarType>* out, const int n) {
+  typedef std::complex<typename FILT::ScalarType> ComplexT;
+  for (int i = 0; i < n; i++) {
+    ComplexT sum = ComplexT(0);
+    for (int k = 0; k < FILT::TapSize; k++) {
+      const int src = BOUNDARY::Index(i+k-FILT::TapSizeLeft, n);
+      if (src >= 0) {
+        sum += (conjugate ? std::conj(filter.Buf[k]) : filter.Buf[k])*
+          in[src];
+      }
+    }
+    out[i] = sum;
+  }
+}
+
+template<class FILT, class BOUNDARY>
+bool Check(int n) {
+  typedef typename FILT::ScalarType T;
+  typedef std::complex<T> ComplexT;
+  std::vector<ComplexT> coefficients(FILT::TapSize);
+  std::generate(coefficients.begin(), coefficients.end(),
+    RandomCoefficient<T>);
+  const FILT filter(coefficients.data());
+  std::vector<ComplexT> in(n);
+  std::generate(in.begin(), in.end(), RandomSample<T>);
+
+  bool isOK = true;
+  std::vector<ComplexT> control(n);
+  //One more element, that must not be written
+  std::vector<ComplexT> out(n+1);
+  for (bool conjugate : {false, true}) {
+    Reference<FILT,BOUNDARY>(filter, conjugate, in.data(), control.data(), n);
+    std::fill(out.begin(), out.end(), ComplexT(-1));
+    if (conjugate) {
+      ComplexConvolution<FILT,BOUNDARY>::Correlate(filter, in.data(),
+        out.data(), n);
+    } else {
+      ComplexConvolution<FILT,BOUNDARY>::Convolve(filter, in.data(),
+        out.data(), n);
+    }
+    isOK &= std::equal(control.begin(), control.end(), out.begin()) &&
+      out.back() == ComplexT(-1);
+  }
+  return isOK;
+}
+
+template<class FILT>
+bool CheckBoundaries() {
+  bool isOK = true;
+  for (int n : {1, 2, 3, 10, 33, 100, 1000, 5000}) {
+    isOK &= Check<FILT,PeriodicBoundary>(n) &&
+      Check<FILT,MirrorBoundary>(n) &&
+      Check<FILT,ClampBoundary>(n) &&
+      Check<FILT,ZeroBoundary>(n);
+  }
+  return isOK;
+}
+
+template<typename T>
+bool CheckDot() {
+  typedef std::complex<T> ComplexT;
+  bool isOK = true;
+  for (int n : {0, 1, 2, 3, 7, 8, 9, 31, 1000}) {
+    std::vector<ComplexT> x(n), y(n);
+    std::generate(x.begin(), x.end(), RandomSample<T>);
+    std::generate(y.begin(), y.end(), RandomSample<T>);
+    ComplexT dot = ComplexT(0), conjugate = ComplexT(0);
+    for (int i = 0; i < n; i++) {
+      dot += x[i]*y[i];
+      conjugate += std::conj(x[i])*y[i];
+    }
+    isOK &= ComplexInnerProduct<T>::Dot(x.data(), y.data(), n) == dot &&
+      ComplexInnerProduct<T>::Conjugate(x.data(), y.data(), n) == conjugate;
+  }
+  return isOK;
+}
+
+template<typename T>
+void Benchmark(BenchmarkRunner& runner) {
+  typedef std::complex<T> ComplexT;
+  typedef ComplexFilter<T,15,15> FILT;
+  const std::string type = sizeof(T) == sizeof(float) ? "float" : "double";
+  std::vector<ComplexT> coefficients(FILT::TapSize);
+  std::generate(coefficients.begin(), coefficients.end(),
+    RandomCoefficient<T>);
+  const FILT filter(coefficients.data());
+  std::vector<ComplexT> in(SIZE), other(SIZE), out(SIZE);
+  std::generate(in.begin(), in.end(), RandomSample<T>);
+  std::generate(other.begin(), other.end(), RandomSample<T>);
+  //The scalar loop reads an extended copy, made once, such that it does no
+  //modulo per tap
+  std::vector<ComplexT> extended(SIZE+FILT::TapSize-1);
+  PeriodicBoundary::Extend(in.data(), SIZE, -FILT::TapSizeLeft,
+    extended.data(), SIZE+FILT::TapSize-1);
+
+  //A complex multiply-add is 4 multiplies and 4 adds
+  double bytes = 2.*sizeof(ComplexT)*SIZE;
+  double flops = 8.*FILT::TapSize*SIZE;
+  double refMsec = runner.Run("std::complex convolution, "+type, [&]() {
+      for (int i = 0; i < SIZE; i++) {
+        ComplexT sum = ComplexT(0);
+        for (int k = 0; k < FILT::TapSize; k++) {
+          sum += filter.Buf[k]*extended[i+k];
+        }
+        out[i] = sum;
+      }
+      ClobberMemory();
+    }, bytes, flops).median;
+  double msec = runner.Run("complex convolution, "+type, [&]() {
+      ComplexConvolution<FILT>::Convolve(filter, in.data(), out.data(), SIZE);
+      ClobberMemory();
+    }, bytes, flops).median;
+  std::cout << "Speedup for " << type << " complex convolution is "
+    << refMsec/msec << std::endl;
+
+  bytes = 2.*sizeof(ComplexT)*SIZE;
+  flops = 8.*SIZE;
+  ComplexT result = ComplexT(0);
+  refMsec = runner.Run("std::complex dot product, "+type, [&]() {
+      ComplexT sum = ComplexT(0);
+      for (int i = 0; i < SIZE; i++) {
+        sum += in[i]*other[i];
+      }
+      result = sum;
+      DoNotOptimize(result);
+    }, bytes, flops).median;
+  msec = runner.Run("complex dot product, "+type, [&]() {
+      result = ComplexInnerProduct<T>::Dot(in.data(), other.data(), SIZE);
+      DoNotOptimize(result);
+    }, bytes, flops).median;
+  std::cout << "Speedup for " << type << " complex dot product is "
+    << refMsec/msec << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  bool isOK = CheckBoundaries<ComplexFilter<float,0,0>>() &&
+    CheckBoundaries<ComplexFilter<float,1,1>>() &&
+    CheckBoundaries<ComplexFilter<float,3,3>>() &&
+    CheckBoundaries<ComplexFilter<float,2,5>>() &&
+    CheckBoundaries<ComplexFilter<float,0,4>>() &&
+    CheckBoundaries<ComplexFilter<float,15,15>>() &&
+    CheckBoundaries<ComplexFilter<double,3,3>>() &&
+    CheckBoundaries<ComplexFilter<double,4,1>>() &&
+    CheckDot<float>() && CheckDot<double>();
+  if (isOK) {
+    std::cout << "All complex convolution tests returned True Value"
+      << std::endl;
+  } else {
+    std::cout << " WARNING : There may be a bug in complex convolution"
+      << std::endl;
+  }
+
+  BenchmarkRunner runner(argc, argv);
+  Benchmark<float>(runner);
+  Benchmark<double>(runner);
+  return runner.Finish() && isOK ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -5,6 +5,8 @@
 #include "MetaHelper.h"
 #include "vectorization.h"
 
+VECTORIZATION_NAMESPACE_BEGIN
+
 //Perform left and right shift
 template<typename T, class VecT, int SHIFT>
 class VectorizedShift {
@@ -63,6 +65,17 @@ class VectorizedShift<double,__m128d,SHIFT> {
     return (__m128d)_mm_srli_si128( (__m128i)input, SHIFT );
   }
 };
+/*
+ * palignr directly concatenates two integer vectors and shifts them by a
+ * number of bytes, whatever the element size
+ */
+template<typename T, int RIGHT_SHIFT>
+class VectorizedConcatAndCut<T,__m128i,RIGHT_SHIFT> {
+ public:
+  static __m128i Concat( __m128i left, __m128i right ) {
+    return _mm_alignr_epi8( right, left, RIGHT_SHIFT*sizeof(T) );
+  }
+};
 #elif defined USE_AVX2
 template<typename T, typename vecT, int Val, class enable=void>
 struct AVX256ConcatandCut {
@@ -150,6 +163,52 @@ struct AVX256ConcatandCut<double, __m256d, Val,
   }
 };
 
+/*
+ * Integer version, the shift is expressed in bytes, such that the same code
+ * is used for all element types, vpalignr working inside 128 bits lanes,
+ * the middle lane is built first using vperm2i128
+ */
+template<int Bytes, class enable=void>
+struct AVX256IntConcatandCut {
+  static __m256i Concat(__m256i left, __m256i right) {
+    assert(("Vectorized Shift AVX256 cannot account for shift > 256 bits",
+          false));
+    return left;
+  }
+};
+template<int Bytes>
+struct AVX256IntConcatandCut<Bytes, typename ctrange<0, 1, Bytes>::enabled> {
+  static __m256i Concat(__m256i left, __m256i right) {
+    return left;
+  }
+};
+template<int Bytes>
+struct AVX256IntConcatandCut<Bytes, typename ctrange<1, 16, Bytes>::enabled> {
+  static __m256i Concat(__m256i left, __m256i right) {
+    return _mm256_alignr_epi8(_mm256_permute2x128_si256(left,right,33),
+      left, Bytes);
+  }
+};
+template<int Bytes>
+struct AVX256IntConcatandCut<Bytes, typename ctrange<16, 17, Bytes>::enabled> {
+  static __m256i Concat(__m256i left, __m256i right) {
+    return _mm256_permute2x128_si256(left,right,33);
+  }
+};
+template<int Bytes>
+struct AVX256IntConcatandCut<Bytes, typename ctrange<17, 32, Bytes>::enabled> {
+  static __m256i Concat(__m256i left, __m256i right) {
+    return _mm256_alignr_epi8(right,
+      _mm256_permute2x128_si256(left,right,33), Bytes-16);
+  }
+};
+template<int Bytes>
+struct AVX256IntConcatandCut<Bytes, typename ctrange<32, 33, Bytes>::enabled> {
+  static __m256i Concat(__m256i left, __m256i right) {
+    return right;
+  }
+};
+
 template<int RIGHT_SHIFT>
 class VectorizedConcatAndCut<float,__m256,RIGHT_SHIFT> {
  public:
@@ -166,6 +225,140 @@ class VectorizedConcatAndCut<double,__m256d,RIGHT_SHIFT> {
     return AVX256ConcatandCut<double,__m256d,RIGHT_SHIFT>::Concat(left,right);
   }
 };
+template<typename T, int RIGHT_SHIFT>
+class VectorizedConcatAndCut<T,__m256i,RIGHT_SHIFT> {
+ public:
+  static __m256i Concat( __m256i left, __m256i right ) {
+    return AVX256IntConcatandCut<RIGHT_SHIFT*sizeof(T)>::Concat(left,right);
+  }
+};
+#elif defined USE_AVX512
+/*
+ * valignd / valignq directly perform the concatenation of two 512 bits
+ * vectors followed by a right shift of a given number of elements, only the
+ * bounds (no shift, full shift) have to be handled separately because the
+ * immediate is taken modulo the number of elements
+ */
+template<typename T, typename vecT, int Val, class enable=void>
+struct AVX512ConcatandCut {
+  static vecT Concat(vecT left, vecT right) {
+    assert(("Vectorized Shift AVX512 cannot account for shift > 512 bits",
+          false));
+    return left;
+  }
+};
+
+template<int Val>
+struct AVX512ConcatandCut<float, __m512, Val,
+    typename ctrange<0, 1, Val>::enabled> {
+  static __m512 Concat(__m512 left, __m512 right) {
+    return left;
+  }
+};
+template<int Val>
+struct AVX512ConcatandCut<float, __m512, Val,
+    typename ctrange<1, 16, Val>::enabled> {
+  static __m512 Concat(__m512 left, __m512 right) {
+    return _mm512_castsi512_ps(_mm512_alignr_epi32(
+      _mm512_castps_si512(right), _mm512_castps_si512(left), Val));
+  }
+};
+template<int Val>
+struct AVX512ConcatandCut<float, __m512, Val,
+    typename ctrange<16, 17, Val>::enabled> {
+  static __m512 Concat(__m512 left, __m512 right) {
+    return right;
+  }
+};
+template<int Val>
+struct AVX512ConcatandCut<double, __m512d, Val,
+    typename ctrange<0, 1, Val>::enabled> {
+  static __m512d Concat(__m512d left, __m512d right) {
+    return left;
+  }
+};
+template<int Val>
+struct AVX512ConcatandCut<double, __m512d, Val,
+    typename ctrange<1, 8, Val>::enabled> {
+  static __m512d Concat(__m512d left, __m512d right) {
+    return _mm512_castsi512_pd(_mm512_alignr_epi64(
+      _mm512_castpd_si512(right), _mm512_castpd_si512(left), Val));
+  }
+};
+template<int Val>
+struct AVX512ConcatandCut<double, __m512d, Val,
+    typename ctrange<8, 9, Val>::enabled> {
+  static __m512d Concat(__m512d left, __m512d right) {
+    return right;
+  }
+};
+
+/*
+ * Integer version, the shift is expressed in bytes. Whole 32 bits shifts
+ * are handled by valignd, other ones need avx512bw: two valignd build the
+ * 128 bits lanes to be blended by vpalignr
+ */
+template<int Bytes, class enable=void>
+struct AVX512IntConcatandCut {
+  static __m512i Concat(__m512i left, __m512i right) {
+    assert(("Vectorized Shift AVX512 cannot account for shift > 512 bits",
+          false));
+    return left;
+  }
+};
+template<int Bytes>
+struct AVX512IntConcatandCut<Bytes, typename ctrange<0, 1, Bytes>::enabled> {
+  static __m512i Concat(__m512i left, __m512i right) {
+    return left;
+  }
+};
+template<int Bytes>
+struct AVX512IntConcatandCut<Bytes, typename ctrange<1, 64, Bytes>::enabled> {
+  static __m512i Concat(__m512i left, __m512i right) {
+    if (Bytes%4 == 0) {
+      return _mm512_alignr_epi32(right, left, (Bytes/4)&15);
+    }
+#ifdef __AVX512BW__
+    __m512i low = _mm512_alignr_epi32(right, left, (Bytes/16)*4);
+    __m512i high = Bytes < 48 ?
+      _mm512_alignr_epi32(right, left, ((Bytes/16+1)*4)&15) : right;
+    return _mm512_alignr_epi8(high, low, Bytes%16);
+#else
+    assert(("Sub 32 bits shifts need AVX512BW", false));
+    return left;
+#endif
+  }
+};
+template<int Bytes>
+struct AVX512IntConcatandCut<Bytes, typename ctrange<64, 65, Bytes>::enabled> {
+  static __m512i Concat(__m512i left, __m512i right) {
+    return right;
+  }
+};
+
+template<int RIGHT_SHIFT>
+class VectorizedConcatAndCut<float,__m512,RIGHT_SHIFT> {
+ public:
+  //Optimized specific intrinsic for concat / shift / cut in AVX512
+  static __m512 Concat( __m512 left, __m512 right ) {
+    return AVX512ConcatandCut<float,__m512,RIGHT_SHIFT>::Concat(left,right);
+  }
+};
+template<int RIGHT_SHIFT>
+class VectorizedConcatAndCut<double,__m512d,RIGHT_SHIFT> {
+ public:
+  //Optimized specific intrinsic for concat / shift / cut in AVX512
+  static __m512d Concat( __m512d left, __m512d right ) {
+    return AVX512ConcatandCut<double,__m512d,RIGHT_SHIFT>::Concat(left,right);
+  }
+};
+template<typename T, int RIGHT_SHIFT>
+class VectorizedConcatAndCut<T,__m512i,RIGHT_SHIFT> {
+ public:
+  static __m512i Concat( __m512i left, __m512i right ) {
+    return AVX512IntConcatandCut<RIGHT_SHIFT*sizeof(T)>::Concat(left,right);
+  }
+};
 #elif defined USE_NEON
 template<int RIGHT_SHIFT>
 class VectorizedConcatAndCut<float,float32x4_t,RIGHT_SHIFT> {
@@ -184,4 +377,6 @@ class VectorizedConcatAndCut<double,float64x2_t,RIGHT_SHIFT> {
   }
 };
 #endif
+
+VECTORIZATION_NAMESPACE_END
 #endif // CONCATANDCUT_H
@@ -1,12 +1,41 @@
+#ifndef CONVOLUTION_H
+#define CONVOLUTION_H
+
 //STL
+#include <cstddef>
 #include <cstdlib>
 #include <iostream>
 #include <functional>
 #include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
 
 //Local
+#include "Boundary.h"
 #include "ConcatAndCut.h"
+#include "FusedMultiplyAdd.h"
+#include "HalfFloat.h"
 #include "MemoryHelper.h"
+#include "WideningArithmetic.h"
+#include "../Profiling/PerfCounters.h"
+
+VECTORIZATION_NAMESPACE_BEGIN
+
+/*
+ * Symmetry of the coefficients of a filter, around its center:
+ * - Symmetric: Buf[k] == Buf[TapSize-1-k] (gaussian, half-band...)
+ * - Antisymmetric: Buf[k] == -Buf[TapSize-1-k] (derivatives...), the center
+ *   coefficient of odd sizes is then null
+ * Floating point kernels add or subtract the mirrored taps first, then
+ * multiply them once by their common coefficient. Buf still holds all the
+ * coefficients, that are not checked for symmetry
+ */
+enum class FilterSymmetry {
+  None,
+  Symmetric,
+  Antisymmetric
+};
 
 /*
  * TAP_SIZE_LEFT does only account for number of elements at left,
@@ -15,7 +44,8 @@
  * without the current one.
  * Convolution for VEC_SIZE elements will be computed
  */
-template<typename T, int TAP_SIZE_LEFT, int TAP_SIZE_RIGHT>
+template<typename T, int TAP_SIZE_LEFT, int TAP_SIZE_RIGHT,
+  FilterSymmetry SYMMETRY=FilterSymmetry::None>
 class Filter {
 public:
   Filter()=default;
@@ -24,6 +54,10 @@ public:
   typedef T ScalarType;
   //Typedef vector type
   typedef PackType<T> VectorType;
+  //Type of the coefficients
+  typedef T CoefficientType;
+  //Type in which the taps are summed before being narrowed back to T
+  typedef T AccumulatorType;
   //Total size of the filter, in number of elements
   constexpr static int TapSize =
     TAP_SIZE_LEFT + TAP_SIZE_RIGHT + 1; //+1 = the center pixel
@@ -34,14 +68,23 @@ public:
     (TapSize+VecSize-1)/(VecSize);
   constexpr static int TapSizeLeft = TAP_SIZE_LEFT;
   constexpr static int TapSizeRight = TAP_SIZE_RIGHT;
+  constexpr static FilterSymmetry Symmetry = SYMMETRY;
+  static_assert(SYMMETRY != FilterSymmetry::Antisymmetric || TapSize > 1,
+    "A single tap antisymmetric filter is null");
+
+  //Conversion of a sum of taps to the output type
+  static T Narrow(AccumulatorType value) {
+    return value;
+  }
 };
 
 /*
  * We define an inheritance of the fully generic filter for an arbitrary
  * MyFilter
  */
-template<typename T, int TAP_SIZE_LEFT, int TAP_SIZE_RIGHT>
-class MyFilter : public Filter<T,TAP_SIZE_LEFT,TAP_SIZE_RIGHT> {
+template<typename T, int TAP_SIZE_LEFT, int TAP_SIZE_RIGHT,
+  FilterSymmetry SYMMETRY=FilterSymmetry::None>
+class MyFilter : public Filter<T,TAP_SIZE_LEFT,TAP_SIZE_RIGHT,SYMMETRY> {
 public:
   MyFilter()=default;
 public:
@@ -49,19 +92,161 @@ public:
 };
 
 /*
- * From the prefetch buffer in input, generates a vector that contains
+ * Coefficients of a filter whose static Buf is known at compile time, they
+ * end up as immediate broadcasts in the kernels
+ */
+template<class FILT>
+class StaticCoefficients {
+public:
+  typedef typename FILT::CoefficientType CoefficientType;
+
+  template<int IDX>
+  CoefficientType Get() const {
+    return FILT::Buf[IDX];
+  }
+
+  CoefficientType operator[](int idx) const {
+    return FILT::Buf[idx];
+  }
+};
+
+/*
+ * Filter with compile time tap sizes, whose coefficients are only known at
+ * runtime (configuration files, filter design...). BASE is the filter family
+ * it belongs to, such as Filter<float,3,3> or IntegerFilter<uint8_t,3,3,6>.
+ * Use Convolution<RuntimeFilter<...>>::Convolve(filter, in, out, lineSize):
+ * the coefficients are broadcast once per call, in registers held for the
+ * whole line, such that the kernel is the same as for a compile time filter
+ */
+template<class BASE>
+class RuntimeFilter : public BASE {
+public:
+  typedef typename BASE::CoefficientType CoefficientType;
+  typedef typename BASE::VectorType VectorType;
+
+  explicit RuntimeFilter(const CoefficientType* coefficients) {
+    std::copy(coefficients, coefficients+BASE::TapSize, Buf);
+  }
+
+  /*
+   * Floating point coefficients are multiplied with whole vectors, they are
+   * stored as vectors. Integer ones are paired by the widening
+   * multiply-accumulate, they are stored as scalars
+   */
+  class Coefficients {
+  public:
+    typedef typename std::conditional<std::is_floating_point<
+      typename BASE::ScalarType>::value, VectorType, CoefficientType>::type
+      StorageType;
+
+    explicit Coefficients(const CoefficientType* buf) {
+      for (int k = 0; k < BASE::TapSize; k++) {
+        m_buf[k] = StorageType() + buf[k];
+      }
+    }
+
+    template<int IDX>
+    StorageType Get() const {
+      return m_buf[IDX];
+    }
+
+    StorageType operator[](int idx) const {
+      return m_buf[idx];
+    }
+  protected:
+    StorageType m_buf[BASE::TapSize];
+  };
+
+  Coefficients Broadcast() const {
+    return Coefficients(Buf);
+  }
+
+  CoefficientType Buf[BASE::TapSize];
+};
+
+/*
+ * Filter for 8 bits unsigned or 16 bits signed pixels: coefficients are 16
+ * bits fixed point values with SHIFT fractional bits, taps are summed in 32
+ * bits, then rounded to nearest and saturated to the range of T
+ */
+template<typename T, int TAP_SIZE_LEFT, int TAP_SIZE_RIGHT, int SHIFT>
+class IntegerFilter : public Filter<T,TAP_SIZE_LEFT,TAP_SIZE_RIGHT> {
+public:
+  IntegerFilter()=default;
+public:
+  static_assert(std::is_same<T,uint8_t>::value ||
+    std::is_same<T,int16_t>::value, "IntegerFilter needs uint8_t or int16_t");
+  typedef int16_t CoefficientType;
+  typedef int32_t AccumulatorType;
+  constexpr static int Shift = SHIFT;
+
+  static T Narrow(AccumulatorType value) {
+    if (SHIFT > 0) {
+      value = (value + ((1 << SHIFT) >> 1)) >> SHIFT;
+    }
+    return static_cast<T>(std::min<AccumulatorType>(
+      std::max<AccumulatorType>(value, std::numeric_limits<T>::min()),
+      std::numeric_limits<T>::max()));
+  }
+};
+
+template<typename T, int TAP_SIZE_LEFT, int TAP_SIZE_RIGHT, int SHIFT>
+class MyIntegerFilter :
+    public IntegerFilter<T,TAP_SIZE_LEFT,TAP_SIZE_RIGHT,SHIFT> {
+public:
+  MyIntegerFilter()=default;
+public:
+  static const int16_t Buf[Filter<T,TAP_SIZE_LEFT,TAP_SIZE_RIGHT>::TapSize];
+};
+
+/*
+ * The prefetch area, made of SIZE vectors, seen through a rotation: logical
+ * vector IDX is stored in vec[(IDX+ROTATION)%SIZE]. All indexes being known
+ * at compile time, the vectors never go through memory once the loop is
+ * unrolled, and advancing the window by one vector is a change of ROTATION,
+ * that is a renaming of registers, instead of a shift of the whole area
+ */
+template<typename VecT, int SIZE, int ROTATION>
+class PrefetchWindow {
+public:
+  explicit PrefetchWindow(VecT* vec) : m_vec(vec) {}
+
+  template<int IDX>
+  VecT Get() const {
+    return m_vec[(IDX+ROTATION)%SIZE];
+  }
+
+  //Runtime index, only used by scalar filters, where vectors are elements
+  VecT operator[](int idx) const {
+    return m_vec[(idx+ROTATION)%SIZE];
+  }
+
+  //Slot that receives the next vector of input, before the computation
+  VecT& Last() {
+    return m_vec[(SIZE-1+ROTATION)%SIZE];
+  }
+protected:
+  VecT* m_vec;
+};
+
+/*
+ * From the prefetch window in input, generates a vector that contains
  * the "SUPPORT_IDX" th element of each element of the current "output" vector
  * of the algorithm.
  */
 template<typename T, int PREFETCH_BEGIN_IDX, int SUPPORT_IDX>
 class ConvolutionShifter {
 public:
-  static PackType<T> generateNewVec(T* prefetch) {
+  template<class WINDOW>
+  static PackType<T> generateNewVec(const WINDOW& prefetch) {
     //Fetch left part and right part, to be mixed after
-    PackType<T> left = VectorizedMemOp<T,PackType<T> >::load(
-        prefetch+VecLeftIdx );
-    PackType<T> right = VectorizedMemOp<T,PackType<T> >::load(
-        prefetch+VecRightIdx );
+    PackType<T> left = prefetch.template Get<VecLeftIdx>();
+    //Aligned support: the right part is not needed, and may even lie
+    //outside of the prefetch window
+    if (RightShift == 0) {
+      return left;
+    }
+    PackType<T> right = prefetch.template Get<VecRightIdx>();
 
     //Return the generated vector
     return VectorizedConcatAndCut<T,PackType<T>,RightShift>::Concat(
@@ -69,10 +254,9 @@ public:
   }
 private:
   constexpr static int VecSize = sizeof(PackType<T>)/sizeof(T);
-  //Indexes in the prefetch buffer of vector to be loaded
-  constexpr static int VecLeftIdx = ((PREFETCH_BEGIN_IDX+SUPPORT_IDX)/VecSize)
-    *VecSize;
-  constexpr static int VecRightIdx = VecLeftIdx+VecSize;
+  //Indexes in the prefetch window of vector to be loaded
+  constexpr static int VecLeftIdx = (PREFETCH_BEGIN_IDX+SUPPORT_IDX)/VecSize;
+  constexpr static int VecRightIdx = VecLeftIdx+1;
   //Shift that should be applied to the 2 neighbouring vector to be blended
   //together
   constexpr static int RightShift = ((PREFETCH_BEGIN_IDX+SUPPORT_IDX)%VecSize);
@@ -81,17 +265,19 @@ private:
 template<typename T, class FILT, int PREFETCH_BEGIN_IDX, int SUPPORT_IDX>
 class ConvolutionAccumulator {
 public:
-  static typename FILT::VectorType Accumulate(T* prefetch) {
+  template<class WINDOW, class COEFS>
+  static typename FILT::VectorType Accumulate(const WINDOW& prefetch,
+      const COEFS& coefs) {
     //Recursive call over all previous index of filter support
     typename FILT::VectorType accumulator = ConvolutionAccumulator<T,FILT,
-      PREFETCH_BEGIN_IDX,SUPPORT_IDX-1>::Accumulate(prefetch);
+      PREFETCH_BEGIN_IDX,SUPPORT_IDX-1>::Accumulate(prefetch, coefs);
 
     //Craft newVec from two vectors
     typename FILT::VectorType newVec = ConvolutionShifter<T,PREFETCH_BEGIN_IDX,
       SUPPORT_IDX>::generateNewVec( prefetch );
 
     //Accumulate
-    return accumulator + FILT::Buf[SUPPORT_IDX]*newVec;
+    return accumulator + coefs.template Get<SUPPORT_IDX>()*newVec;
   }
 };
 
@@ -100,40 +286,480 @@ template<typename T, class FILT, int PREFETCH_BEGIN_IDX>
 class ConvolutionAccumulator<T,FILT,PREFETCH_BEGIN_IDX,0> {
 public:
   //accumulator is uninitialized
-  static typename FILT::VectorType Accumulate(T* prefetch) {
+  template<class WINDOW, class COEFS>
+  static typename FILT::VectorType Accumulate(const WINDOW& prefetch,
+      const COEFS& coefs) {
     //generate new vector if firstindex to process was not aligned,
     //PrefetchBeginIdx is not null
     typename FILT::VectorType newVec=
       ConvolutionShifter<T,PREFETCH_BEGIN_IDX,0>::generateNewVec(prefetch);
 
     //First call: we must initialize the accumulator
-    return FILT::Buf[0]*newVec;
+    return coefs.template Get<0>()*newVec;
   }
 };
 
-inline int positive_modulo(int i, int n) {
-  return (i % n + n) % n;
-}
+/*
+ * Fused multiply-add version of the accumulator: taps are spread round robin
+ * over NB_CHAINS independent accumulators, tap SUPPORT_IDX going to chain
+ * SUPPORT_IDX%NB_CHAINS, such that consecutive fma do not wait for each
+ * other, then chains are summed once all taps have been processed
+ */
+template<typename T, class FILT, int PREFETCH_BEGIN_IDX, int SUPPORT_IDX,
+  int NB_CHAINS>
+class FmaConvolutionAccumulator {
+public:
+  typedef typename FILT::VectorType VecT;
 
-template<class FILT>
+  template<class WINDOW, class COEFS>
+  static void Accumulate(const WINDOW& prefetch, const COEFS& coefs,
+      VecT* acc) {
+    //Recursive call over all previous index of filter support
+    FmaConvolutionAccumulator<T,FILT,PREFETCH_BEGIN_IDX,SUPPORT_IDX-1,
+      NB_CHAINS>::Accumulate(prefetch, coefs, acc);
+
+    VecT newVec = ConvolutionShifter<T,PREFETCH_BEGIN_IDX,SUPPORT_IDX>::
+      generateNewVec(prefetch);
+    //The first tap of each chain initializes it
+    if (SUPPORT_IDX < NB_CHAINS) {
+      acc[SUPPORT_IDX%NB_CHAINS] = (VecT() + coefs.template Get<SUPPORT_IDX>())
+        *newVec;
+    } else {
+      acc[SUPPORT_IDX%NB_CHAINS] = FmaOps<T>::MultiplyAdd(
+        VecT() + coefs.template Get<SUPPORT_IDX>(), newVec,
+        acc[SUPPORT_IDX%NB_CHAINS]);
+    }
+  }
+};
+
+//Partial template specialization for the end of the recursion
+template<typename T, class FILT, int PREFETCH_BEGIN_IDX, int NB_CHAINS>
+class FmaConvolutionAccumulator<T,FILT,PREFETCH_BEGIN_IDX,-1,NB_CHAINS> {
+public:
+  template<class WINDOW, class COEFS>
+  static void Accumulate(const WINDOW& prefetch, const COEFS& coefs,
+    typename FILT::VectorType* acc) {}
+};
+
+/*
+ * Sum, or difference for antisymmetric filters, of the mirrored taps
+ * PAIR_IDX and TapSize-1-PAIR_IDX
+ */
+template<typename T, class FILT, int PREFETCH_BEGIN_IDX, int PAIR_IDX>
+class MirroredTaps {
+public:
+  template<class WINDOW>
+  static typename FILT::VectorType Fold(const WINDOW& prefetch) {
+    typename FILT::VectorType left = ConvolutionShifter<T,PREFETCH_BEGIN_IDX,
+      PAIR_IDX>::generateNewVec(prefetch);
+    typename FILT::VectorType right = ConvolutionShifter<T,
+      PREFETCH_BEGIN_IDX,FILT::TapSize-1-PAIR_IDX>::generateNewVec(prefetch);
+    return FILT::Symmetry == FilterSymmetry::Symmetric ? left+right :
+      left-right;
+  }
+};
+
+/*
+ * Accumulator for symmetric and antisymmetric filters, over the pairs of
+ * mirrored taps: one add or subtract, and a single multiply, per pair
+ */
+template<typename T, class FILT, int PREFETCH_BEGIN_IDX, int PAIR_IDX>
+class FoldedConvolutionAccumulator {
+public:
+  template<class WINDOW, class COEFS>
+  static typename FILT::VectorType Accumulate(const WINDOW& prefetch,
+      const COEFS& coefs) {
+    //Recursive call over all previous pairs of the filter support
+    typename FILT::VectorType accumulator = FoldedConvolutionAccumulator<T,
+      FILT,PREFETCH_BEGIN_IDX,PAIR_IDX-1>::Accumulate(prefetch, coefs);
+    return accumulator + coefs.template Get<PAIR_IDX>()*MirroredTaps<T,FILT,
+      PREFETCH_BEGIN_IDX,PAIR_IDX>::Fold(prefetch);
+  }
+};
+
+//Partial template specialization for the first pair, that also accounts
+//for the center tap of odd symmetric filters
+template<typename T, class FILT, int PREFETCH_BEGIN_IDX>
+class FoldedConvolutionAccumulator<T,FILT,PREFETCH_BEGIN_IDX,0> {
+public:
+  template<class WINDOW, class COEFS>
+  static typename FILT::VectorType Accumulate(const WINDOW& prefetch,
+      const COEFS& coefs) {
+    typename FILT::VectorType accumulator = coefs.template Get<0>()*
+      MirroredTaps<T,FILT,PREFETCH_BEGIN_IDX,0>::Fold(prefetch);
+    if (HasCenter) {
+      accumulator += coefs.template Get<Center>()*ConvolutionShifter<T,
+        PREFETCH_BEGIN_IDX,Center>::generateNewVec(prefetch);
+    }
+    return accumulator;
+  }
+private:
+  constexpr static int Center = FILT::TapSize/2;
+  constexpr static bool HasCenter = FILT::TapSize%2 == 1 &&
+    FILT::Symmetry == FilterSymmetry::Symmetric;
+};
+
+/*
+ * Integer version of the accumulator: taps are processed by pairs, each pair
+ * being widened and multiplied by its two coefficients at once, into 32 bits
+ * accumulators. For odd tap sizes, the last pair is completed with a null
+ * coefficient
+ */
+template<typename T, class FILT, int PREFETCH_BEGIN_IDX, int PAIR_IDX>
+class IntegerConvolutionAccumulator {
+public:
+  typedef typename FILT::VectorType VecT;
+  typedef WideningMultiplyAccumulate<T,VecT> Mac;
+
+  template<class WINDOW, class COEFS>
+  static void Accumulate(const WINDOW& prefetch, const COEFS& coefs,
+      VecT* acc) {
+    //Recursive call over all previous pairs of the filter support
+    IntegerConvolutionAccumulator<T,FILT,PREFETCH_BEGIN_IDX,PAIR_IDX-1>::
+      Accumulate(prefetch, coefs, acc);
+
+    Mac::Accumulate(
+      ConvolutionShifter<T,PREFETCH_BEGIN_IDX,First>::generateNewVec(prefetch),
+      ConvolutionShifter<T,PREFETCH_BEGIN_IDX,Second>::generateNewVec(prefetch),
+      Mac::Coefficients( coefs.template Get<First>(),
+        First+1 < FILT::TapSize ? coefs.template Get<Second>() : 0 ), acc);
+  }
+private:
+  constexpr static int First = 2*PAIR_IDX;
+  constexpr static int Second = First+1 < FILT::TapSize ? First+1 : First;
+};
+
+//Partial template specialization for the end of the recursion
+template<typename T, class FILT, int PREFETCH_BEGIN_IDX>
+class IntegerConvolutionAccumulator<T,FILT,PREFETCH_BEGIN_IDX,-1> {
+public:
+  template<class WINDOW, class COEFS>
+  static void Accumulate(const WINDOW& prefetch, const COEFS& coefs,
+    typename FILT::VectorType* acc) {}
+};
+
+/*
+ * Computes one vector of output from the prefetch buffer, selecting the
+ * accumulation scheme from the filter type:
+ * - floating point: ConvolutionAccumulator, plain vector arithmetic, or
+ *   FmaConvolutionAccumulator when the target has fused multiply-add, or
+ *   FoldedConvolutionAccumulator for symmetric and antisymmetric filters
+ * - integer vectors: widening IntegerConvolutionAccumulator, that already
+ *   multiplies pairs of taps at once, symmetry is ignored
+ * - integer scalars: sum in FILT::AccumulatorType, then narrowing
+ */
+template<class FILT, int PREFETCH_BEGIN_IDX, class enable=void>
+class ConvolutionKernel {
+public:
+  typedef typename FILT::ScalarType T;
+  typedef typename FILT::VectorType VecT;
+  typedef typename std::conditional<
+    FILT::Symmetry == FilterSymmetry::None || FILT::TapSize == 1,
+    ConvolutionAccumulator<T,FILT,PREFETCH_BEGIN_IDX,FILT::TapSize-1>,
+    FoldedConvolutionAccumulator<T,FILT,PREFETCH_BEGIN_IDX,
+      FILT::TapSize/2-1>>::type Accumulator;
+
+  template<class WINDOW, class COEFS>
+  static VecT Compute(const WINDOW& prefetch, const COEFS& coefs) {
+    return Compute(prefetch, coefs, std::integral_constant<bool,
+      FmaOps<T>::Fused && FILT::Symmetry == FilterSymmetry::None &&
+      FILT::TapSize >= 8>());
+  }
+
+  /*
+   * Independent fma chains, for about 4 taps each: a single chain of n taps
+   * has a latency of 4n cycles, that the out of order engine can only
+   * partially overlap with the next output vectors. Below 8 taps, the chain
+   * is short enough, and the plain accumulator, that compilers contract to
+   * fma anyway, is as fast
+   */
+  constexpr static int NbChains = FILT::TapSize < 12 ? 2 :
+    (FILT::TapSize < 16 ? 3 : 4);
+
+protected:
+  template<class WINDOW, class COEFS>
+  static VecT Compute(const WINDOW& prefetch, const COEFS& coefs,
+      std::false_type) {
+    return Accumulator::Accumulate(prefetch, coefs);
+  }
+
+  template<class WINDOW, class COEFS>
+  static VecT Compute(const WINDOW& prefetch, const COEFS& coefs,
+      std::true_type) {
+    VecT acc[NbChains];
+    FmaConvolutionAccumulator<T,FILT,PREFETCH_BEGIN_IDX,FILT::TapSize-1,
+      NbChains>::Accumulate(prefetch, coefs, acc);
+    //Pairwise sum of the chains
+    for (int width = 1; width < NbChains; width *= 2) {
+      for (int j = 0; j+width < NbChains; j += 2*width) {
+        acc[j] += acc[j+width];
+      }
+    }
+    return acc[0];
+  }
+};
+
+template<class FILT, int PREFETCH_BEGIN_IDX>
+class ConvolutionKernel<FILT,PREFETCH_BEGIN_IDX,typename std::enable_if<
+    std::is_integral<typename FILT::ScalarType>::value &&
+    !std::is_same<typename FILT::ScalarType,
+    typename FILT::VectorType>::value>::type> {
+public:
+  typedef typename FILT::ScalarType T;
+  typedef typename FILT::VectorType VecT;
+  typedef WideningMultiplyAccumulate<T,VecT> Mac;
+
+  template<class WINDOW, class COEFS>
+  static VecT Compute(const WINDOW& prefetch, const COEFS& coefs) {
+    VecT acc[Mac::NbAccumulator];
+    std::fill(acc, acc+Mac::NbAccumulator, WideningOps<VecT>::Zero());
+    IntegerConvolutionAccumulator<T,FILT,PREFETCH_BEGIN_IDX,
+      (FILT::TapSize+1)/2-1>::Accumulate(prefetch, coefs, acc);
+    return Mac::template Finalize<FILT::Shift>(acc);
+  }
+};
+
+template<class FILT, int PREFETCH_BEGIN_IDX>
+class ConvolutionKernel<FILT,PREFETCH_BEGIN_IDX,typename std::enable_if<
+    std::is_integral<typename FILT::ScalarType>::value &&
+    std::is_same<typename FILT::ScalarType,
+    typename FILT::VectorType>::value>::type> {
+public:
+  typedef typename FILT::ScalarType T;
+  template<class WINDOW, class COEFS>
+  static T Compute(const WINDOW& prefetch, const COEFS& coefs) {
+    typename FILT::AccumulatorType sum = 0;
+    for (int k = 0; k < FILT::TapSize; k++) {
+      sum += coefs[k]*prefetch[PREFETCH_BEGIN_IDX+k];
+    }
+    return FILT::Narrow(sum);
+  }
+};
+
+template<class FILT, class BOUNDARY_POLICY>
+class FftConvolution;
+
+/*
+ * LOAD_POLICY is the memory access policy used to read the input line,
+ * STORE_POLICY the one used to write the output line (see MemoryHelper.h).
+ * Use UnalignedMemory for pointers that are not vector aligned, and
+ * StreamingMemory for large outputs, that should not evict the input from
+ * the cache.
+ * in and out may use a storage type that differs from the filter scalar
+ * type, such as Half or BFloat16 for a float filter: elements are then
+ * converted by VectorizedMemOp on load and store, while all the arithmetic is
+ * still performed on FILT::VectorType
+ * BOUNDARY_POLICY tells how the line is extended beyond its ends, periodic
+ * by default (see Boundary.h). Only the border buffers depend on it, such
+ * that outputs near the ends cost about the same as the other ones
+ * Floating point filters of LongTapSize taps or more, on lines of their own
+ * scalar type, go to FftConvolution, that picks a runtime loop over the taps
+ * or an FFT, instead of instantiating the kernel for each tap. Memory
+ * policies do not apply to them
+ */
+template<class FILT, class LOAD_POLICY=AlignedMemory,
+  class STORE_POLICY=AlignedMemory, class BOUNDARY_POLICY=PeriodicBoundary>
 class Convolution {
 public:
   Convolution()=default;
   static void NaiveConvolve(const typename FILT::ScalarType* in,
     typename FILT::ScalarType* out, const int firstIndexIncluded,
     const int lastIndexExcluded, const int lineSize) {
+    NaiveConvolve(FILT::Buf, in, out, firstIndexIncluded, lastIndexExcluded,
+      lineSize);
+  }
+
+  //Reference for runtime filters
+  static void NaiveConvolve(const FILT& filter,
+    const typename FILT::ScalarType* in, typename FILT::ScalarType* out,
+    const int firstIndexIncluded, const int lastIndexExcluded,
+    const int lineSize) {
+    NaiveConvolve(filter.Buf, in, out, firstIndexIncluded, lastIndexExcluded,
+      lineSize);
+  }
+
+  //Tap count from which floating point filters go to FftConvolution
+  constexpr static int LongTapSize = 32;
+
+  template<typename IN_T, typename OUT_T>
+  static void Convolve(const IN_T* in, OUT_T* out, const int lineSize) {
+    ConvolveStatic(in, out, lineSize, IsLong<IN_T,OUT_T>());
+  }
+
+  //Filter with runtime coefficients, see RuntimeFilter
+  template<typename IN_T, typename OUT_T>
+  static void Convolve(const FILT& filter, const IN_T* in, OUT_T* out,
+      const int lineSize) {
+    ConvolveRuntime(filter, in, out, lineSize, IsLong<IN_T,OUT_T>());
+  }
+
+  /*
+   * nLines lines of lineSize elements each, whose beginnings are stride
+   * elements apart in both in and out (stride must be a multiple of the
+   * vector size for aligned policies). Lines are distributed over the OpenMP
+   * threads, coefficients are set up once for the whole batch, and border
+   * buffers live on the stack of each thread.
+   * Each thread processes its lines by groups of NB_INTERLEAVED, whose
+   * output vectors are computed alternately, such that the kernels of the
+   * group overlap in the pipeline. The rotating window already exposes
+   * enough independent work for most filters, and more lines in flight
+   * means more registers, such that 1 is the default: 2 to 4 are worth a
+   * try for long filters on cores with a large out of order window
+   */
+  template<int NB_INTERLEAVED=1, typename IN_T, typename OUT_T>
+  static void ConvolveBatch(const IN_T* in, OUT_T* out, const int lineSize,
+      const int nLines, const int stride) {
+    BatchStatic<NB_INTERLEAVED>(in, out, lineSize, nLines, stride,
+      IsLong<IN_T,OUT_T>());
+  }
+
+  template<int NB_INTERLEAVED=1, typename IN_T, typename OUT_T>
+  static void ConvolveBatch(const FILT& filter, const IN_T* in, OUT_T* out,
+      const int lineSize, const int nLines, const int stride) {
+    BatchRuntime<NB_INTERLEAVED>(filter, in, out, lineSize, nLines, stride,
+      IsLong<IN_T,OUT_T>());
+  }
+
+protected:
+  typedef typename FILT::ScalarType T;
+  typedef typename FILT::VectorType VecT;
+  typedef FftConvolution<FILT,BOUNDARY_POLICY> LongConvolution;
+
+  template<typename IN_T, typename OUT_T>
+  using IsLong = std::integral_constant<bool,
+    std::is_floating_point<T>::value && std::is_same<IN_T,T>::value &&
+    std::is_same<OUT_T,T>::value && FILT::TapSize >= LongTapSize>;
+
+  template<typename IN_T, typename OUT_T>
+  static void ConvolveStatic(const IN_T* in, OUT_T* out, const int lineSize,
+      std::false_type) {
+    ConvolveLine(StaticCoefficients<FILT>(), in, out, lineSize);
+  }
+
+  static void ConvolveStatic(const T* in, T* out, const int lineSize,
+      std::true_type) {
+    LongConvolution::Convolve(in, out, lineSize);
+  }
+
+  template<typename IN_T, typename OUT_T>
+  static void ConvolveRuntime(const FILT& filter, const IN_T* in, OUT_T* out,
+      const int lineSize, std::false_type) {
+    ConvolveLine(filter.Broadcast(), in, out, lineSize);
+  }
+
+  static void ConvolveRuntime(const FILT& filter, const T* in, T* out,
+      const int lineSize, std::true_type) {
+    LongConvolution::Convolve(filter, in, out, lineSize);
+  }
+
+  template<int NB_INTERLEAVED, typename IN_T, typename OUT_T>
+  static void BatchStatic(const IN_T* in, OUT_T* out, const int lineSize,
+      const int nLines, const int stride, std::false_type) {
+    ConvolveLines<NB_INTERLEAVED>(StaticCoefficients<FILT>(), in, out,
+      lineSize, nLines, stride);
+  }
+
+  //One line per iteration, FftConvolution already has enough independent
+  //work in a line
+  template<int NB_INTERLEAVED>
+  static void BatchStatic(const T* in, T* out, const int lineSize,
+      const int nLines, const int stride, std::true_type) {
+    #pragma omp parallel for schedule(static)
+    for (int line = 0; line < nLines; line++) {
+      LongConvolution::Convolve(in+static_cast<std::ptrdiff_t>(line)*stride,
+        out+static_cast<std::ptrdiff_t>(line)*stride, lineSize);
+    }
+  }
+
+  template<int NB_INTERLEAVED, typename IN_T, typename OUT_T>
+  static void BatchRuntime(const FILT& filter, const IN_T* in, OUT_T* out,
+      const int lineSize, const int nLines, const int stride,
+      std::false_type) {
+    ConvolveLines<NB_INTERLEAVED>(filter.Broadcast(), in, out, lineSize,
+      nLines, stride);
+  }
+
+  template<int NB_INTERLEAVED>
+  static void BatchRuntime(const FILT& filter, const T* in, T* out,
+      const int lineSize, const int nLines, const int stride,
+      std::true_type) {
+    #pragma omp parallel for schedule(static)
+    for (int line = 0; line < nLines; line++) {
+      LongConvolution::Convolve(filter,
+        in+static_cast<std::ptrdiff_t>(line)*stride,
+        out+static_cast<std::ptrdiff_t>(line)*stride, lineSize);
+    }
+  }
 
-    //The naive implementation for small sizes
+  static void NaiveConvolve(const typename FILT::CoefficientType* buf,
+    const typename FILT::ScalarType* in, typename FILT::ScalarType* out,
+    const int firstIndexIncluded, const int lastIndexExcluded,
+    const int lineSize) {
+
+    //The naive implementation, accumulates into out, kept as a reference
     for (int i = firstIndexIncluded; i<lastIndexExcluded;i++) {
+      typename FILT::AccumulatorType sum = 0;
       for (int k = i-FILT::TapSizeLeft; k <= i+FILT::TapSizeRight; k++) {
-        out[i] += FILT::Buf[k-i+FILT::TapSizeLeft]*
-          in[positive_modulo(k,lineSize)];
+        const int src = BOUNDARY_POLICY::Index(k,lineSize);
+        if (src >= 0) {
+          sum += buf[k-i+FILT::TapSizeLeft]*in[src];
+        }
       }
+      out[i] += FILT::Narrow(sum);
+    }
+  }
+
+  template<class COEFS, typename IN_T, typename OUT_T>
+  static void ConvolveLine(const COEFS& coefs, const IN_T* in, OUT_T* out,
+      const int lineSize) {
+    if (lineSize <= 0) {
+      return;
     }
+    //Hardware counters, only with -DUSE_PERF_COUNTERS
+    PERF_SCOPE("Convolution::Convolve");
+    ConvolveRows<1>( coefs, in, out, lineSize, 0 );
+    VectorizedMemOp<OUT_T,VecT,STORE_POLICY>::fence();
   }
-  
-  static void Convolve(const typename FILT::ScalarType* in,
-    typename FILT::ScalarType* out, const int lineSize) {
+
+  template<int NB_INTERLEAVED, class COEFS, typename IN_T, typename OUT_T>
+  static void ConvolveLines(const COEFS& coefs, const IN_T* in, OUT_T* out,
+      const int lineSize, const int nLines, const int stride) {
+    static_assert(NB_INTERLEAVED >= 1, "At least one line at a time");
+    if (lineSize <= 0 || nLines <= 0) {
+      return;
+    }
+    const int nbGroup = (nLines+NB_INTERLEAVED-1)/NB_INTERLEAVED;
+    #pragma omp parallel
+    {
+      //Counters are per thread, each thread reports its own share
+      PERF_SCOPE("Convolution::ConvolveBatch");
+      #pragma omp for schedule(static) nowait
+      for (int group = 0; group < nbGroup; group++) {
+        const int first = group*NB_INTERLEAVED;
+        if (first+NB_INTERLEAVED <= nLines) {
+          ConvolveRows<NB_INTERLEAVED>( coefs,
+            in+static_cast<std::ptrdiff_t>(first)*stride,
+            out+static_cast<std::ptrdiff_t>(first)*stride, lineSize, stride );
+        } else {
+          for (int line = first; line < nLines; line++) {
+            ConvolveRows<1>( coefs,
+              in+static_cast<std::ptrdiff_t>(line)*stride,
+              out+static_cast<std::ptrdiff_t>(line)*stride, lineSize, 0 );
+          }
+        }
+      }
+      //Non temporal stores are only ordered for the thread that issued them
+      VectorizedMemOp<OUT_T,VecT,STORE_POLICY>::fence();
+    }
+  }
+
+  /*
+   * NB_ROWS lines, stride elements apart, the interior vectors of all of
+   * them being processed by the same loop
+   */
+  template<int NB_ROWS, class COEFS, typename IN_T, typename OUT_T>
+  static void ConvolveRows(const COEFS& coefs, const IN_T* in, OUT_T* out,
+      const int lineSize, const std::ptrdiff_t stride) {
     //How many vectors can be easily right processed without trouble loading
     //bounds
     const int RightProcessableVectPerLine =
@@ -141,57 +767,213 @@ public:
       ((lineSize/FILT::VecSize)*FILT::VecSize
       //right processable area (outside we cannot load the right tap)
       -FILT::TapSizeRight)/FILT::VecSize;
-    //Vector aligned scalar index to end with (excluded)		
+    //Vector aligned scalar index to end with (excluded)
     const int LastIndexToProcess = RightProcessableVectPerLine*FILT::VecSize;
 
     if (FirstIndexToProcess >= LastIndexToProcess) {
-      NaiveConvolve( in, out, 0, lineSize, lineSize );
-    } else { //The vectorized implementation
-      //////// handle prefix bound : non vectorized implementation
-      NaiveConvolve( in, out, 0, FirstIndexToProcess, lineSize );
-      
-      //////// handle vectorizable part
-
-      //Buffer containg the prefetch area to be loaded in vectorized registers
-      typename FILT::ScalarType prefetch[PrefetchCardinality*FILT::VecSize];
-
-      //1st : fill the PrefetchCardinality-1 vectors with data
-      std::copy(in,in+(PrefetchCardinality-1)*FILT::VecSize,prefetch);
-
-      //Now we must perform regular loop, iterating over vectors
-      #pragma unroll
-      for (int i = FirstIndexToProcess; i<LastIndexToProcess;
-        i+= FILT::VecSize ) {
-        //Load next prefetch buffer, in the last vector
-        VectorizedMemOp<typename FILT::ScalarType,
-	  PackType<typename FILT::ScalarType> >::store(
-	    prefetch+(PrefetchCardinality-1)*FILT::VecSize,
-	    VectorizedMemOp<typename FILT::ScalarType,
-	  PackType<typename FILT::ScalarType> >::load(
-	    in+i+ShiftBetweenProcessedAndLastLoaded));
-
-        //std::cout<<"Storing at address "<<i<<std::endl;
-        //Store the result of the convolution
-	VectorizedMemOp<typename FILT::ScalarType,
-	  PackType<typename FILT::ScalarType> >::store(
-	    out+i,
-	    ConvolutionAccumulator<typename FILT::ScalarType,
-	    FILT,PrefetchBeginIdx,FILT::TapSize-1>::Accumulate(prefetch));
-
-	//last : left shift buffer to be updated
-	//destination iterator is BEFORE source iterator, we can use std::copy
-	std::copy( prefetch+FILT::VecSize,
-          prefetch+PrefetchCardinality*FILT::VecSize, prefetch);
+      //The whole line fits in a single border buffer
+      for (int r = 0; r < NB_ROWS; r++) {
+        ConvolveBorder( coefs, in+r*stride, out+r*stride, 0, lineSize,
+          lineSize );
       }
+    } else {
+      //////// handle prefix bound : border buffer
+      for (int r = 0; r < NB_ROWS; r++) {
+        ConvolveBorder( coefs, in+r*stride, out+r*stride, 0,
+          FirstIndexToProcess, lineSize );
+      }
+
+      //////// handle vectorizable part, directly from the input lines
+      VectorConvolve<LOAD_POLICY,NB_ROWS>( coefs, in,
+        out+FirstIndexToProcess,
+        (LastIndexToProcess-FirstIndexToProcess)/FILT::VecSize, 0, stride );
 
-      //////// handle suffix bound : non vectorized implementation
-      NaiveConvolve(in, out, LastIndexToProcess, lineSize, lineSize);
+      //////// handle suffix bound : border buffer
+      for (int r = 0; r < NB_ROWS; r++) {
+        ConvolveBorder( coefs, in+r*stride, out+r*stride, LastIndexToProcess,
+          lineSize, lineSize );
+      }
+    }
+  }
+
+  /*
+   * Compute nbVec full output vectors, plus a last partial one of tailSize
+   * elements, that is written using a masked store, for each of the NB_ROWS
+   * lines, that are stride elements apart.
+   * window points to the beginning of the prefetch area of the first output
+   * vector of the first line, it is read using WINDOW_POLICY
+   */
+  template<class WINDOW_POLICY, int NB_ROWS=1, class COEFS, typename IN_T,
+    typename OUT_T>
+  static void VectorConvolve(const COEFS& coefficients, const IN_T* window,
+      OUT_T* out, const int nbVec, const int tailSize,
+      const std::ptrdiff_t stride=0) {
+    //Private copy, that does not alias the output, and stays in registers
+    const COEFS coefs = coefficients;
+    //Prefetch areas of all lines, kept in vectorized registers
+    VecT prefetch[NB_ROWS*PrefetchCardinality];
+
+    //1st : fill the PrefetchCardinality-1 vectors with data
+    RowGroup<WINDOW_POLICY,0,0,NB_ROWS>::Fill( prefetch, window, stride );
+    const IN_T* next = window+(PrefetchCardinality-1)*FILT::VecSize;
+
+    //Main loop, unrolled over PrefetchCardinality vectors, such that the
+    //window is back to its initial rotation at the end of each group
+    const int nbGroupedVec = nbVec-nbVec%PrefetchCardinality;
+    for (int i = 0; i<nbGroupedVec; i += PrefetchCardinality) {
+      RotatingGroup<WINDOW_POLICY,0,PrefetchCardinality>::template
+        Process<NB_ROWS>( coefs, prefetch, next+i*FILT::VecSize,
+        out+i*FILT::VecSize, stride );
+    }
+    //Remaining vectors, the window is then shifted by register moves
+    for (int i = nbGroupedVec; i<nbVec; i++) {
+      RowGroup<WINDOW_POLICY,0,0,NB_ROWS>::ProcessAndShift( coefs, prefetch,
+        next+i*FILT::VecSize, out+i*FILT::VecSize, stride );
+    }
+    if (tailSize > 0) {
+      RowGroup<WINDOW_POLICY,0,0,NB_ROWS>::ProcessTail( coefs, prefetch,
+        next+nbVec*FILT::VecSize, out+nbVec*FILT::VecSize, stride,
+        tailSize );
+    }
+  }
+
+  /*
+   * Load the next vector of input in the last vector of the prefetch window,
+   * seen with the given ROTATION, then compute one vector of output
+   */
+  template<class WINDOW_POLICY, int ROTATION, class COEFS, typename IN_T>
+  static VecT ProcessNextVector(const COEFS& coefs, VecT* prefetch,
+      const IN_T* next) {
+    PrefetchWindow<VecT,PrefetchCardinality,ROTATION> window(prefetch);
+    window.Last() = VectorizedMemOp<IN_T,VecT,WINDOW_POLICY>::load( next );
+    return ConvolutionKernel<FILT,PrefetchBeginIdx>::Compute(window, coefs);
+  }
+
+  /*
+   * One output vector of each of the lines ROW to NB_ROWS-1, that are stride
+   * elements apart, with windows seen with the given ROTATION. prefetch
+   * holds the windows of all lines, one after the other. Lines are unrolled
+   * at compile time, such that windows are only indexed by constants, and
+   * are kept in registers
+   */
+  template<class WINDOW_POLICY, int ROTATION, int ROW, int NB_ROWS>
+  struct RowGroup {
+    template<typename IN_T>
+    static void Fill(VecT* prefetch, const IN_T* window,
+        const std::ptrdiff_t stride) {
+      for (int j = 0; j < PrefetchCardinality-1; j++) {
+        prefetch[ROW*PrefetchCardinality+j] =
+          VectorizedMemOp<IN_T,VecT,WINDOW_POLICY>::load(
+          window+ROW*stride+j*FILT::VecSize );
+      }
+      RowGroup<WINDOW_POLICY,ROTATION,ROW+1,NB_ROWS>::Fill( prefetch,
+        window, stride );
+    }
+
+    template<class COEFS, typename IN_T, typename OUT_T>
+    static void Process(const COEFS& coefs, VecT* prefetch, const IN_T* next,
+        OUT_T* out, const std::ptrdiff_t stride) {
+      VectorizedMemOp<OUT_T,VecT,STORE_POLICY>::store( out+ROW*stride,
+        ProcessNextVector<WINDOW_POLICY,ROTATION>( coefs,
+        prefetch+ROW*PrefetchCardinality, next+ROW*stride ) );
+      RowGroup<WINDOW_POLICY,ROTATION,ROW+1,NB_ROWS>::Process( coefs,
+        prefetch, next, out, stride );
+    }
+
+    //Process, then shift the window by one vector
+    template<class COEFS, typename IN_T, typename OUT_T>
+    static void ProcessAndShift(const COEFS& coefs, VecT* prefetch,
+        const IN_T* next, OUT_T* out, const std::ptrdiff_t stride) {
+      VecT* window = prefetch+ROW*PrefetchCardinality;
+      VectorizedMemOp<OUT_T,VecT,STORE_POLICY>::store( out+ROW*stride,
+        ProcessNextVector<WINDOW_POLICY,ROTATION>( coefs, window,
+        next+ROW*stride ) );
+      std::copy( window+1, window+PrefetchCardinality, window );
+      RowGroup<WINDOW_POLICY,ROTATION,ROW+1,NB_ROWS>::ProcessAndShift( coefs,
+        prefetch, next, out, stride );
+    }
+
+    //Last partial vector, written with a masked store
+    template<class COEFS, typename IN_T, typename OUT_T>
+    static void ProcessTail(const COEFS& coefs, VecT* prefetch,
+        const IN_T* next, OUT_T* out, const std::ptrdiff_t stride,
+        const int tailSize) {
+      VectorizedMemOp<OUT_T,VecT,STORE_POLICY>::maskstore( out+ROW*stride,
+        ProcessNextVector<WINDOW_POLICY,ROTATION>( coefs,
+        prefetch+ROW*PrefetchCardinality, next+ROW*stride ), tailSize );
+      RowGroup<WINDOW_POLICY,ROTATION,ROW+1,NB_ROWS>::ProcessTail( coefs,
+        prefetch, next, out, stride, tailSize );
+    }
+  };
+
+  template<class WINDOW_POLICY, int ROTATION, int NB_ROWS>
+  struct RowGroup<WINDOW_POLICY,ROTATION,NB_ROWS,NB_ROWS> {
+    template<typename IN_T>
+    static void Fill(VecT* prefetch, const IN_T* window,
+      const std::ptrdiff_t stride) {}
+    template<class COEFS, typename IN_T, typename OUT_T>
+    static void Process(const COEFS& coefs, VecT* prefetch, const IN_T* next,
+      OUT_T* out, const std::ptrdiff_t stride) {}
+    template<class COEFS, typename IN_T, typename OUT_T>
+    static void ProcessAndShift(const COEFS& coefs, VecT* prefetch,
+      const IN_T* next, OUT_T* out, const std::ptrdiff_t stride) {}
+    template<class COEFS, typename IN_T, typename OUT_T>
+    static void ProcessTail(const COEFS& coefs, VecT* prefetch,
+      const IN_T* next, OUT_T* out, const std::ptrdiff_t stride,
+      const int tailSize) {}
+  };
+
+  /*
+   * Compute END-ROTATION output vectors of each of the NB_ROWS lines, each
+   * with a window rotated by one more vector than the previous one
+   */
+  template<class WINDOW_POLICY, int ROTATION, int END>
+  struct RotatingGroup {
+    template<int NB_ROWS, class COEFS, typename IN_T, typename OUT_T>
+    static void Process(const COEFS& coefs, VecT* prefetch, const IN_T* next,
+        OUT_T* out, const std::ptrdiff_t stride) {
+      RowGroup<WINDOW_POLICY,ROTATION,0,NB_ROWS>::Process( coefs, prefetch,
+        next, out, stride );
+      RotatingGroup<WINDOW_POLICY,ROTATION+1,END>::template Process<NB_ROWS>(
+        coefs, prefetch, next+FILT::VecSize, out+FILT::VecSize, stride );
+    }
+  };
+
+  template<class WINDOW_POLICY, int END>
+  struct RotatingGroup<WINDOW_POLICY,END,END> {
+    template<int NB_ROWS, class COEFS, typename IN_T, typename OUT_T>
+    static void Process(const COEFS& coefs, VecT* prefetch, const IN_T* next,
+      OUT_T* out, const std::ptrdiff_t stride) {}
+  };
+
+  /*
+   * Compute outputs [first,last) where first is a multiple of the vector
+   * size, from a small buffer that holds the extension of the input around
+   * this area, as given by BOUNDARY_POLICY. This buffer is filled with a few
+   * contiguous copies or fills, such that no modulo nor test is needed per
+   * tap, and the same vectorized code is used as for the center of the line,
+   * with a masked store for the last partial vector. Input elements are
+   * converted to T during the copy
+   */
+  template<class COEFS, typename IN_T, typename OUT_T>
+  static void ConvolveBorder(const COEFS& coefs, const IN_T* in, OUT_T* out,
+      const int first, const int last, const int lineSize) {
+    alignas(sizeof(VecT)) T border[MaxBorderSize+
+      (PrefetchCardinality-1)*FILT::VecSize];
+    const int nbVec = (last-first)/FILT::VecSize;
+    const int tailSize = (last-first)%FILT::VecSize;
+    const int borderSize = (nbVec+(tailSize > 0 ? 1 : 0)+PrefetchCardinality-1)
+      *FILT::VecSize;
+
+    //Extended input, beginning with the left tap of first output
+    BOUNDARY_POLICY::Extend(in, lineSize, first-FirstIndexToProcess, border,
+      borderSize);
+    VectorConvolve<AlignedMemory>( coefs, border, out+first, nbVec,
+      tailSize );
   }
-}
 
-protected:
   //To output 1 processed vector, how many vector should we load
-  static const int PrefetchCardinality =
+  constexpr static int PrefetchCardinality =
     // left tap size part
     ((FILT::TapSizeLeft+FILT::VecSize-1)/FILT::VecSize+
     // central area to be processed
@@ -218,4 +1000,19 @@ protected:
   static const int ShiftBetweenProcessedAndLastLoaded =
     ((( 2*FILT::VecSize + FILT::TapSizeRight - 1)/
     FILT::VecSize)-1)*FILT::VecSize;
+
+  /*
+   * Maximum number of outputs computed from a border buffer, this accounts
+   * for lines that are too short to be processed directly, and for the
+   * suffix, that is made of the right tap vectors plus the modulo
+   */
+  static const int MaxBorderSize = FirstIndexToProcess+
+    ShiftBetweenProcessedAndLastLoaded+FILT::VecSize;
 };
+
+VECTORIZATION_NAMESPACE_END
+
+//Long filters of Convolution, that needs FilterSymmetry
+#include "FftConvolution.h"
+
+#endif //CONVOLUTION_H
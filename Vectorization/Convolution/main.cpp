@@ -8,17 +8,18 @@
 #include <iostream>
 #include <vector>
 #include <numeric>
-#include <chrono>
 
 //local
-#define USE_SSE
 #include "../vectorization.h"
+#include "../ConcatAndCut.h"
+#include "../MemoryHelper.h"
+#include "../../Profiling/Benchmark.h"
+#include "../../Profiling/PerfCounters.h"
 
 #define SIZEX 256
 #define SIZEY 256
 #define KERX 1
 #define KERY 1
-#define NRUN 10
 
 /*
  * This code is a simple example of how to use vectorization to perform
@@ -39,9 +40,14 @@
 //perf record ./test
 //perf report
 
+// Built-in hardware counters (cycles, instructions, cache and branch misses)
+// of both versions are reported at exit when building with -DUSE_PERF_COUNTERS
+// they fall back to wall-clock timing if perf events are not allowed
+
 //This version handles the bounds
 bool PerformWorkSequentially( const std::vector<float>& vec, std::vector<float>& out )
 {
+	PERF_SCOPE("PerformWorkSequentially");
 	for(int j=0; j<SIZEY; j++ )
 	{
 		for(int i = 0; i<SIZEX; i++ )
@@ -70,6 +76,7 @@ bool PerformWorkSequentially( const std::vector<float>& vec, std::vector<float>&
 //This version does not handle the bounds
 bool PerformWorkVectorized( std::vector<float>& vec, std::vector<float>& out )
 {
+	PERF_SCOPE("PerformWorkVectorized");
 	//#pragma omp parallel for
 	for(int j=1; j<SIZEY-2; j++ )
 	{
@@ -125,38 +132,28 @@ bool PerformWorkVectorized( std::vector<float>& vec, std::vector<float>& out )
 	return true;
 }
 
-//g++ ./main.cpp -o test
-int main()
+//g++ ./main.cpp -std=c++14 -O3 -msse4.1 -DUSE_AVX -o test
+//./test --cpu 0 --json convolution.json
+int main( int argc, char* argv[] )
 {
+	BenchmarkRunner runner( argc, argv );
 	std::vector<float> vec(SIZEX*SIZEY,1.);
 	std::vector<float> out(SIZEX*SIZEY,0.);
 
-	auto start = std::chrono::steady_clock::now();
-	auto stop = std::chrono::steady_clock::now();
-	auto diff = stop - start;
-	double msec=std::numeric_limits<double>::max();
+	//9 additions and one division per pixel, one read and one write
+	const double bytes = 2.0*SIZEX*SIZEY*sizeof(float);
+	const double flops = 10.0*SIZEX*SIZEY;
 
-	for(int k = 0; k< NRUN; k++)
+	double refMsec = runner.Run( "sequential 3x3 mean filter", [&]()
 	{
-		start = std::chrono::steady_clock::now();
 		PerformWorkSequentially(vec, out);
-		stop = std::chrono::steady_clock::now();
-		diff = stop - start;
-		msec = std::min( msec, std::chrono::duration<double, std::milli>(diff).count());
-	}
-	std::cout << "Runtime for sequential version is "<< msec << " msec "<< std::endl;
-	msec=std::numeric_limits<double>::max();
+	}, bytes, flops ).median;
 
-	for(int k = 0; k< NRUN; k++)
+	double msec = runner.Run( "vectorized 3x3 mean filter", [&]()
 	{
-		start = std::chrono::steady_clock::now();
 		PerformWorkVectorized(vec, out);
-		stop = std::chrono::steady_clock::now();
-		diff = stop - start;
-		msec = std::min( msec, std::chrono::duration<double, std::milli>(diff).count());
-	}
-	std::cout << "Runtime for vectorized version is "<< msec << " msec "<< std::endl;
-	msec=std::numeric_limits<double>::max();
+	}, bytes, flops ).median;
+	std::cout << "Speedup for vectorized version is "<< refMsec/msec << std::endl;
 
 	//Optionally check
 	/*std::fill( out.begin(), out.end(), 0.);
@@ -170,5 +167,5 @@ int main()
 		std::cout << std::endl;
 	}*/
 
-	return EXIT_SUCCESS;
+	return runner.Finish() ? EXIT_SUCCESS : EXIT_FAILURE;
 }
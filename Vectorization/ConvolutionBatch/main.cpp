@@ -0,0 +1,143 @@
+/*
+ * main.cpp
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: gnthibault
+ */
+
+//STL
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//Local
+#include "../Convolution.h"
+#include "../../Profiling/Benchmark.h"
+
+/*
+ * Many short lines, such as the rows of a small image or a batch of
+ * signals: Convolution::ConvolveBatch is checked against one call to
+ * Convolve per line, then both are timed on lines of 64 to 4096 floats,
+ * for a total of 128K elements per batch, that fits in the L2 cache.
+ * The batch is also timed with 2 and 4 interleaved lines per thread
+ */
+template<> const float MyFilter<float,1,1>::Buf[3] = {1.f/4.f,2.f/4.f,1.f/4.f};
+template<> const float MyFilter<float,3,3>::Buf[7] = {1.f/64.f,6.f/64.f,
+  15.f/64.f,20.f/64.f,15.f/64.f,6.f/64.f,1.f/64.f};
+template<> const float MyFilter<float,7,7>::Buf[15] = {1.f/16384.f,
+  14.f/16384.f,91.f/16384.f,364.f/16384.f,1001.f/16384.f,2002.f/16384.f,
+  3003.f/16384.f,3432.f/16384.f,3003.f/16384.f,2002.f/16384.f,1001.f/16384.f,
+  364.f/16384.f,91.f/16384.f,14.f/16384.f,1.f/16384.f};
+
+#define BATCHSIZE (128*1024)
+
+//build with
+//g++ ./main.cpp -std=c++14 -O3 -mavx2 -mfma -fopenmp -o test -DUSE_AVX2
+//g++ ./main.cpp -std=c++14 -O3 -march=skylake-avx512 -fopenmp -o test -DUSE_AVX512
+//OMP_NUM_THREADS=4 ./test --json batch.json
+
+/*
+ * Results must be the same as line by line, for any number of lines, that
+ * may not be a multiple of the interleaved group, and for any stride.
+ * Inputs are small integers, such that results are exact with the dyadic
+ * coefficients above, whatever the multiply-adds the compiler fuses
+ */
+template<class FILT, class POLICY, int NB_INTERLEAVED>
+bool Check(int lineSize, int nLines, int stride, int offset) {
+  std::vector<float,PackAllocator<float>> in(offset+nLines*stride);
+  std::vector<float,PackAllocator<float>> out(in.size(), 0.f);
+  std::vector<float,PackAllocator<float>> control(in.size(), 0.f);
+  std::generate(in.begin(), in.end(), []() {
+    return static_cast<float>(rand()%16); });
+
+  Convolution<FILT,POLICY,POLICY>::template ConvolveBatch<NB_INTERLEAVED>(
+    in.data()+offset, out.data()+offset, lineSize, nLines, stride);
+  for (int line = 0; line < nLines; line++) {
+    Convolution<FILT,POLICY,POLICY>::Convolve(in.data()+offset+line*stride,
+      control.data()+offset+line*stride, lineSize);
+  }
+  bool isOK = std::equal(control.begin(), control.end(), out.begin());
+
+  //Runtime coefficients
+  typedef RuntimeFilter<Filter<float,FILT::TapSizeLeft,FILT::TapSizeRight>>
+    Runtime;
+  std::fill(out.begin(), out.end(), 0.f);
+  Convolution<Runtime,POLICY,POLICY>::template ConvolveBatch<NB_INTERLEAVED>(
+    Runtime(FILT::Buf), in.data()+offset, out.data()+offset, lineSize, nLines,
+    stride);
+  isOK &= std::equal(control.begin(), control.end(), out.begin());
+  return isOK;
+}
+
+template<class FILT>
+void Benchmark(BenchmarkRunner& runner, int lineSize) {
+  const int nLines = BATCHSIZE/lineSize;
+  std::vector<float,PackAllocator<float>> in(BATCHSIZE);
+  std::vector<float,PackAllocator<float>> out(BATCHSIZE);
+  std::generate(in.begin(), in.end(), []() {
+    return static_cast<float>(rand())/static_cast<float>(RAND_MAX); });
+  const double bytes = 2.*sizeof(float)*BATCHSIZE;
+  const double flops = (2.*FILT::TapSize-1.)*BATCHSIZE;
+  const std::string name = std::to_string(FILT::TapSize)+" taps, "+
+    std::to_string(nLines)+" lines of "+std::to_string(lineSize);
+  const double refMsec = runner.Run(name+", line by line", [&]() {
+      for (int line = 0; line < nLines; line++) {
+        Convolution<FILT>::Convolve(in.data()+line*lineSize,
+          out.data()+line*lineSize, lineSize);
+      }
+      ClobberMemory();
+    }, bytes, flops).median;
+  const double msec = runner.Run(name+", batch", [&]() {
+      Convolution<FILT>::ConvolveBatch(in.data(), out.data(), lineSize,
+        nLines, lineSize);
+      ClobberMemory();
+    }, bytes, flops).median;
+  std::cout << "Speedup of the batch for " << name << " is "
+    << refMsec/msec << std::endl;
+  runner.Run(name+", batch, 2 interleaved", [&]() {
+      Convolution<FILT>::template ConvolveBatch<2>(in.data(), out.data(),
+        lineSize, nLines, lineSize);
+      ClobberMemory();
+    }, bytes, flops);
+  runner.Run(name+", batch, 4 interleaved", [&]() {
+      Convolution<FILT>::template ConvolveBatch<4>(in.data(), out.data(),
+        lineSize, nLines, lineSize);
+      ClobberMemory();
+    }, bytes, flops);
+}
+
+int main(int argc, char* argv[]) {
+  constexpr int VecSize = sizeof(PackType<float>)/sizeof(float);
+  bool isOK = true;
+  for (int lineSize : {1, 3, 17, 64, 100, 333}) {
+    for (int nLines : {1, 2, 3, 7, 16}) {
+      const int stride = (lineSize+VecSize-1)/VecSize*VecSize;
+      isOK &= Check<MyFilter<float,1,1>,AlignedMemory,1>(lineSize, nLines,
+        stride, 0);
+      isOK &= Check<MyFilter<float,3,3>,AlignedMemory,1>(lineSize, nLines,
+        stride+VecSize, 0);
+      isOK &= Check<MyFilter<float,7,7>,AlignedMemory,2>(lineSize, nLines,
+        stride, 0);
+      isOK &= Check<MyFilter<float,3,3>,UnalignedMemory,2>(lineSize, nLines,
+        lineSize, 1);
+      isOK &= Check<MyFilter<float,7,7>,UnalignedMemory,4>(lineSize, nLines,
+        lineSize+1, 3);
+    }
+  }
+  if (isOK) {
+    std::cout << "All batch tests returned True Value" << std::endl;
+  } else {
+    std::cout << " WARNING : There may be a bug in batch convolution"
+      << std::endl;
+  }
+
+  BenchmarkRunner runner(argc, argv);
+  for (int lineSize : {64, 256, 1024, 4096}) {
+    Benchmark<MyFilter<float,1,1>>(runner, lineSize);
+    Benchmark<MyFilter<float,3,3>>(runner, lineSize);
+    Benchmark<MyFilter<float,7,7>>(runner, lineSize);
+  }
+  return runner.Finish() && isOK ? EXIT_SUCCESS : EXIT_FAILURE;
+}
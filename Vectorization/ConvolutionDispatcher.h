@@ -0,0 +1,112 @@
+#ifndef CONVOLUTIONDISPATCHER_H
+#define CONVOLUTIONDISPATCHER_H
+
+//STL
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+//Local
+#include "Convolution.h"
+
+VECTORIZATION_NAMESPACE_BEGIN
+
+/*
+ * Convolution with a support only known at runtime, tapSizeLeft taps at left
+ * and tapSizeRight at right, up to MaxTapSize taps in all. One RuntimeFilter
+ * kernel is instantiated for each (left,right) pair that fits, such that
+ * causal and asymmetric filters only compute their own taps. The constructor
+ * keeps a pointer to the kernel of the requested support, such that Convolve
+ * costs one indirect call on top of the compile time version.
+ * Coefficients are given from the leftmost tap to the rightmost one, as for
+ * MyFilter::Buf
+ */
+template<typename T, typename IN_T=T, typename OUT_T=IN_T,
+  class LOAD_POLICY=AlignedMemory, class STORE_POLICY=AlignedMemory,
+  class BOUNDARY_POLICY=PeriodicBoundary>
+class ConvolutionDispatcher {
+public:
+  static_assert(std::is_floating_point<T>::value,
+    "ConvolutionDispatcher needs floating point coefficients");
+  constexpr static int MaxTapSize = 31;
+
+  ConvolutionDispatcher(const T* coefficients, int tapSizeLeft,
+      int tapSizeRight) : m_tapSizeLeft(tapSizeLeft) {
+    if (tapSizeLeft < 0 || tapSizeRight < 0) {
+      throw std::invalid_argument("ConvolutionDispatcher: negative tap size");
+    }
+    if (tapSizeLeft > MaxTapSize-1-tapSizeRight) {
+      throw std::invalid_argument("ConvolutionDispatcher: "+
+        std::to_string(tapSizeLeft)+"+"+std::to_string(tapSizeRight)+
+        "+1 taps filter does not fit in the "+std::to_string(MaxTapSize)+
+        " taps kernels");
+    }
+    m_buf.assign(coefficients, coefficients+tapSizeLeft+tapSizeRight+1);
+    m_convolve = SelectLeft<0>(tapSizeLeft, tapSizeRight);
+  }
+
+  void Convolve(const IN_T* in, OUT_T* out, const int lineSize) const {
+    m_convolve(m_buf.data(), in, out, lineSize);
+  }
+
+  int TapSize() const {
+    return static_cast<int>(m_buf.size());
+  }
+  int TapSizeLeft() const {
+    return m_tapSizeLeft;
+  }
+  int TapSizeRight() const {
+    return TapSize()-1-m_tapSizeLeft;
+  }
+  const std::vector<T>& Coefficients() const {
+    return m_buf;
+  }
+
+protected:
+  typedef void (*ConvolveFunc)(const T*, const IN_T*, OUT_T*, int);
+
+  template<int LEFT, int RIGHT>
+  static void ConvolveTaps(const T* buf, const IN_T* in, OUT_T* out,
+      const int lineSize) {
+    typedef RuntimeFilter<Filter<T,LEFT,RIGHT>> FILT;
+    Convolution<FILT,LOAD_POLICY,STORE_POLICY,BOUNDARY_POLICY>::Convolve(
+      FILT(buf), in, out, lineSize);
+  }
+
+  //Linear search over the left size, then over the right one
+  template<int LEFT>
+  static typename std::enable_if<(LEFT < MaxTapSize), ConvolveFunc>::type
+  SelectLeft(int tapSizeLeft, int tapSizeRight) {
+    return tapSizeLeft == LEFT ? SelectRight<LEFT,0>(tapSizeRight) :
+      SelectLeft<LEFT+1>(tapSizeLeft, tapSizeRight);
+  }
+
+  template<int LEFT>
+  static typename std::enable_if<(LEFT >= MaxTapSize), ConvolveFunc>::type
+  SelectLeft(int, int) {
+    return nullptr;
+  }
+
+  template<int LEFT, int RIGHT>
+  static typename std::enable_if<(LEFT+RIGHT < MaxTapSize), ConvolveFunc>::type
+  SelectRight(int tapSizeRight) {
+    return tapSizeRight == RIGHT ? &ConvolveTaps<LEFT,RIGHT> :
+      SelectRight<LEFT,RIGHT+1>(tapSizeRight);
+  }
+
+  template<int LEFT, int RIGHT>
+  static typename std::enable_if<(LEFT+RIGHT >= MaxTapSize),
+    ConvolveFunc>::type
+  SelectRight(int) {
+    return nullptr;
+  }
+
+  int m_tapSizeLeft;
+  std::vector<T> m_buf;
+  ConvolveFunc m_convolve;
+};
+
+VECTORIZATION_NAMESPACE_END
+#endif //CONVOLUTIONDISPATCHER_H
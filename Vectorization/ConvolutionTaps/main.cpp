@@ -0,0 +1,148 @@
+/*
+ * main.cpp
+ *
+ *  Created on: 16 oct. 2026
+ *      Author: gnthibault
+ */
+
+//STL
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//Local
+#include "../Convolution.h"
+#include "../ConvolutionDispatcher.h"
+#include "../../Profiling/Benchmark.h"
+
+/*
+ * Throughput of Convolution::Convolve for all tap sizes from 3 to 15, on a
+ * line that fits in the L1 cache, where the kernel is bound by the
+ * instructions it issues rather than by the memory, and on a line that fits
+ * in the L2 cache.
+ * Filters of size N have N/2 taps at left and the remaining ones at right.
+ * Each compile time filter is compared with the same coefficients given at
+ * runtime to ConvolutionDispatcher, that should run at the same speed.
+ * Then, odd symmetric filters from 3 to 31 taps are timed with and without
+ * folding of the mirrored taps, that halves the number of multiplies.
+ * Last, 7 taps filters are timed with each boundary policy, on the lines
+ * above and on short lines, where most outputs come from the border buffers
+ */
+template<> const float MyFilter<float,1,1>::Buf[3] = {1.f/6.f,2.f/6.f,3.f/6.f};
+template<> const float MyFilter<float,2,1>::Buf[4] = {1.f/10.f,2.f/10.f,3.f/10.f,4.f/10.f};
+template<> const float MyFilter<float,2,2>::Buf[5] = {1.f/15.f,2.f/15.f,3.f/15.f,4.f/15.f,5.f/15.f};
+template<> const float MyFilter<float,3,2>::Buf[6] = {1.f/21.f,2.f/21.f,3.f/21.f,4.f/21.f,5.f/21.f,6.f/21.f};
+template<> const float MyFilter<float,3,3>::Buf[7] = {1.f/28.f,2.f/28.f,3.f/28.f,4.f/28.f,5.f/28.f,6.f/28.f,7.f/28.f};
+template<> const float MyFilter<float,4,3>::Buf[8] = {1.f/36.f,2.f/36.f,3.f/36.f,4.f/36.f,5.f/36.f,6.f/36.f,7.f/36.f,8.f/36.f};
+template<> const float MyFilter<float,4,4>::Buf[9] = {1.f/45.f,2.f/45.f,3.f/45.f,4.f/45.f,5.f/45.f,6.f/45.f,7.f/45.f,8.f/45.f,9.f/45.f};
+template<> const float MyFilter<float,5,4>::Buf[10] = {1.f/55.f,2.f/55.f,3.f/55.f,4.f/55.f,5.f/55.f,6.f/55.f,7.f/55.f,8.f/55.f,9.f/55.f,10.f/55.f};
+template<> const float MyFilter<float,5,5>::Buf[11] = {1.f/66.f,2.f/66.f,3.f/66.f,4.f/66.f,5.f/66.f,6.f/66.f,7.f/66.f,8.f/66.f,9.f/66.f,10.f/66.f,11.f/66.f};
+template<> const float MyFilter<float,6,5>::Buf[12] = {1.f/78.f,2.f/78.f,3.f/78.f,4.f/78.f,5.f/78.f,6.f/78.f,7.f/78.f,8.f/78.f,9.f/78.f,10.f/78.f,11.f/78.f,12.f/78.f};
+template<> const float MyFilter<float,6,6>::Buf[13] = {1.f/91.f,2.f/91.f,3.f/91.f,4.f/91.f,5.f/91.f,6.f/91.f,7.f/91.f,8.f/91.f,9.f/91.f,10.f/91.f,11.f/91.f,12.f/91.f,13.f/91.f};
+template<> const float MyFilter<float,7,6>::Buf[14] = {1.f/105.f,2.f/105.f,3.f/105.f,4.f/105.f,5.f/105.f,6.f/105.f,7.f/105.f,8.f/105.f,9.f/105.f,10.f/105.f,11.f/105.f,12.f/105.f,13.f/105.f,14.f/105.f};
+template<> const float MyFilter<float,7,7>::Buf[15] = {1.f/120.f,2.f/120.f,3.f/120.f,4.f/120.f,5.f/120.f,6.f/120.f,7.f/120.f,8.f/120.f,9.f/120.f,10.f/120.f,11.f/120.f,12.f/120.f,13.f/120.f,14.f/120.f,15.f/120.f};
+
+#define L1SIZE 4096
+#define L2SIZE 65536
+
+//build with
+//g++ ./main.cpp -std=c++14 -O3 -mavx2 -mfma -o test -DUSE_AVX2
+//g++ ./main.cpp -std=c++14 -O3 -march=skylake-avx512 -o test -DUSE_AVX512
+//./test --json taps.json
+
+template<int TAP_SIZE>
+void BenchmarkTaps(BenchmarkRunner& runner, std::vector<float,
+    PackAllocator<float>>& in, std::vector<float,PackAllocator<float>>& out) {
+  typedef MyFilter<float,TAP_SIZE/2,TAP_SIZE-1-TAP_SIZE/2> FILT;
+  const int size = static_cast<int>(in.size());
+  //One multiply per tap, one add per tap but the first, per output
+  const std::string name = std::to_string(TAP_SIZE)+" taps, "+
+    std::to_string(size)+" floats";
+  runner.Run(name, [&]() {
+      Convolution<FILT>::Convolve(in.data(), out.data(), size);
+      ClobberMemory();
+    }, 2.*sizeof(float)*size, (2.*TAP_SIZE-1.)*size);
+  const ConvolutionDispatcher<float> dispatcher(FILT::Buf, FILT::TapSizeLeft,
+    FILT::TapSizeRight);
+  runner.Run(name+", dispatched", [&]() {
+      dispatcher.Convolve(in.data(), out.data(), size);
+      ClobberMemory();
+    }, 2.*sizeof(float)*size, (2.*TAP_SIZE-1.)*size);
+  BenchmarkTaps<TAP_SIZE+1>(runner, in, out);
+}
+
+template<>
+void BenchmarkTaps<16>(BenchmarkRunner& runner, std::vector<float,
+  PackAllocator<float>>& in, std::vector<float,PackAllocator<float>>& out) {}
+
+template<int HALF_SIZE>
+void BenchmarkSymmetric(BenchmarkRunner& runner, std::vector<float,
+    PackAllocator<float>>& in, std::vector<float,PackAllocator<float>>& out) {
+  constexpr int TapSize = 2*HALF_SIZE+1;
+  typedef RuntimeFilter<Filter<float,HALF_SIZE,HALF_SIZE>> Plain;
+  typedef RuntimeFilter<Filter<float,HALF_SIZE,HALF_SIZE,
+    FilterSymmetry::Symmetric>> Folded;
+  std::vector<float> coefficients(TapSize);
+  for (int k = 0; k < TapSize; k++) {
+    coefficients[k] = static_cast<float>(std::min(k, TapSize-1-k)+1);
+  }
+  const int size = static_cast<int>(in.size());
+  //Work of the plain version, such that GFLOP/s compare as speedups
+  const double flops = (2.*TapSize-1.)*size;
+  const std::string name = std::to_string(TapSize)+" taps symmetric, "+
+    std::to_string(size)+" floats";
+  const Plain plain(coefficients.data());
+  const double refMsec = runner.Run(name, [&]() {
+      Convolution<Plain>::Convolve(plain, in.data(), out.data(), size);
+      ClobberMemory();
+    }, 2.*sizeof(float)*size, flops).median;
+  const Folded folded(coefficients.data());
+  const double msec = runner.Run(name+", folded", [&]() {
+      Convolution<Folded>::Convolve(folded, in.data(), out.data(), size);
+      ClobberMemory();
+    }, 2.*sizeof(float)*size, flops).median;
+  std::cout << "Speedup of folding for " << TapSize << " taps is "
+    << refMsec/msec << std::endl;
+  BenchmarkSymmetric<HALF_SIZE+1>(runner, in, out);
+}
+
+template<>
+void BenchmarkSymmetric<16>(BenchmarkRunner& runner, std::vector<float,
+  PackAllocator<float>>& in, std::vector<float,PackAllocator<float>>& out) {}
+
+template<class BOUNDARY>
+void BenchmarkBoundary(BenchmarkRunner& runner, const std::string& boundary,
+    std::vector<float,PackAllocator<float>>& in,
+    std::vector<float,PackAllocator<float>>& out) {
+  typedef MyFilter<float,3,3> FILT;
+  const int size = static_cast<int>(in.size());
+  runner.Run("7 taps, "+std::to_string(size)+" floats, "+boundary, [&]() {
+      Convolution<FILT,AlignedMemory,AlignedMemory,BOUNDARY>::Convolve(
+        in.data(), out.data(), size);
+      ClobberMemory();
+    }, 2.*sizeof(float)*size, 13.*size);
+}
+
+int main(int argc, char* argv[]) {
+  BenchmarkRunner runner(argc, argv);
+  for (int size : {64, 256, L1SIZE}) {
+    std::vector<float,PackAllocator<float>> in(size, 1.f);
+    std::vector<float,PackAllocator<float>> out(size);
+    BenchmarkBoundary<PeriodicBoundary>(runner, "periodic", in, out);
+    BenchmarkBoundary<MirrorBoundary>(runner, "mirror", in, out);
+    BenchmarkBoundary<ClampBoundary>(runner, "clamp", in, out);
+    BenchmarkBoundary<ZeroBoundary>(runner, "zero", in, out);
+  }
+  for (int size : {L1SIZE, L2SIZE}) {
+    std::vector<float,PackAllocator<float>> in(size);
+    std::vector<float,PackAllocator<float>> out(size);
+    for (int i = 0; i < size; i++) {
+      in[i] = static_cast<float>(rand())/static_cast<float>(RAND_MAX);
+    }
+    BenchmarkTaps<3>(runner, in, out);
+    BenchmarkSymmetric<1>(runner, in, out);
+  }
+  return runner.Finish() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
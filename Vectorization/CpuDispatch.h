@@ -0,0 +1,132 @@
+#ifndef CPUDISPATCH_H
+#define CPUDISPATCH_H
+
+//STL
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <utility>
+
+/*
+ * Instruction set levels for which a flavour of the vectorized headers can
+ * be compiled, ordered from the least to the most capable one.
+ * Names match the inline namespaces defined in vectorization.h
+ */
+enum class Isa : int {
+  Scalar = 0,
+  Sse = 1,    // -DUSE_AVX -msse4.1 : 128 bits, legacy encoding
+  Avx = 2,    // -DUSE_AVX -mavx : 128 bits, vex encoding
+  Avx2 = 3,   // -DUSE_AVX2 -mavx2 -mfma : 256 bits
+  Avx512 = 4, // -DUSE_AVX512 -mavx512f ... : 512 bits
+  Neon = 5    // -DUSE_NEON : 128 bits on arm
+};
+
+/*
+ * Runtime detection of the instruction sets supported by the host.
+ * On x86 we rely on the gcc/clang cpuid builtins, that also check that the
+ * operating system actually saves the extended registers on context switch.
+ * The VECTORIZATION_MAX_ISA environment variable (scalar, sse, avx, avx2,
+ * avx512) caps the detected level, which is usefull to test all variants on
+ * a single capable host.
+ */
+class CpuFeatures {
+ public:
+  static bool Supports(Isa isa) {
+    if (static_cast<int>(isa) > static_cast<int>(MaxAllowed())) {
+      return false;
+    }
+    return HardwareSupports(isa);
+  }
+
+  //Most capable instruction set available on this host
+  static Isa Best() {
+    for (Isa isa : {Isa::Avx512, Isa::Avx2, Isa::Avx, Isa::Sse, Isa::Neon}) {
+      if (Supports(isa)) {
+        return isa;
+      }
+    }
+    return Isa::Scalar;
+  }
+
+  static const char* Name(Isa isa) {
+    switch (isa) {
+      case Isa::Sse: return "sse";
+      case Isa::Avx: return "avx";
+      case Isa::Avx2: return "avx2";
+      case Isa::Avx512: return "avx512";
+      case Isa::Neon: return "neon";
+      default: return "scalar";
+    }
+  }
+
+ protected:
+  static bool HardwareSupports(Isa isa) {
+#if defined(__x86_64__) || defined(__i386__)
+    //May be called from static initializers, before libgcc did it
+    __builtin_cpu_init();
+    switch (isa) {
+      case Isa::Scalar: return true;
+      case Isa::Sse: return __builtin_cpu_supports("sse4.1");
+      case Isa::Avx: return __builtin_cpu_supports("avx");
+      case Isa::Avx2: return __builtin_cpu_supports("avx2") &&
+        __builtin_cpu_supports("fma");
+      case Isa::Avx512: return __builtin_cpu_supports("avx512f") &&
+        __builtin_cpu_supports("avx512dq") &&
+        __builtin_cpu_supports("avx512bw") &&
+        __builtin_cpu_supports("avx512vl");
+      default: return false;
+    }
+#elif defined(__aarch64__)
+    //Advanced simd is mandatory on armv8-a
+    return isa == Isa::Scalar || isa == Isa::Neon;
+#else
+    return isa == Isa::Scalar;
+#endif
+  }
+
+  static Isa MaxAllowed() {
+    const char* env = std::getenv("VECTORIZATION_MAX_ISA");
+    if (env != nullptr) {
+      for (Isa isa : {Isa::Scalar, Isa::Sse, Isa::Avx, Isa::Avx2, Isa::Avx512,
+          Isa::Neon}) {
+        if (std::strcmp(env, Name(isa)) == 0) {
+          return isa;
+        }
+      }
+    }
+    return Isa::Neon;
+  }
+};
+
+/*
+ * Pick, among the tables of function pointers compiled for each instruction
+ * set, the one for the most capable level supported by the host.
+ * Candidates that were not compiled in can be given as nullptr.
+ * This is meant to be called once, typically to initialize a global
+ * reference, such that calls on the hot path only cost an indirect call.
+ */
+template<class TableT>
+const TableT& ResolveDispatch(
+    std::initializer_list<std::pair<Isa,const TableT*>> candidates,
+    Isa* chosen = nullptr) {
+  const TableT* best = nullptr;
+  Isa bestIsa = Isa::Scalar;
+  for (const auto& candidate : candidates) {
+    if (candidate.second != nullptr && CpuFeatures::Supports(candidate.first)
+        && (best == nullptr || static_cast<int>(candidate.first) >
+        static_cast<int>(bestIsa))) {
+      best = candidate.second;
+      bestIsa = candidate.first;
+    }
+  }
+  //At least the scalar version is expected to be always available
+  if (best == nullptr) {
+    std::abort();
+  }
+  if (chosen != nullptr) {
+    *chosen = bestIsa;
+  }
+  return *best;
+}
+
+#endif //CPUDISPATCH_H
@@ -0,0 +1,148 @@
+#ifndef DECIMATINGCONVOLUTION_H
+#define DECIMATINGCONVOLUTION_H
+
+//STL
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+//Local
+#include "Convolution.h"
+#include "SubsampledConcatAndCut.h"
+
+VECTORIZATION_NAMESPACE_BEGIN
+
+/*
+ * Convolution followed by a downsampling by FACTOR, that only computes the
+ * kept outputs: out[j] is element FACTOR*j of the output of
+ * Convolution<FILT,...,BOUNDARY_POLICY>::Convolve on the same line, for j in
+ * [0,DecimatedSize(n)).
+ * Polyphase decomposition: with k = FACTOR*m+r, the input is split into
+ * FACTOR phases Q_r[i] = in[FACTOR*i+r-TapSizeLeft], and
+ * out[j] = sum over k of Buf[k]*Q_r[j+m], such that each output vector
+ * costs TapSize multiply-adds instead of FACTOR*TapSize.
+ * The line is processed by blocks of BlockSize outputs, whose phases are
+ * split into a buffer that stays in the L1 cache, with SubsampledConcatAndCut
+ * for FACTOR 2 when it exists for the vector type, and scalar copies
+ * otherwise
+ */
+template<class FILT, int FACTOR, class BOUNDARY_POLICY=PeriodicBoundary>
+class DecimatingConvolution {
+public:
+  static_assert(FACTOR >= 1, "Decimation factor must be positive");
+  static_assert(std::is_floating_point<typename FILT::ScalarType>::value,
+    "DecimatingConvolution needs floating point filters");
+  typedef typename FILT::ScalarType T;
+  typedef typename FILT::VectorType VecT;
+  constexpr static int VecSize = FILT::VecSize;
+  constexpr static int TapSize = FILT::TapSize;
+  //Number of taps that apply to each phase
+  constexpr static int PhaseTapSize = (TapSize+FACTOR-1)/FACTOR;
+  //Number of outputs per block, a multiple of VecSize
+  constexpr static int BlockSize = 64*VecSize;
+
+  //Number of outputs of a line of n elements
+  static int DecimatedSize(const int n) {
+    return (n+FACTOR-1)/FACTOR;
+  }
+
+  //out must hold DecimatedSize(n) elements, it may not be aligned
+  static void Convolve(const T* in, T* out, const int n) {
+    ConvolveLine(FILT::Buf, in, out, n);
+  }
+
+  //Filter with runtime coefficients, see RuntimeFilter
+  static void Convolve(const FILT& filter, const T* in, T* out, const int n) {
+    ConvolveLine(filter.Buf, in, out, n);
+  }
+
+protected:
+  typedef VectorizedMemOp<T,VecT,UnalignedMemory> MemOp;
+  //Elements of each phase in the buffer, and their padding to whole vectors
+  constexpr static int PhaseSize = BlockSize+PhaseTapSize-1;
+  constexpr static int PhasePitch = (PhaseSize+VecSize-1)/VecSize*VecSize;
+
+  static void ConvolveLine(const typename FILT::CoefficientType* buf,
+      const T* in, T* out, const int n) {
+    if (n <= 0) {
+      return;
+    }
+    PERF_SCOPE("DecimatingConvolution::Convolve");
+    VecT coefs[TapSize];
+    for (int k = 0; k < TapSize; k++) {
+      coefs[k] = VecT() + buf[k];
+    }
+    std::vector<T,PackAllocator<T>> phases(FACTOR*PhasePitch, T(0));
+    std::vector<T> extended;
+    const int outSize = DecimatedSize(n);
+    for (int first = 0; first < outSize; first += BlockSize) {
+      const int blockSize = std::min(BlockSize, outSize-first);
+      const int phaseSize = blockSize+PhaseTapSize-1;
+      //Input elements of the block, extended by BOUNDARY_POLICY near the
+      //ends of the line only
+      const int begin = FACTOR*first-FILT::TapSizeLeft;
+      const int size = FACTOR*phaseSize;
+      const T* src;
+      if (begin < 0 || begin+size > n) {
+        extended.resize(size);
+        BOUNDARY_POLICY::Extend(in, n, begin, extended.data(), size);
+        src = extended.data();
+      } else {
+        src = in+begin;
+      }
+      Split(src, phases.data(), phaseSize,
+        std::integral_constant<bool,
+          FACTOR == 2 && DyadicSplit<T,VecT>::Vectorized>());
+      ConvolveBlock(coefs, phases.data(), out+first, blockSize);
+    }
+  }
+
+  //Phase r of src to phases+r*PhasePitch, dyadic case
+  static void Split(const T* src, T* phases, const int phaseSize,
+      std::true_type) {
+    int i = 0;
+    for (; i+VecSize <= phaseSize; i += VecSize) {
+      VecT even, odd;
+      DyadicSplit<T,VecT>::Split(MemOp::load(src+2*i),
+        MemOp::load(src+2*i+VecSize), even, odd);
+      VectorizedMemOp<T,VecT>::store(phases+i, even);
+      VectorizedMemOp<T,VecT>::store(phases+PhasePitch+i, odd);
+    }
+    for (; i < phaseSize; i++) {
+      phases[i] = src[2*i];
+      phases[PhasePitch+i] = src[2*i+1];
+    }
+  }
+
+  static void Split(const T* src, T* phases, const int phaseSize,
+      std::false_type) {
+    for (int i = 0; i < phaseSize; i++) {
+      for (int r = 0; r < FACTOR; r++) {
+        phases[r*PhasePitch+i] = src[FACTOR*i+r];
+      }
+    }
+  }
+
+  static void ConvolveBlock(const VecT* coefs, const T* phases, T* out,
+      const int blockSize) {
+    int i = 0;
+    for (; i+VecSize <= blockSize; i += VecSize) {
+      MemOp::store(out+i, PhaseSum(coefs, phases+i));
+    }
+    if (i < blockSize) {
+      MemOp::maskstore(out+i, PhaseSum(coefs, phases+i), blockSize-i);
+    }
+  }
+
+  //Tap k is tap k/FACTOR of phase k%FACTOR
+  static VecT PhaseSum(const VecT* coefs, const T* phases) {
+    VecT acc = coefs[0]*MemOp::load(phases);
+    for (int k = 1; k < TapSize; k++) {
+      acc += coefs[k]*MemOp::load(phases+(k%FACTOR)*PhasePitch+k/FACTOR);
+    }
+    return acc;
+  }
+};
+
+VECTORIZATION_NAMESPACE_END
+#endif //DECIMATINGCONVOLUTION_H
@@ -0,0 +1,145 @@
+/*
+ * main.cpp
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: gnthibault
+ */
+
+//STL
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//Local
+#include "../DecimatingConvolution.h"
+#include "../../Profiling/Benchmark.h"
+
+/*
+ * Anti-aliasing before a downsampling: DecimatingConvolution is checked
+ * against NaiveConvolve followed by the downsampling, for factors 1 to 4,
+ * then timed against Convolve followed by the downsampling on a line of 64K
+ * floats, that fits in the L2 cache
+ */
+template<> const float MyFilter<float,1,1>::Buf[3] = {1.f/4.f,2.f/4.f,1.f/4.f};
+template<> const float MyFilter<float,3,3>::Buf[7] = {1.f/64.f,6.f/64.f,
+  15.f/64.f,20.f/64.f,15.f/64.f,6.f/64.f,1.f/64.f};
+template<> const float MyFilter<float,2,4>::Buf[7] = {-1.f/8.f,2.f/8.f,
+  3.f/8.f,5.f/8.f,-3.f/8.f,1.f/8.f,1.f/8.f};
+template<> const float MyFilter<float,7,7>::Buf[15] = {1.f/16384.f,
+  14.f/16384.f,91.f/16384.f,364.f/16384.f,1001.f/16384.f,2002.f/16384.f,
+  3003.f/16384.f,3432.f/16384.f,3003.f/16384.f,2002.f/16384.f,1001.f/16384.f,
+  364.f/16384.f,91.f/16384.f,14.f/16384.f,1.f/16384.f};
+template<> const double MyFilter<double,3,3>::Buf[7] = {1./64.,6./64.,15./64.,
+  20./64.,15./64.,6./64.,1./64.};
+
+#define LINESIZE (64*1024)
+
+//build with
+//g++ ./main.cpp -std=c++14 -O3 -mavx2 -mfma -o test -DUSE_AVX2
+//g++ ./main.cpp -std=c++14 -O3 -march=skylake-avx512 -o test -DUSE_AVX512
+//./test --json decimating.json
+
+/*
+ * Results must be the kept elements of the full convolution, with the same
+ * boundary, for any size, including several blocks and a partial last
+ * vector. Inputs are small integers, such that results are exact with the
+ * dyadic coefficients above, whatever the multiply-adds the compiler fuses
+ */
+template<class FILT, int FACTOR, class BOUNDARY>
+bool Check(int size) {
+  typedef typename FILT::ScalarType T;
+  typedef DecimatingConvolution<FILT,FACTOR,BOUNDARY> Decimating;
+  std::vector<T,PackAllocator<T>> in(size);
+  std::vector<T,PackAllocator<T>> full(size);
+  std::generate(in.begin(), in.end(), []() {
+    return static_cast<T>(rand()%16); });
+  Convolution<FILT,UnalignedMemory,UnalignedMemory,BOUNDARY>::NaiveConvolve(
+    in.data(), full.data(), 0, size, size);
+  std::vector<T> control(Decimating::DecimatedSize(size));
+  for (size_t j = 0; j < control.size(); j++) {
+    control[j] = full[FACTOR*j];
+  }
+
+  //One more element, that must not be written
+  std::vector<T> out(control.size()+1, T(-1));
+  Decimating::Convolve(in.data(), out.data(), size);
+  bool isOK = std::equal(control.begin(), control.end(), out.begin()) &&
+    out.back() == T(-1);
+
+  //Runtime coefficients
+  typedef RuntimeFilter<Filter<T,FILT::TapSizeLeft,FILT::TapSizeRight>>
+    Runtime;
+  std::fill(out.begin(), out.end(), T(-1));
+  DecimatingConvolution<Runtime,FACTOR,BOUNDARY>::Convolve(Runtime(FILT::Buf),
+    in.data(), out.data(), size);
+  isOK &= std::equal(control.begin(), control.end(), out.begin());
+  return isOK;
+}
+
+template<class FILT, int FACTOR>
+bool CheckBoundaries(int size) {
+  return Check<FILT,FACTOR,PeriodicBoundary>(size) &&
+    Check<FILT,FACTOR,MirrorBoundary>(size) &&
+    Check<FILT,FACTOR,ClampBoundary>(size) &&
+    Check<FILT,FACTOR,ZeroBoundary>(size);
+}
+
+template<class FILT>
+bool CheckFactors(int size) {
+  return CheckBoundaries<FILT,1>(size) && CheckBoundaries<FILT,2>(size) &&
+    CheckBoundaries<FILT,3>(size) && CheckBoundaries<FILT,4>(size);
+}
+
+template<class FILT, int FACTOR>
+void Benchmark(BenchmarkRunner& runner) {
+  typedef DecimatingConvolution<FILT,FACTOR> Decimating;
+  std::vector<float,PackAllocator<float>> in(LINESIZE);
+  std::vector<float,PackAllocator<float>> full(LINESIZE);
+  std::vector<float,PackAllocator<float>> out(
+    Decimating::DecimatedSize(LINESIZE));
+  std::generate(in.begin(), in.end(), []() {
+    return static_cast<float>(rand())/static_cast<float>(RAND_MAX); });
+  const double bytes = sizeof(float)*(in.size()+out.size());
+  const double flops = (2.*FILT::TapSize-1.)*out.size();
+  const std::string name = std::to_string(FILT::TapSize)+" taps, factor "+
+    std::to_string(FACTOR);
+  const double refMsec = runner.Run(name+", convolve then subsample", [&]() {
+      Convolution<FILT>::Convolve(in.data(), full.data(), LINESIZE);
+      for (size_t j = 0; j < out.size(); j++) {
+        out[j] = full[FACTOR*j];
+      }
+      ClobberMemory();
+    }, bytes, flops).median;
+  const double msec = runner.Run(name+", polyphase", [&]() {
+      Decimating::Convolve(in.data(), out.data(), LINESIZE);
+      ClobberMemory();
+    }, bytes, flops).median;
+  std::cout << "Speedup of the polyphase decimation for " << name << " is "
+    << refMsec/msec << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  bool isOK = true;
+  for (int size : {1, 2, 3, 7, 16, 33, 100, 1001, 4099}) {
+    isOK &= CheckFactors<MyFilter<float,1,1>>(size);
+    isOK &= CheckFactors<MyFilter<float,3,3>>(size);
+    isOK &= CheckFactors<MyFilter<float,2,4>>(size);
+    isOK &= CheckFactors<MyFilter<float,7,7>>(size);
+    isOK &= CheckFactors<MyFilter<double,3,3>>(size);
+  }
+  if (isOK) {
+    std::cout << "All decimating tests returned True Value" << std::endl;
+  } else {
+    std::cout << " WARNING : There may be a bug in decimating convolution"
+      << std::endl;
+  }
+
+  BenchmarkRunner runner(argc, argv);
+  Benchmark<MyFilter<float,3,3>,2>(runner);
+  Benchmark<MyFilter<float,7,7>,2>(runner);
+  Benchmark<MyFilter<float,3,3>,4>(runner);
+  Benchmark<MyFilter<float,7,7>,4>(runner);
+  return runner.Finish() && isOK ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,216 @@
+#ifndef FFT_H
+#define FFT_H
+
+//STL
+#include <cmath>
+
+//Local
+#include "MemoryHelper.h"
+
+VECTORIZATION_NAMESPACE_BEGIN
+
+/*
+ * Complex FFT of size n, a power of two, on VecSize independent transforms
+ * at once: in lane layout, the real and imaginary parts of element t of
+ * transform s are at re[t*VecSize+s] and im[t*VecSize+s], such that every
+ * butterfly is a vertical operation on whole vectors, whatever its span, and
+ * twiddle factors are broadcast scalars. VecT may be T itself, for a single
+ * transform.
+ * - Forward is a decimation in frequency, from natural order to bit reversed
+ *   order, Inverse a decimation in time, from bit reversed order to natural
+ *   order, that is not scaled by 1/n. No bit reversal is needed when the
+ *   spectrum is only multiplied pointwise with another one computed by
+ *   Forward, as for a convolution
+ * - Two radix-2 stages are fused in a single radix-4 pass, that loads and
+ *   stores each element once for both, a last radix-2 pass handles odd
+ *   powers of two
+ * Arrays must be vector aligned, and hold n*VecSize elements
+ */
+template<typename T, class VecT>
+class Fft {
+public:
+  constexpr static int VecSize = sizeof(VecT)/sizeof(T);
+
+  /*
+   * Twiddle factors of size n, in arrays of n elements: stage of span h uses
+   * exp(-i*pi*j/h) for j in [0,h), at index h+j
+   */
+  static void Twiddles(const int n, T* twRe, T* twIm) {
+    const double pi = std::acos(-1.);
+    twRe[0] = T(1);
+    twIm[0] = T(0);
+    for (int h = 1; h < n; h *= 2) {
+      for (int j = 0; j < h; j++) {
+        twRe[h+j] = static_cast<T>(std::cos(pi*j/h));
+        twIm[h+j] = static_cast<T>(-std::sin(pi*j/h));
+      }
+    }
+  }
+
+  static void Forward(T* re, T* im, const int n, const T* twRe,
+      const T* twIm) {
+    int h = n/2;
+    for (; h >= 2; h /= 4) {
+      ForwardRadix4(re, im, n, h/2, twRe, twIm);
+    }
+    if (h == 1) {
+      ForwardRadix2(re, im, n);
+    }
+  }
+
+  static void Inverse(T* re, T* im, const int n, const T* twRe,
+      const T* twIm) {
+    int h = 1;
+    for (; 2*h < n; h *= 4) {
+      InverseRadix4(re, im, n, h, twRe, twIm);
+    }
+    if (h < n) {
+      InverseRadix2(re, im, n, twRe, twIm);
+    }
+  }
+
+  //Pointwise product of each transform with the same spectrum, in place
+  static void Multiply(T* re, T* im, const int n, const T* specRe,
+      const T* specIm) {
+    for (int t = 0; t < n; t++) {
+      const VecT ar = MemOp::load(re+t*VecSize);
+      const VecT ai = MemOp::load(im+t*VecSize);
+      const VecT br = VecT() + specRe[t];
+      const VecT bi = VecT() + specIm[t];
+      MemOp::store(re+t*VecSize, ar*br-ai*bi);
+      MemOp::store(im+t*VecSize, ar*bi+ai*br);
+    }
+  }
+
+protected:
+  typedef VectorizedMemOp<T,VecT> MemOp;
+
+  //(re,im) *= (wr,wi)
+  static void Rotate(VecT& re, VecT& im, const VecT wr, const VecT wi) {
+    const VecT r = re*wr-im*wi;
+    im = re*wi+im*wr;
+    re = r;
+  }
+
+  /*
+   * Stages of span 2q then q, on groups of 4q elements, j, j+q, j+2q and
+   * j+3q being the inputs of the two butterflies of each stage
+   */
+  static void ForwardRadix4(T* re, T* im, const int n, const int q,
+      const T* twRe, const T* twIm) {
+    for (int g = 0; g < n; g += 4*q) {
+      for (int j = 0; j < q; j++) {
+        const VecT w1r = VecT() + twRe[2*q+j];
+        const VecT w1i = VecT() + twIm[2*q+j];
+        const VecT w2r = VecT() + twRe[3*q+j];
+        const VecT w2i = VecT() + twIm[3*q+j];
+        const VecT w3r = VecT() + twRe[q+j];
+        const VecT w3i = VecT() + twIm[q+j];
+        T* r = re+(g+j)*VecSize;
+        T* i = im+(g+j)*VecSize;
+        const int s = q*VecSize;
+        const VecT x0r = MemOp::load(r), x0i = MemOp::load(i);
+        const VecT x1r = MemOp::load(r+s), x1i = MemOp::load(i+s);
+        const VecT x2r = MemOp::load(r+2*s), x2i = MemOp::load(i+2*s);
+        const VecT x3r = MemOp::load(r+3*s), x3i = MemOp::load(i+3*s);
+        //Span 2q
+        const VecT a0r = x0r+x2r, a0i = x0i+x2i;
+        const VecT a1r = x1r+x3r, a1i = x1i+x3i;
+        VecT a2r = x0r-x2r, a2i = x0i-x2i;
+        VecT a3r = x1r-x3r, a3i = x1i-x3i;
+        Rotate(a2r, a2i, w1r, w1i);
+        Rotate(a3r, a3i, w2r, w2i);
+        //Span q
+        MemOp::store(r, a0r+a1r);
+        MemOp::store(i, a0i+a1i);
+        VecT y1r = a0r-a1r, y1i = a0i-a1i;
+        Rotate(y1r, y1i, w3r, w3i);
+        MemOp::store(r+s, y1r);
+        MemOp::store(i+s, y1i);
+        MemOp::store(r+2*s, a2r+a3r);
+        MemOp::store(i+2*s, a2i+a3i);
+        VecT y3r = a2r-a3r, y3i = a2i-a3i;
+        Rotate(y3r, y3i, w3r, w3i);
+        MemOp::store(r+3*s, y3r);
+        MemOp::store(i+3*s, y3i);
+      }
+    }
+  }
+
+  //Last stage of span 1, whose twiddle factor is 1
+  static void ForwardRadix2(T* re, T* im, const int n) {
+    for (int g = 0; g < n; g += 2) {
+      T* r = re+g*VecSize;
+      T* i = im+g*VecSize;
+      const VecT x0r = MemOp::load(r), x0i = MemOp::load(i);
+      const VecT x1r = MemOp::load(r+VecSize), x1i = MemOp::load(i+VecSize);
+      MemOp::store(r, x0r+x1r);
+      MemOp::store(i, x0i+x1i);
+      MemOp::store(r+VecSize, x0r-x1r);
+      MemOp::store(i+VecSize, x0i-x1i);
+    }
+  }
+
+  //Stages of span h then 2h, with conjugated twiddle factors
+  static void InverseRadix4(T* re, T* im, const int n, const int h,
+      const T* twRe, const T* twIm) {
+    for (int g = 0; g < n; g += 4*h) {
+      for (int j = 0; j < h; j++) {
+        const VecT w1r = VecT() + twRe[h+j];
+        const VecT w1i = VecT() - twIm[h+j];
+        const VecT w2r = VecT() + twRe[2*h+j];
+        const VecT w2i = VecT() - twIm[2*h+j];
+        const VecT w3r = VecT() + twRe[3*h+j];
+        const VecT w3i = VecT() - twIm[3*h+j];
+        T* r = re+(g+j)*VecSize;
+        T* i = im+(g+j)*VecSize;
+        const int s = h*VecSize;
+        const VecT x0r = MemOp::load(r), x0i = MemOp::load(i);
+        VecT x1r = MemOp::load(r+s), x1i = MemOp::load(i+s);
+        const VecT x2r = MemOp::load(r+2*s), x2i = MemOp::load(i+2*s);
+        VecT x3r = MemOp::load(r+3*s), x3i = MemOp::load(i+3*s);
+        //Span h
+        Rotate(x1r, x1i, w1r, w1i);
+        Rotate(x3r, x3i, w1r, w1i);
+        const VecT a0r = x0r+x1r, a0i = x0i+x1i;
+        const VecT a1r = x0r-x1r, a1i = x0i-x1i;
+        VecT a2r = x2r+x3r, a2i = x2i+x3i;
+        VecT a3r = x2r-x3r, a3i = x2i-x3i;
+        //Span 2h
+        Rotate(a2r, a2i, w2r, w2i);
+        Rotate(a3r, a3i, w3r, w3i);
+        MemOp::store(r, a0r+a2r);
+        MemOp::store(i, a0i+a2i);
+        MemOp::store(r+s, a1r+a3r);
+        MemOp::store(i+s, a1i+a3i);
+        MemOp::store(r+2*s, a0r-a2r);
+        MemOp::store(i+2*s, a0i-a2i);
+        MemOp::store(r+3*s, a1r-a3r);
+        MemOp::store(i+3*s, a1i-a3i);
+      }
+    }
+  }
+
+  //Last stage of span n/2
+  static void InverseRadix2(T* re, T* im, const int n, const T* twRe,
+      const T* twIm) {
+    const int h = n/2;
+    for (int j = 0; j < h; j++) {
+      const VecT wr = VecT() + twRe[h+j];
+      const VecT wi = VecT() - twIm[h+j];
+      T* r = re+j*VecSize;
+      T* i = im+j*VecSize;
+      const int s = h*VecSize;
+      const VecT x0r = MemOp::load(r), x0i = MemOp::load(i);
+      VecT x1r = MemOp::load(r+s), x1i = MemOp::load(i+s);
+      Rotate(x1r, x1i, wr, wi);
+      MemOp::store(r, x0r+x1r);
+      MemOp::store(i, x0i+x1i);
+      MemOp::store(r+s, x0r-x1r);
+      MemOp::store(i+s, x0i-x1i);
+    }
+  }
+};
+
+VECTORIZATION_NAMESPACE_END
+#endif //FFT_H
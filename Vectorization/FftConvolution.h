@@ -0,0 +1,301 @@
+#ifndef FFTCONVOLUTION_H
+#define FFTCONVOLUTION_H
+
+//STL
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+//Local
+#include "Convolution.h"
+#include "FFT.h"
+
+VECTORIZATION_NAMESPACE_BEGIN
+
+/*
+ * Tap count from which the FFT beats the direct sum for a line of lineSize
+ * elements of T, as measured and printed by FftConvolution/main.cpp
+ * on lines of 2^10 to 2^20 elements, for 32 to 1024 taps: 2048 stands for
+ * an FFT that never won. The FFT processes 2*VecSize blocks of the line at
+ * once, such that short lines leave most of the lanes empty on wide vectors.
+ * NEON entries are the ones of 128 bits x86, they have not been measured
+ */
+template<typename T>
+class FftCrossover {
+public:
+  static int TapSize(const int lineSize) {
+    //One entry per power of 4 of the line size, from 2^10
+    int idx = 0;
+    for (int size = 1 << 12; size <= lineSize && idx < NbEntry-1;
+        size *= 4) {
+      idx++;
+    }
+    return std::is_same<T,double>::value ? DoubleTable[idx] :
+      FloatTable[idx];
+  }
+protected:
+  constexpr static int NbEntry = 6;
+#if defined USE_AVX512
+  constexpr static int FloatTable[NbEntry] = {2048, 2048, 256, 128, 128, 128};
+  constexpr static int DoubleTable[NbEntry] = {2048, 2048, 64, 64, 64, 64};
+#elif defined USE_AVX2
+  constexpr static int FloatTable[NbEntry] = {2048, 2048, 128, 128, 128, 128};
+  constexpr static int DoubleTable[NbEntry] = {2048, 128, 64, 64, 64, 64};
+#elif defined USE_AVX || defined USE_NEON
+  constexpr static int FloatTable[NbEntry] = {2048, 64, 64, 64, 64, 64};
+  constexpr static int DoubleTable[NbEntry] = {64, 64, 32, 32, 32, 32};
+#else
+  constexpr static int FloatTable[NbEntry] = {32, 32, 32, 32, 32, 32};
+  constexpr static int DoubleTable[NbEntry] = {64, 32, 32, 32, 32, 32};
+#endif
+};
+
+template<typename T>
+constexpr int FftCrossover<T>::FloatTable[];
+template<typename T>
+constexpr int FftCrossover<T>::DoubleTable[];
+
+//Smallest power of two at or above size
+constexpr int PowerOfTwoAbove(const int size) {
+  return size <= 1 ? 1 : 2*PowerOfTwoAbove((size+1)/2);
+}
+
+/*
+ * Convolution of a line with a long floating point filter, from a few tens
+ * to a few thousands taps, with the same output as Convolution::Convolve.
+ * Neither path instantiates code per tap, unlike ConvolutionAccumulator,
+ * such that compile time does not depend on TapSize:
+ * - ConvolveDirect extends the whole line once with BOUNDARY_POLICY, then
+ *   sums the taps in a runtime loop, for NbAccumulator output vectors at a
+ *   time that hide the latency of the multiply-add chains, O(n*TapSize).
+ *   Mirrored taps of symmetric filters are folded, as in Convolution
+ * - ConvolveFft uses overlap-save: each block of BlockSize outputs is the
+ *   end of the circular convolution of FftSize extended inputs with the
+ *   reversed filter, computed by Fft. Blocks are processed by batches of
+ *   2*VecSize, two blocks per lane as the real and imaginary parts of a
+ *   complex transform, since the filter is real, O(n*log(TapSize))
+ * - Convolve picks either one from FftCrossover
+ * The FFT rounding error grows with log(FftSize), and is not tied to a tap,
+ * outputs are then only close to the ones of the direct sum
+ */
+template<class FILT, class BOUNDARY_POLICY=PeriodicBoundary>
+class FftConvolution {
+public:
+  static_assert(std::is_floating_point<typename FILT::ScalarType>::value,
+    "FftConvolution needs floating point filters");
+  typedef typename FILT::ScalarType T;
+  typedef typename FILT::VectorType VecT;
+  constexpr static int VecSize = FILT::VecSize;
+  constexpr static int TapSize = FILT::TapSize;
+  //Transform size, the power of two at or above 4*TapSize, such that about
+  //3/4 of the transform are outputs
+  constexpr static int FftSize = PowerOfTwoAbove(4*TapSize);
+  //Number of outputs per block
+  constexpr static int BlockSize = FftSize-TapSize+1;
+  //Number of blocks per batch
+  constexpr static int BatchSize = 2*VecSize;
+  //Output vectors summed at once by the direct path
+  constexpr static int NbAccumulator = 8;
+
+  static bool UseFft(const int lineSize) {
+    return TapSize >= FftCrossover<T>::TapSize(lineSize);
+  }
+
+  static void Convolve(const T* in, T* out, const int lineSize) {
+    ConvolveLine(FILT::Buf, in, out, lineSize);
+  }
+
+  //Filter with runtime coefficients, see RuntimeFilter
+  static void Convolve(const FILT& filter, const T* in, T* out,
+      const int lineSize) {
+    ConvolveLine(filter.Buf, in, out, lineSize);
+  }
+
+  static void ConvolveDirect(const T* in, T* out, const int lineSize) {
+    Direct(FILT::Buf, in, out, lineSize);
+  }
+
+  static void ConvolveDirect(const FILT& filter, const T* in, T* out,
+      const int lineSize) {
+    Direct(filter.Buf, in, out, lineSize);
+  }
+
+  static void ConvolveFft(const T* in, T* out, const int lineSize) {
+    OverlapSave(FILT::Buf, in, out, lineSize);
+  }
+
+  static void ConvolveFft(const FILT& filter, const T* in, T* out,
+      const int lineSize) {
+    OverlapSave(filter.Buf, in, out, lineSize);
+  }
+
+protected:
+  typedef typename FILT::CoefficientType CoefficientType;
+  typedef VectorizedMemOp<T,VecT,UnalignedMemory> MemOp;
+  typedef Fft<T,VecT> LaneFft;
+  //Number of taps summed by the direct path, after folding
+  constexpr static int DirectTapSize =
+    FILT::Symmetry == FilterSymmetry::None ? TapSize : (TapSize+1)/2;
+
+  static void ConvolveLine(const CoefficientType* buf, const T* in, T* out,
+      const int lineSize) {
+    if (UseFft(lineSize)) {
+      OverlapSave(buf, in, out, lineSize);
+    } else {
+      Direct(buf, in, out, lineSize);
+    }
+  }
+
+  static void Direct(const CoefficientType* buf, const T* in, T* out,
+      const int lineSize) {
+    if (lineSize <= 0) {
+      return;
+    }
+    PERF_SCOPE("FftConvolution::ConvolveDirect");
+    //The loads of the last partial vector may go up to VecSize-1 elements
+    //beyond the extended line, they read zeros
+    const int size = lineSize+TapSize-1;
+    std::vector<T,PackAllocator<T>> extended(size+VecSize, T(0));
+    BOUNDARY_POLICY::Extend(in, lineSize, -FILT::TapSizeLeft,
+      extended.data(), size);
+    const T* src = extended.data();
+    int i = 0;
+    for (; i+NbAccumulator*VecSize <= lineSize;
+        i += NbAccumulator*VecSize) {
+      VecT acc[NbAccumulator];
+      for (int a = 0; a < NbAccumulator; a++) {
+        acc[a] = VecT() + T(0);
+      }
+      for (int k = 0; k < DirectTapSize; k++) {
+        const VecT coef = VecT() + buf[k];
+        for (int a = 0; a < NbAccumulator; a++) {
+          acc[a] += coef*DirectInput(src+i+a*VecSize, k);
+        }
+      }
+      for (int a = 0; a < NbAccumulator; a++) {
+        MemOp::store(out+i+a*VecSize, acc[a]);
+      }
+    }
+    for (; i < lineSize; i += VecSize) {
+      VecT acc = VecT() + T(0);
+      for (int k = 0; k < DirectTapSize; k++) {
+        acc += buf[k]*DirectInput(src+i, k);
+      }
+      MemOp::maskstore(out+i, acc, std::min(VecSize, lineSize-i));
+    }
+  }
+
+  /*
+   * Input vector of tap k, added to or subtracted from the one of its mirror
+   * tap for symmetric filters, whose center coefficient, if any, is the last
+   * one of the DirectTapSize summed taps (see FilterSymmetry)
+   */
+  static VecT DirectInput(const T* src, const int k) {
+    if (FILT::Symmetry == FilterSymmetry::None || 2*k+1 == TapSize) {
+      return MemOp::load(src+k);
+    }
+    const VecT left = MemOp::load(src+k);
+    const VecT right = MemOp::load(src+TapSize-1-k);
+    return FILT::Symmetry == FilterSymmetry::Symmetric ? left+right :
+      left-right;
+  }
+
+  //Twiddle factors of FftSize, real parts then imaginary parts
+  static const T* Twiddles() {
+    static const std::vector<T> twiddles = [] {
+      std::vector<T> tw(2*FftSize);
+      LaneFft::Twiddles(FftSize, tw.data(), tw.data()+FftSize);
+      return tw;
+    }();
+    return twiddles.data();
+  }
+
+  static void OverlapSave(const CoefficientType* buf, const T* in, T* out,
+      const int lineSize) {
+    if (lineSize <= 0) {
+      return;
+    }
+    PERF_SCOPE("FftConvolution::ConvolveFft");
+    const T* twRe = Twiddles();
+    const T* twIm = twRe+FftSize;
+    //Spectrum of the reversed filter, scaled by the 1/FftSize of the
+    //inverse transform
+    std::vector<T> spectrum(2*FftSize, T(0));
+    T* specRe = spectrum.data();
+    T* specIm = specRe+FftSize;
+    for (int m = 0; m < TapSize; m++) {
+      specRe[m] = static_cast<T>(buf[TapSize-1-m])/FftSize;
+    }
+    Fft<T,T>::Forward(specRe, specIm, FftSize, twRe, twIm);
+
+    std::vector<T,PackAllocator<T>> lanes(2*FftSize*VecSize);
+    T* re = lanes.data();
+    T* im = re+FftSize*VecSize;
+    std::vector<T> zeros(FftSize, T(0));
+    std::vector<T> extended;
+    const T* blocks[BatchSize];
+    const int nbBlock = (lineSize+BlockSize-1)/BlockSize;
+    for (int first = 0; first < nbBlock; first += BatchSize) {
+      //Inputs of each block, extended by BOUNDARY_POLICY near the ends of
+      //the line, and zeros for the blocks beyond the last one
+      int nbExtended = 0;
+      for (int b = 0; b < BatchSize; b++) {
+        nbExtended += first+b < nbBlock && !Inside(first+b, lineSize);
+      }
+      extended.resize(nbExtended*FftSize);
+      nbExtended = 0;
+      for (int b = 0; b < BatchSize; b++) {
+        const int block = first+b;
+        const int begin = block*BlockSize-FILT::TapSizeLeft;
+        if (block >= nbBlock) {
+          blocks[b] = zeros.data();
+        } else if (Inside(block, lineSize)) {
+          blocks[b] = in+begin;
+        } else {
+          T* dst = extended.data()+nbExtended*FftSize;
+          BOUNDARY_POLICY::Extend(in, lineSize, begin, dst, FftSize);
+          blocks[b] = dst;
+          nbExtended++;
+        }
+      }
+      ToLanes(blocks, re, im);
+      LaneFft::Forward(re, im, FftSize, twRe, twIm);
+      LaneFft::Multiply(re, im, FftSize, specRe, specIm);
+      LaneFft::Inverse(re, im, FftSize, twRe, twIm);
+      FromLanes(re, im, out, first, lineSize);
+    }
+  }
+
+  //Whether the inputs of block are all in the line
+  static bool Inside(const int block, const int lineSize) {
+    const int begin = block*BlockSize-FILT::TapSizeLeft;
+    return begin >= 0 && begin+FftSize <= lineSize;
+  }
+
+  //Block 2*s as the real part of lane s, block 2*s+1 as its imaginary part
+  static void ToLanes(const T* const* blocks, T* re, T* im) {
+    for (int t = 0; t < FftSize; t++) {
+      for (int s = 0; s < VecSize; s++) {
+        re[t*VecSize+s] = blocks[2*s][t];
+        im[t*VecSize+s] = blocks[2*s+1][t];
+      }
+    }
+  }
+
+  //The last BlockSize elements of each circular convolution are outputs
+  static void FromLanes(const T* re, const T* im, T* out, const int first,
+      const int lineSize) {
+    const int offset = (TapSize-1)*VecSize;
+    for (int b = 0; b < BatchSize; b++) {
+      const int begin = (first+b)*BlockSize;
+      const int count = std::min(BlockSize, lineSize-begin);
+      const T* src = (b%2 == 0 ? re : im)+offset+b/2;
+      for (int t = 0; t < count; t++) {
+        out[begin+t] = src[t*VecSize];
+      }
+    }
+  }
+};
+
+VECTORIZATION_NAMESPACE_END
+#endif //FFTCONVOLUTION_H
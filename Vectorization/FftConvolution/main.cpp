@@ -0,0 +1,251 @@
+/*
+ * main.cpp
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: gnthibault
+ */
+
+//STL
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//Local
+#include "../FftConvolution.h"
+#include "../../Profiling/Benchmark.h"
+
+/*
+ * Matched filters of 64 to 1024 taps: the direct path of FftConvolution is
+ * checked against NaiveConvolve exactly, the FFT path and Convolution, that
+ * forwards long filters to FftConvolution, within the FFT rounding error.
+ * Both paths are then timed for tap counts and line sizes that span the
+ * entries of FftCrossover, and the measured crossover is printed for each
+ * line size, in the same form as the table of the current instruction set
+ */
+
+//Filter with static coefficients, set by the checks before each use
+template<typename T, int TAP_SIZE_LEFT, int TAP_SIZE_RIGHT,
+  FilterSymmetry SYMMETRY=FilterSymmetry::None>
+class LongFilter : public Filter<T,TAP_SIZE_LEFT,TAP_SIZE_RIGHT,SYMMETRY> {
+public:
+  static T Buf[TAP_SIZE_LEFT+TAP_SIZE_RIGHT+1];
+};
+
+template<typename T, int TAP_SIZE_LEFT, int TAP_SIZE_RIGHT,
+  FilterSymmetry SYMMETRY>
+T LongFilter<T,TAP_SIZE_LEFT,TAP_SIZE_RIGHT,SYMMETRY>::Buf[
+  TAP_SIZE_LEFT+TAP_SIZE_RIGHT+1];
+
+//build with
+//g++ ./main.cpp -std=c++14 -O3 -mavx2 -mfma -o test -DUSE_AVX2
+//g++ ./main.cpp -std=c++14 -O3 -march=skylake-avx512 -o test -DUSE_AVX512
+//./test --json fftconvolution.json
+
+/*
+ * Dyadic coefficients in [-1,1], folded according to the symmetry of FILT,
+ * and small integer inputs: sums are exact in any order, such that the
+ * direct path must match the reference exactly
+ */
+template<class FILT>
+void Coefficients(typename FILT::ScalarType* buf) {
+  typedef typename FILT::ScalarType T;
+  for (int k = 0; k < FILT::TapSize; k++) {
+    buf[k] = static_cast<T>(rand()%129-64)/T(64);
+  }
+  for (int k = 0; k < FILT::TapSize/2; k++) {
+    T& mirror = buf[FILT::TapSize-1-k];
+    if (FILT::Symmetry == FilterSymmetry::Symmetric) {
+      mirror = buf[k];
+    } else if (FILT::Symmetry == FilterSymmetry::Antisymmetric) {
+      mirror = -buf[k];
+    }
+  }
+  if (FILT::TapSize%2 == 1 &&
+      FILT::Symmetry == FilterSymmetry::Antisymmetric) {
+    buf[FILT::TapSize/2] = T(0);
+  }
+}
+
+/*
+ * The FFT error is relative to the largest output the filter may produce,
+ * sum(|c_k|)*max(|x|), and grows with log(FftSize)
+ */
+template<typename T>
+bool Near(const std::vector<T>& control, const std::vector<T>& out,
+    const T* buf, const int tapSize, const T maxInput) {
+  T bound = T(0);
+  for (int k = 0; k < tapSize; k++) {
+    bound += std::abs(buf[k]);
+  }
+  const T tolerance = (sizeof(T) == sizeof(float) ? T(1e-5) : T(1e-13))*
+    bound*maxInput;
+  for (std::size_t i = 0; i < control.size(); i++) {
+    if (!(std::abs(control[i]-out[i]) <= tolerance)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template<class FILT, class BOUNDARY>
+bool Check(int size) {
+  typedef typename FILT::ScalarType T;
+  typedef RuntimeFilter<FILT> Runtime;
+  typedef FftConvolution<Runtime,BOUNDARY> LongConvolution;
+  typedef Convolution<Runtime,UnalignedMemory,UnalignedMemory,BOUNDARY>
+    Generic;
+  std::vector<T> coefficients(FILT::TapSize);
+  Coefficients<FILT>(coefficients.data());
+  const Runtime filter(coefficients.data());
+  std::vector<T> in(size);
+  std::generate(in.begin(), in.end(), []() {
+    return static_cast<T>(rand()%16-8); });
+  std::vector<T> control(size, T(0));
+  Generic::NaiveConvolve(filter, in.data(), control.data(), 0, size, size);
+
+  //One more element, that must not be written
+  std::vector<T> out(size+1, T(-1));
+  LongConvolution::ConvolveDirect(filter, in.data(), out.data(), size);
+  bool isOK = std::equal(control.begin(), control.end(), out.begin()) &&
+    out.back() == T(-1);
+
+  std::fill(out.begin(), out.end(), T(-1));
+  LongConvolution::ConvolveFft(filter, in.data(), out.data(), size);
+  isOK &= Near(control, out, filter.Buf, FILT::TapSize, T(8)) &&
+    out.back() == T(-1);
+
+  std::fill(out.begin(), out.end(), T(-1));
+  Generic::Convolve(filter, in.data(), out.data(), size);
+  isOK &= Near(control, out, filter.Buf, FILT::TapSize, T(8)) &&
+    out.back() == T(-1);
+
+  //Static coefficients, and batches of lines
+  typedef LongFilter<T,FILT::TapSizeLeft,FILT::TapSizeRight,FILT::Symmetry>
+    Static;
+  std::copy(coefficients.begin(), coefficients.end(), Static::Buf);
+  std::fill(out.begin(), out.end(), T(-1));
+  Convolution<Static,UnalignedMemory,UnalignedMemory,BOUNDARY>::Convolve(
+    in.data(), out.data(), size);
+  isOK &= Near(control, out, Static::Buf, FILT::TapSize, T(8));
+
+  const int nLines = 3;
+  std::vector<T> lines(nLines*size), outLines(nLines*size);
+  for (int line = 0; line < nLines; line++) {
+    std::copy(in.begin(), in.end(), lines.begin()+line*size);
+  }
+  Generic::ConvolveBatch(filter, lines.data(), outLines.data(), size, nLines,
+    size);
+  for (int line = 0; line < nLines; line++) {
+    std::copy(outLines.begin()+line*size, outLines.begin()+(line+1)*size,
+      out.begin());
+    isOK &= Near(control, out, filter.Buf, FILT::TapSize, T(8));
+  }
+  return isOK;
+}
+
+template<class FILT>
+bool CheckBoundaries(int size) {
+  return Check<FILT,PeriodicBoundary>(size) &&
+    Check<FILT,MirrorBoundary>(size) &&
+    Check<FILT,ClampBoundary>(size) &&
+    Check<FILT,ZeroBoundary>(size);
+}
+
+/*
+ * Direct and FFT paths for a filter of TAP_SIZE taps, on lines of 2^10 to
+ * 2^20 elements, returns for each line size whether the FFT was faster
+ */
+template<typename T, int TAP_SIZE>
+std::vector<bool> Benchmark(BenchmarkRunner& runner,
+    const std::vector<int>& lineSizes) {
+  typedef RuntimeFilter<Filter<T,TAP_SIZE/2,TAP_SIZE-1-TAP_SIZE/2>> FILT;
+  typedef FftConvolution<FILT> LongConvolution;
+  std::vector<T> coefficients(TAP_SIZE);
+  Coefficients<FILT>(coefficients.data());
+  const FILT filter(coefficients.data());
+  std::vector<bool> fftFaster;
+  for (int lineSize : lineSizes) {
+    std::vector<T,PackAllocator<T>> in(lineSize);
+    std::vector<T,PackAllocator<T>> out(lineSize);
+    std::generate(in.begin(), in.end(), []() {
+      return static_cast<T>(rand())/static_cast<T>(RAND_MAX); });
+    const double bytes = 2.*sizeof(T)*lineSize;
+    const double flops = (2.*TAP_SIZE-1.)*lineSize;
+    const std::string name = std::string(sizeof(T) == sizeof(float) ?
+      "float, " : "double, ")+std::to_string(TAP_SIZE)+" taps, "+
+      std::to_string(lineSize)+" elements";
+    const double directMsec = runner.Run(name+", direct", [&]() {
+        LongConvolution::ConvolveDirect(filter, in.data(), out.data(),
+          lineSize);
+        ClobberMemory();
+      }, bytes, flops).median;
+    const double fftMsec = runner.Run(name+", fft", [&]() {
+        LongConvolution::ConvolveFft(filter, in.data(), out.data(),
+          lineSize);
+        ClobberMemory();
+      }, bytes, flops).median;
+    fftFaster.push_back(fftMsec < directMsec);
+  }
+  return fftFaster;
+}
+
+/*
+ * Smallest tap count from which the FFT wins for all the longer filters,
+ * for each line size
+ */
+template<typename T>
+void Crossover(BenchmarkRunner& runner) {
+  const std::vector<int> lineSizes = {1 << 10, 1 << 12, 1 << 14, 1 << 16,
+    1 << 18, 1 << 20};
+  const std::vector<int> tapSizes = {32, 64, 128, 256, 512, 1024};
+  std::vector<std::vector<bool>> fftFaster = {
+    Benchmark<T,32>(runner, lineSizes), Benchmark<T,64>(runner, lineSizes),
+    Benchmark<T,128>(runner, lineSizes), Benchmark<T,256>(runner, lineSizes),
+    Benchmark<T,512>(runner, lineSizes),
+    Benchmark<T,1024>(runner, lineSizes)};
+  std::cout << "Measured " << (sizeof(T) == sizeof(float) ? "float" :
+    "double") << " crossover {";
+  for (std::size_t s = 0; s < lineSizes.size(); s++) {
+    //Beyond the longest filter that was timed when the FFT never wins
+    int crossover = 2*tapSizes.back();
+    for (int t = static_cast<int>(tapSizes.size())-1;
+        t >= 0 && fftFaster[t][s]; t--) {
+      crossover = tapSizes[t];
+    }
+    std::cout << crossover << (s+1 < lineSizes.size() ? ", " : "}\n");
+  }
+  std::cout << "Table in use {";
+  for (std::size_t s = 0; s < lineSizes.size(); s++) {
+    std::cout << FftCrossover<T>::TapSize(lineSizes[s]) <<
+      (s+1 < lineSizes.size() ? ", " : "}\n");
+  }
+}
+
+int main(int argc, char* argv[]) {
+  bool isOK = true;
+  for (int size : {1, 7, 100, 1000, 5000, 40000}) {
+    isOK &= CheckBoundaries<Filter<float,31,32>>(size);
+    isOK &= CheckBoundaries<Filter<float,100,27>>(size);
+    isOK &= CheckBoundaries<Filter<float,40,40,
+      FilterSymmetry::Antisymmetric>>(size);
+    isOK &= CheckBoundaries<Filter<float,255,255,
+      FilterSymmetry::Symmetric>>(size);
+    isOK &= CheckBoundaries<Filter<double,50,13>>(size);
+    isOK &= CheckBoundaries<Filter<double,64,64,
+      FilterSymmetry::Symmetric>>(size);
+  }
+  if (isOK) {
+    std::cout << "All fft convolution tests returned True Value" << std::endl;
+  } else {
+    std::cout << " WARNING : There may be a bug in fft convolution"
+      << std::endl;
+  }
+
+  BenchmarkRunner runner(argc, argv);
+  Crossover<float>(runner);
+  Crossover<double>(runner);
+  return runner.Finish() && isOK ? EXIT_SUCCESS : EXIT_FAILURE;
+}
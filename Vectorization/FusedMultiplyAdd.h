@@ -0,0 +1,129 @@
+#ifndef FUSEDMULTIPLYADD_H
+#define FUSEDMULTIPLYADD_H
+
+// STL
+#include <cmath>
+
+// Local
+#include "vectorization.h"
+
+VECTORIZATION_NAMESPACE_BEGIN
+
+/*
+ * a*b+c for vectors of T, PackType<T>, with a single rounding when the
+ * target supports fused multiply-add (-mfma on x86, always the case with
+ * AVX512, armv8 on arm). Fused is false for the generic version, that
+ * compilers may still contract, or not, depending on -ffp-contract.
+ * Keyed on the scalar type: vector types as template arguments lose their
+ * alignment attributes, and trigger -Wignored-attributes at every use
+ */
+template<typename T>
+class FmaOps {
+ public:
+  typedef PackType<T> VecT;
+  constexpr static bool Fused = false;
+  static VecT MultiplyAdd( VecT a, VecT b, VecT c ) { return a*b+c; }
+};
+
+#ifdef USE_AVX
+#ifdef __FMA__
+template<>
+class FmaOps<float> {
+ public:
+  constexpr static bool Fused = true;
+  static __m128 MultiplyAdd( __m128 a, __m128 b, __m128 c ) {
+    return _mm_fmadd_ps(a,b,c);
+  }
+};
+template<>
+class FmaOps<double> {
+ public:
+  constexpr static bool Fused = true;
+  static __m128d MultiplyAdd( __m128d a, __m128d b, __m128d c ) {
+    return _mm_fmadd_pd(a,b,c);
+  }
+};
+#endif //__FMA__
+#elif defined USE_AVX2
+#ifdef __FMA__
+template<>
+class FmaOps<float> {
+ public:
+  constexpr static bool Fused = true;
+  static __m256 MultiplyAdd( __m256 a, __m256 b, __m256 c ) {
+    return _mm256_fmadd_ps(a,b,c);
+  }
+};
+template<>
+class FmaOps<double> {
+ public:
+  constexpr static bool Fused = true;
+  static __m256d MultiplyAdd( __m256d a, __m256d b, __m256d c ) {
+    return _mm256_fmadd_pd(a,b,c);
+  }
+};
+#endif //__FMA__
+#elif defined USE_AVX512
+template<>
+class FmaOps<float> {
+ public:
+  constexpr static bool Fused = true;
+  static __m512 MultiplyAdd( __m512 a, __m512 b, __m512 c ) {
+    return _mm512_fmadd_ps(a,b,c);
+  }
+};
+template<>
+class FmaOps<double> {
+ public:
+  constexpr static bool Fused = true;
+  static __m512d MultiplyAdd( __m512d a, __m512d b, __m512d c ) {
+    return _mm512_fmadd_pd(a,b,c);
+  }
+};
+#elif defined USE_NEON
+#ifdef __ARM_FEATURE_FMA
+template<>
+class FmaOps<float> {
+ public:
+  constexpr static bool Fused = true;
+  static float32x4_t MultiplyAdd( float32x4_t a, float32x4_t b,
+      float32x4_t c ) {
+    return vfmaq_f32(c,a,b);
+  }
+};
+#ifdef __aarch64__
+template<>
+class FmaOps<double> {
+ public:
+  constexpr static bool Fused = true;
+  static float64x2_t MultiplyAdd( float64x2_t a, float64x2_t b,
+      float64x2_t c ) {
+    return vfmaq_f64(c,a,b);
+  }
+};
+#endif //__aarch64__
+#endif //__ARM_FEATURE_FMA
+#else
+#ifdef __FMA__
+//Scalar backend: std::fma is a single instruction when the target has fma
+template<>
+class FmaOps<float> {
+ public:
+  constexpr static bool Fused = true;
+  static float MultiplyAdd( float a, float b, float c ) {
+    return std::fma(a,b,c);
+  }
+};
+template<>
+class FmaOps<double> {
+ public:
+  constexpr static bool Fused = true;
+  static double MultiplyAdd( double a, double b, double c ) {
+    return std::fma(a,b,c);
+  }
+};
+#endif //__FMA__
+#endif
+
+VECTORIZATION_NAMESPACE_END
+#endif //FUSEDMULTIPLYADD_H
@@ -6,11 +6,17 @@
  */
 
 //STL
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
 #include <vector>
 
 
 //Local
 #include "../Convolution.h"
+#include "../ConvolutionDispatcher.h"
 
 
 /*
@@ -26,11 +32,49 @@ template<> const double MyFilter<double,0,3>::Buf[4] = {1.0f,2.0f,3.0f,4.0f};
 template<> const double MyFilter<double,0,1>::Buf[2] = {1.0f,2.0f};
 template<> const double MyFilter<double,2,2>::Buf[5] = {1.0f,2.0f,3.0f,4.0f,5.0f};
 template<> const double MyFilter<double,3,3>::Buf[7] = {1.0f,2.0f,3.0f,4.0f,5.0f,6.0f,7.0f};
+template<> const float MyFilter<float,9,6>::Buf[16] = {1.0f,2.0f,3.0f,4.0f,5.0f,6.0f,7.0f,8.0f,9.0f,10.0f,11.0f,12.0f,13.0f,14.0f,15.0f,16.0f};
+template<> const double MyFilter<double,9,6>::Buf[16] = {1.0f,2.0f,3.0f,4.0f,5.0f,6.0f,7.0f,8.0f,9.0f,10.0f,11.0f,12.0f,13.0f,14.0f,15.0f,16.0f};
+
+/*
+ * Symmetric and antisymmetric filters, including an even size one, that is
+ * symmetric around a half sample
+ */
+template<> const float MyFilter<float,3,3,FilterSymmetry::Symmetric>::Buf[7] = {1.0f,2.0f,3.0f,4.0f,3.0f,2.0f,1.0f};
+template<> const float MyFilter<float,2,2,FilterSymmetry::Antisymmetric>::Buf[5] = {1.0f,2.0f,0.0f,-2.0f,-1.0f};
+template<> const float MyFilter<float,1,2,FilterSymmetry::Symmetric>::Buf[4] = {1.0f,2.0f,2.0f,1.0f};
+template<> const float MyFilter<float,7,7,FilterSymmetry::Symmetric>::Buf[15] = {1.0f,2.0f,3.0f,4.0f,5.0f,6.0f,7.0f,8.0f,7.0f,6.0f,5.0f,4.0f,3.0f,2.0f,1.0f};
+template<> const double MyFilter<double,3,3,FilterSymmetry::Symmetric>::Buf[7] = {1.0f,2.0f,3.0f,4.0f,3.0f,2.0f,1.0f};
+template<> const double MyFilter<double,2,2,FilterSymmetry::Antisymmetric>::Buf[5] = {1.0f,2.0f,0.0f,-2.0f,-1.0f};
+template<> const double MyFilter<double,1,2,FilterSymmetry::Symmetric>::Buf[4] = {1.0f,2.0f,2.0f,1.0f};
+template<> const double MyFilter<double,7,7,FilterSymmetry::Symmetric>::Buf[15] = {1.0f,2.0f,3.0f,4.0f,5.0f,6.0f,7.0f,8.0f,7.0f,6.0f,5.0f,4.0f,3.0f,2.0f,1.0f};
+
+/*
+ * Fixed point filters for integer pixels, the last one saturates
+ */
+template<> const int16_t MyIntegerFilter<uint8_t,1,1,4>::Buf[3] = {4,8,4};
+template<> const int16_t MyIntegerFilter<uint8_t,3,3,6>::Buf[7] = {-3,-9,30,48,30,-9,-3};
+template<> const int16_t MyIntegerFilter<uint8_t,9,6,8>::Buf[16] = {1,-2,3,-4,5,-6,7,300,-8,9,-10,11,-12,13,-14,15};
+template<> const int16_t MyIntegerFilter<uint8_t,0,1,0>::Buf[2] = {3,-1};
+template<> const int16_t MyIntegerFilter<int16_t,1,1,4>::Buf[3] = {4,8,4};
+template<> const int16_t MyIntegerFilter<int16_t,3,3,6>::Buf[7] = {-3,-9,30,48,30,-9,-3};
+template<> const int16_t MyIntegerFilter<int16_t,9,6,8>::Buf[16] = {1,-2,3,-4,5,-6,7,300,-8,9,-10,11,-12,13,-14,15};
+template<> const int16_t MyIntegerFilter<int16_t,0,1,0>::Buf[2] = {3,-1};
 
 
 //build with
-//g++ ./main.cpp -std=c++14 -O3 -msse2 -o test -DUSE_SSE
-//g++ ./main.cpp -std=c++14 -O3 -mavx2 -o test -DUSE_AVX
+//g++ ./main.cpp -std=c++14 -O3 -mavx -o test -DUSE_AVX
+//g++ ./main.cpp -std=c++14 -O3 -mavx2 -mfma -o test -DUSE_AVX2
+//g++ ./main.cpp -std=c++14 -O3 -march=skylake-avx512 -o test -DUSE_AVX512
+
+//Test matrix over all x86 backends, run natively on an avx512 capable host
+//or under the Intel Software Development Emulator (sde64 -skx) otherwise,
+//the exit code is non zero as soon as one check fails
+/*
+for isa in "-DUSE_AVX -mavx" "-DUSE_AVX2 -mavx2 -mfma" \
+  "-DUSE_AVX512 -march=skylake-avx512" "-DUSE_AVX512 -march=icelake-server"; do
+  g++ ./main.cpp -std=c++14 -O3 $isa -o test && sde64 -icx -- ./test \
+  > /dev/null || echo "FAILED for $isa"; done
+*/
 
 //export PATH=/opt/android-toolchain/bin:$PATH
 //export CXX=aarch64-linux-android-g++
@@ -40,7 +84,8 @@ template<> const double MyFilter<double,3,3>::Buf[7] = {1.0f,2.0f,3.0f,4.0f,5.0f
 //adb shell /data/local/tmp/test
 
 template<typename T>
-void Checker() {
+bool Checker() {
+  bool allOK = true;
   for (int i = 1; i<=512 ; i++) {
     std::vector<T,PackAllocator<T>> input(i);
     std::vector<T,PackAllocator<T>> output(input.size(),0);
@@ -91,18 +136,326 @@ void Checker() {
     std::fill(output.begin(), output.end(), 0);
     std::fill(control.begin(), control.end(), 0);
 
+    Convolution< MyFilter<T,9,6> >::Convolve( input.data(), output.data(), input.size() );
+    Convolution< MyFilter<T,9,6> >::NaiveConvolve( input.data(), control.data(), 0, input.size(), input.size() );
+    isOK &= std::equal(control.begin(), control.end(), output.begin() );
+
+    //Reset values
+    std::fill(output.begin(), output.end(), 0);
+    std::fill(control.begin(), control.end(), 0);
+
+    //Folded symmetric and antisymmetric filters
+    Convolution< MyFilter<T,3,3,FilterSymmetry::Symmetric> >::Convolve( input.data(), output.data(), input.size() );
+    Convolution< MyFilter<T,3,3,FilterSymmetry::Symmetric> >::NaiveConvolve( input.data(), control.data(), 0, input.size(), input.size() );
+    isOK &= std::equal(control.begin(), control.end(), output.begin() );
+
+    //Reset values
+    std::fill(output.begin(), output.end(), 0);
+    std::fill(control.begin(), control.end(), 0);
+
+    Convolution< MyFilter<T,2,2,FilterSymmetry::Antisymmetric> >::Convolve( input.data(), output.data(), input.size() );
+    Convolution< MyFilter<T,2,2,FilterSymmetry::Antisymmetric> >::NaiveConvolve( input.data(), control.data(), 0, input.size(), input.size() );
+    isOK &= std::equal(control.begin(), control.end(), output.begin() );
+
+    //Reset values
+    std::fill(output.begin(), output.end(), 0);
+    std::fill(control.begin(), control.end(), 0);
+
+    Convolution< MyFilter<T,1,2,FilterSymmetry::Symmetric> >::Convolve( input.data(), output.data(), input.size() );
+    Convolution< MyFilter<T,1,2,FilterSymmetry::Symmetric> >::NaiveConvolve( input.data(), control.data(), 0, input.size(), input.size() );
+    isOK &= std::equal(control.begin(), control.end(), output.begin() );
+
+    //Reset values
+    std::fill(output.begin(), output.end(), 0);
+    std::fill(control.begin(), control.end(), 0);
+
+    Convolution< MyFilter<T,7,7,FilterSymmetry::Symmetric> >::Convolve( input.data(), output.data(), input.size() );
+    Convolution< MyFilter<T,7,7,FilterSymmetry::Symmetric> >::NaiveConvolve( input.data(), control.data(), 0, input.size(), input.size() );
+    isOK &= std::equal(control.begin(), control.end(), output.begin() );
+
+    //Reset values
+    std::fill(output.begin(), output.end(), 0);
+    std::fill(control.begin(), control.end(), 0);
+
+    //Memory policies: unaligned pointers
+    Convolution< MyFilter<T,3,3>,UnalignedMemory,UnalignedMemory >::Convolve( input.data()+1, output.data()+1, input.size()-1 );
+    Convolution< MyFilter<T,3,3> >::NaiveConvolve( input.data()+1, control.data()+1, 0, input.size()-1, input.size()-1 );
+    isOK &= std::equal(control.begin(), control.end(), output.begin() );
+
+    //Reset values
+    std::fill(output.begin(), output.end(), 0);
+    std::fill(control.begin(), control.end(), 0);
+
+    //Memory policies: prefetched loads, non temporal stores
+    Convolution< MyFilter<T,2,2>,PrefetchMemory<>,StreamingMemory >::Convolve( input.data(), output.data(), input.size() );
+    Convolution< MyFilter<T,2,2> >::NaiveConvolve( input.data(), control.data(), 0, input.size(), input.size() );
+    isOK &= std::equal(control.begin(), control.end(), output.begin() );
+
+    //Reset values
+    std::fill(output.begin(), output.end(), 0);
+    std::fill(control.begin(), control.end(), 0);
+
     if (isOK) {
       std::cout << "All tests returned True Value for size "<<i<<std::endl;
     } else {
       std::cout << " WARNING : There may be a bug for size "<<i<<std::endl;
     }
+    allOK &= isOK;
+  }
+  return allOK;
+}
+
+/*
+ * Runtime coefficients: filters built from a buffer must give the very same
+ * results as the compile time ones, whatever their tap sizes
+ */
+template<typename T>
+bool RuntimeChecker() {
+  bool allOK = true;
+  const std::vector<std::pair<int,int>> supports = {{0,0},{1,1},{0,3},{3,3},
+    {9,6},{2,14},{15,15},{7,0},{10,11},{0,16},{0,30},{30,0},{4,26}};
+  for (int i = 1; i<=256 ; i++) {
+    std::vector<T,PackAllocator<T>> input(i);
+    std::vector<T,PackAllocator<T>> output(input.size(),0);
+    std::vector<T,PackAllocator<T>> control(input.size(),0);
+    std::iota(input.begin(), input.end(),1.0f);
+
+    bool isOK = true;
+    RuntimeFilter<Filter<T,3,3>> filter(MyFilter<T,3,3>::Buf);
+    Convolution< RuntimeFilter<Filter<T,3,3>> >::Convolve( filter, input.data(), output.data(), input.size() );
+    Convolution< MyFilter<T,3,3> >::NaiveConvolve( input.data(), control.data(), 0, input.size(), input.size() );
+    isOK &= std::equal(control.begin(), control.end(), output.begin() );
+
+    //Dispatched supports, centered, asymmetric and causal
+    for (const auto& support : supports) {
+      std::vector<T> coefficients(support.first+support.second+1);
+      std::iota(coefficients.begin(), coefficients.end(), 1.0f);
+      ConvolutionDispatcher<T> dispatcher(coefficients.data(), support.first,
+        support.second);
+      std::fill(output.begin(), output.end(), 0);
+      std::fill(control.begin(), control.end(), 0);
+      dispatcher.Convolve( input.data(), output.data(), input.size() );
+      for (int j = 0; j < i; j++) {
+        for (int k = 0; k < static_cast<int>(coefficients.size()); k++) {
+          control[j] += coefficients[k]*input[positive_modulo(j+k-support.first,i)];
+        }
+      }
+      isOK &= std::equal(control.begin(), control.end(), output.begin() );
+    }
+
+    if (isOK) {
+      std::cout << "All tests returned True Value for runtime filter size "<<i<<std::endl;
+    } else {
+      std::cout << " WARNING : There may be a bug for runtime filter size "<<i<<std::endl;
+    }
+    allOK &= isOK;
+  }
+  return allOK;
+}
+
+/*
+ * Random signals and coefficients: fused multiply-add and the split of the
+ * taps over several accumulators change the rounding with respect to the
+ * naive version. Both results must stay within the worst case error bound
+ * of a sum of products, TapSize units in the last place of sum(|c_k*x_k|)
+ * each
+ */
+template<typename T, class FILT>
+bool CheckAccuracy(const FILT& filter, int size) {
+  std::vector<T,PackAllocator<T>> input(size);
+  std::vector<T,PackAllocator<T>> output(size,0);
+  std::vector<T,PackAllocator<T>> control(size,0);
+  std::generate(input.begin(), input.end(), []() {
+    return static_cast<T>(rand())/static_cast<T>(RAND_MAX)-static_cast<T>(0.5); });
+
+  Convolution<FILT>::Convolve( filter, input.data(), output.data(), size );
+  Convolution<FILT>::NaiveConvolve( filter, input.data(), control.data(), 0, size, size );
+  bool isOK = true;
+  for (int i = 0; i < size; i++) {
+    T magnitude = 0;
+    for (int k = 0; k < FILT::TapSize; k++) {
+      magnitude += std::abs(filter.Buf[k]*input[positive_modulo(i+k-FILT::TapSizeLeft,size)]);
+    }
+    isOK &= std::abs(output[i]-control[i]) <= 2*FILT::TapSize*std::numeric_limits<T>::epsilon()*magnitude;
+  }
+  return isOK;
+}
+
+template<typename T, int TAP_SIZE_LEFT, int TAP_SIZE_RIGHT>
+bool CheckAccuracy(int size) {
+  std::vector<T> coefficients(TAP_SIZE_LEFT+TAP_SIZE_RIGHT+1);
+  std::generate(coefficients.begin(), coefficients.end(), []() {
+    return static_cast<T>(rand())/static_cast<T>(RAND_MAX)-static_cast<T>(0.5); });
+  typedef RuntimeFilter<Filter<T,TAP_SIZE_LEFT,TAP_SIZE_RIGHT>> FILT;
+  return CheckAccuracy<T>(FILT(coefficients.data()), size);
+}
+
+template<typename T>
+bool AccuracyChecker() {
+  bool allOK = true;
+  for (int i = 1; i<=256 ; i++) {
+    bool isOK = CheckAccuracy<T,1,1>(i);
+    isOK &= CheckAccuracy<T,3,3>(i);
+    isOK &= CheckAccuracy<T,5,4>(i);
+    isOK &= CheckAccuracy<T,7,7>(i);
+    isOK &= CheckAccuracy<T,9,6>(i);
+    isOK &= CheckAccuracy<T,15,15>(i);
+    if (isOK) {
+      std::cout << "All tests returned True Value for accuracy size "<<i<<std::endl;
+    } else {
+      std::cout << " WARNING : There may be a bug for accuracy size "<<i<<std::endl;
+    }
+    allOK &= isOK;
+  }
+  return allOK;
+}
+
+/*
+ * Boundary policies: the border buffers must extend the line as the naive
+ * version, that applies BOUNDARY::Index per tap, including for lines shorter
+ * than the filter, that are extended several times
+ */
+template<typename T, class FILT, class BOUNDARY>
+bool CheckBoundary(int size) {
+  std::vector<T,PackAllocator<T>> input(size+1);
+  std::vector<T,PackAllocator<T>> output(input.size(),0);
+  std::vector<T,PackAllocator<T>> control(input.size(),0);
+  std::iota(input.begin(), input.end(), 1.0f);
+
+  Convolution< FILT,AlignedMemory,AlignedMemory,BOUNDARY >::Convolve( input.data(), output.data(), size );
+  Convolution< FILT,AlignedMemory,AlignedMemory,BOUNDARY >::NaiveConvolve( input.data(), control.data(), 0, size, size );
+  bool isOK = std::equal(control.begin(), control.end(), output.begin() );
+
+  //Unaligned pointers
+  std::fill(output.begin(), output.end(), 0);
+  std::fill(control.begin(), control.end(), 0);
+  Convolution< FILT,UnalignedMemory,UnalignedMemory,BOUNDARY >::Convolve( input.data()+1, output.data()+1, size );
+  Convolution< FILT,AlignedMemory,AlignedMemory,BOUNDARY >::NaiveConvolve( input.data()+1, control.data()+1, 0, size, size );
+  isOK &= std::equal(control.begin(), control.end(), output.begin() );
+  return isOK;
+}
+
+template<typename T, class BOUNDARY>
+bool CheckBoundary(int size) {
+  bool isOK = CheckBoundary<T,MyFilter<T,0,1>,BOUNDARY>(size);
+  isOK &= CheckBoundary<T,MyFilter<T,3,3>,BOUNDARY>(size);
+  isOK &= CheckBoundary<T,MyFilter<T,9,6>,BOUNDARY>(size);
+  isOK &= CheckBoundary<T,MyFilter<T,7,7,FilterSymmetry::Symmetric>,BOUNDARY>(size);
+  return isOK;
+}
+
+template<typename T>
+bool BoundaryChecker() {
+  bool allOK = true;
+  for (int i = 1; i<=256 ; i++) {
+    bool isOK = CheckBoundary<T,MirrorBoundary>(i);
+    isOK &= CheckBoundary<T,ClampBoundary>(i);
+    isOK &= CheckBoundary<T,ZeroBoundary>(i);
+    if (isOK) {
+      std::cout << "All tests returned True Value for boundary size "<<i<<std::endl;
+    } else {
+      std::cout << " WARNING : There may be a bug for boundary size "<<i<<std::endl;
+    }
+    allOK &= isOK;
+  }
+  return allOK;
+}
+
+/*
+ * Integer pixels: results must be bit exact, including rounding and
+ * saturation, with respect to the naive version
+ */
+template<typename T>
+bool IntegerChecker() {
+  bool allOK = true;
+  for (int i = 1; i<=512 ; i++) {
+    std::vector<T,PackAllocator<T>> input(i);
+    std::vector<T,PackAllocator<T>> output(input.size(),0);
+    std::vector<T,PackAllocator<T>> control(input.size(),0);
+
+    //Fill input vector with random values over the whole range of T
+    std::generate(input.begin(), input.end(), []() {
+      return static_cast<T>(rand()); });
+
+    bool isOK = true;
+    Convolution< MyIntegerFilter<T,1,1,4> >::Convolve( input.data(), output.data(), input.size() );
+    Convolution< MyIntegerFilter<T,1,1,4> >::NaiveConvolve( input.data(), control.data(), 0, input.size(), input.size() );
+    isOK &= std::equal(control.begin(), control.end(), output.begin() );
+
+    //Reset values
+    std::fill(output.begin(), output.end(), 0);
+    std::fill(control.begin(), control.end(), 0);
+
+    Convolution< MyIntegerFilter<T,3,3,6> >::Convolve( input.data(), output.data(), input.size() );
+    Convolution< MyIntegerFilter<T,3,3,6> >::NaiveConvolve( input.data(), control.data(), 0, input.size(), input.size() );
+    isOK &= std::equal(control.begin(), control.end(), output.begin() );
+
+    //Reset values
+    std::fill(output.begin(), output.end(), 0);
+    std::fill(control.begin(), control.end(), 0);
+
+    Convolution< MyIntegerFilter<T,9,6,8> >::Convolve( input.data(), output.data(), input.size() );
+    Convolution< MyIntegerFilter<T,9,6,8> >::NaiveConvolve( input.data(), control.data(), 0, input.size(), input.size() );
+    isOK &= std::equal(control.begin(), control.end(), output.begin() );
+
+    //Reset values
+    std::fill(output.begin(), output.end(), 0);
+    std::fill(control.begin(), control.end(), 0);
+
+    Convolution< MyIntegerFilter<T,0,1,0> >::Convolve( input.data(), output.data(), input.size() );
+    Convolution< MyIntegerFilter<T,0,1,0> >::NaiveConvolve( input.data(), control.data(), 0, input.size(), input.size() );
+    isOK &= std::equal(control.begin(), control.end(), output.begin() );
+
+    //Reset values
+    std::fill(output.begin(), output.end(), 0);
+    std::fill(control.begin(), control.end(), 0);
+
+    //Memory policies: unaligned pointers
+    Convolution< MyIntegerFilter<T,3,3,6>,UnalignedMemory,UnalignedMemory >::Convolve( input.data()+1, output.data()+1, input.size()-1 );
+    Convolution< MyIntegerFilter<T,3,3,6> >::NaiveConvolve( input.data()+1, control.data()+1, 0, input.size()-1, input.size()-1 );
+    isOK &= std::equal(control.begin(), control.end(), output.begin() );
+
+    //Reset values
+    std::fill(output.begin(), output.end(), 0);
+    std::fill(control.begin(), control.end(), 0);
+
+    //Runtime coefficients
+    RuntimeFilter<IntegerFilter<T,9,6,8>> filter(MyIntegerFilter<T,9,6,8>::Buf);
+    Convolution< RuntimeFilter<IntegerFilter<T,9,6,8>> >::Convolve( filter, input.data(), output.data(), input.size() );
+    Convolution< MyIntegerFilter<T,9,6,8> >::NaiveConvolve( input.data(), control.data(), 0, input.size(), input.size() );
+    isOK &= std::equal(control.begin(), control.end(), output.begin() );
+
+    //Reset values
+    std::fill(output.begin(), output.end(), 0);
+    std::fill(control.begin(), control.end(), 0);
+
+    //Mirror boundary, as usual for images
+    Convolution< MyIntegerFilter<T,3,3,6>,AlignedMemory,AlignedMemory,MirrorBoundary >::Convolve( input.data(), output.data(), input.size() );
+    Convolution< MyIntegerFilter<T,3,3,6>,AlignedMemory,AlignedMemory,MirrorBoundary >::NaiveConvolve( input.data(), control.data(), 0, input.size(), input.size() );
+    isOK &= std::equal(control.begin(), control.end(), output.begin() );
+
+    if (isOK) {
+      std::cout << "All tests returned True Value for integer size "<<i<<std::endl;
+    } else {
+      std::cout << " WARNING : There may be a bug for integer size "<<i<<std::endl;
+    }
+    allOK &= isOK;
   }
+  return allOK;
 }
 
 int main(int argc, char* argv[]) {
-  Checker<float>();
-  Checker<double>();
-  return EXIT_SUCCESS;
+  bool isOK = Checker<float>();
+  isOK &= Checker<double>();
+  isOK &= RuntimeChecker<float>();
+  isOK &= RuntimeChecker<double>();
+  isOK &= AccuracyChecker<float>();
+  isOK &= AccuracyChecker<double>();
+  isOK &= BoundaryChecker<float>();
+  isOK &= BoundaryChecker<double>();
+  isOK &= IntegerChecker<uint8_t>();
+  isOK &= IntegerChecker<int16_t>();
+  return isOK ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
 /*auto print = [](auto i) { std::cout<<"- "<<i<<" -"; };
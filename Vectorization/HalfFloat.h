@@ -0,0 +1,443 @@
+#ifndef HALFFLOAT_H
+#define HALFFLOAT_H
+
+// STL
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+// Local
+#include "MemoryHelper.h"
+
+/*
+ * 16 bits floating point storage types: computations are always performed
+ * in float, those types only halve the memory footprint of large signals.
+ * - Half: IEEE 754 binary16, 10 bits mantissa, range up to 65504
+ * - BFloat16: upper half of a float, 7 bits mantissa, same range as float
+ * Conversions round to nearest even.
+ * Scalar conversions are only used out of the hot loops, they are written in
+ * plain C++ such that those types are identical whatever the instruction set
+ * a translation unit is compiled for, they thus live out of the
+ * instruction set namespace
+ */
+struct Half {
+  Half() = default;
+  Half( float value ) : bits( FromFloat(value) ) {}
+  operator float() const { return ToFloat(bits); }
+
+  static uint16_t FromFloat( float value ) {
+    uint32_t x;
+    std::memcpy( &x, &value, sizeof(x) );
+    const uint32_t sign = (x >> 16) & 0x8000u;
+    uint32_t absx = x & 0x7FFFFFFFu;
+    if (absx >= 0x7F800000u) {
+      //Infinity, or quiet NaN
+      return sign | 0x7C00u | (absx > 0x7F800000u ? 0x200u : 0u);
+    }
+    if (absx >= 0x477FF000u) {
+      //Rounds to a value above 65504
+      return sign | 0x7C00u;
+    }
+    if (absx < 0x38800000u) {
+      //Subnormal result: adding 0.5 aligns the binary16 subnormal step, 2^-24,
+      //with the float mantissa, and lets the fpu perform the rounding
+      float tmp;
+      std::memcpy( &tmp, &absx, sizeof(tmp) );
+      tmp += 0.5f;
+      std::memcpy( &absx, &tmp, sizeof(absx) );
+      return sign | (absx - 0x3F000000u);
+    }
+    //Normal result: exponent rebias, then round to nearest even
+    const uint32_t odd = (absx >> 13) & 1u;
+    return sign | ((absx - 0x38000000u + 0xFFFu + odd) >> 13);
+  }
+
+  static float ToFloat( uint16_t half ) {
+    const uint32_t sign = static_cast<uint32_t>(half & 0x8000u) << 16;
+    const uint32_t exponent = (half >> 10) & 0x1Fu;
+    const uint32_t mantissa = half & 0x3FFu;
+    uint32_t x;
+    if (exponent == 0x1Fu) {
+      x = sign | 0x7F800000u | (mantissa << 13);
+    } else if (exponent == 0) {
+      //Zero or subnormal, exactly representable as a float product
+      float value = static_cast<float>(mantissa)*(1.f/16777216.f);
+      std::memcpy( &x, &value, sizeof(x) );
+      x |= sign;
+    } else {
+      x = sign | ((exponent + 112u) << 23) | (mantissa << 13);
+    }
+    float value;
+    std::memcpy( &value, &x, sizeof(value) );
+    return value;
+  }
+
+  uint16_t bits;
+};
+
+struct BFloat16 {
+  BFloat16() = default;
+  BFloat16( float value ) : bits( FromFloat(value) ) {}
+  operator float() const { return ToFloat(bits); }
+
+  static uint16_t FromFloat( float value ) {
+    uint32_t x;
+    std::memcpy( &x, &value, sizeof(x) );
+    if ((x & 0x7FFFFFFFu) > 0x7F800000u) {
+      //Keep NaN quiet, rounding could turn it into an infinity
+      return static_cast<uint16_t>((x >> 16) | 0x40u);
+    }
+    return static_cast<uint16_t>((x + 0x7FFFu + ((x >> 16) & 1u)) >> 16);
+  }
+
+  static float ToFloat( uint16_t bfloat ) {
+    const uint32_t x = static_cast<uint32_t>(bfloat) << 16;
+    float value;
+    std::memcpy( &value, &x, sizeof(value) );
+    return value;
+  }
+
+  uint16_t bits;
+};
+
+VECTORIZATION_NAMESPACE_BEGIN
+
+/*
+ * 16 bits floats are processed in float vectors, this also makes
+ * PackAllocator align them on the float vector size
+ */
+template<> struct PackedType<Half> { using type = PackType<float>; };
+template<> struct PackedType<BFloat16> { using type = PackType<float>; };
+
+/*
+ * Conversion through a temporary float buffer, used for masked operations,
+ * and as a fallback when the instruction set lacks conversion instructions
+ */
+template<typename T, class VecT>
+class ConvertingMemOp {
+ public:
+  static VecT load( const T* ptr ) {
+    return maskload( ptr, VecSize );
+  }
+  static void store( T* ptr, VecT value) {
+    maskstore( ptr, value, VecSize );
+  }
+  static VecT maskload( const T* ptr, int count ) {
+    alignas(sizeof(VecT)) float tmp[VecSize] = {};
+    std::copy(ptr, ptr+count, tmp);
+    return VectorizedMemOp<float,VecT>::load( tmp );
+  }
+  static void maskstore( T* ptr, VecT value, int count ) {
+    alignas(sizeof(VecT)) float tmp[VecSize];
+    VectorizedMemOp<float,VecT>::store( tmp, value );
+    std::copy(tmp, tmp+count, ptr);
+  }
+  static void fence() {}
+ protected:
+  constexpr static int VecSize = sizeof(VecT)/sizeof(float);
+};
+
+template<class VecT>
+class VectorizedMemOp<Half,VecT,AlignedMemory> :
+  public ConvertingMemOp<Half,VecT> {};
+template<class VecT>
+class VectorizedMemOp<BFloat16,VecT,AlignedMemory> :
+  public ConvertingMemOp<BFloat16,VecT> {};
+
+/*
+ * Non temporal stores are only provided along with vectorized conversions,
+ * below: the converting fallback would silently store through the cache,
+ * streaming is thus refused there, except for the scalar backend, where
+ * all the policies behave as the aligned one
+ */
+template<typename T, class VecT>
+class UnsupportedStreamingMemOp :
+    public VectorizedMemOp<T,VecT,AlignedMemory> {
+  static_assert(sizeof(VecT) == sizeof(float), "No non temporal stores of "
+    "16 bits floats for this instruction set (binary16 needs -mf16c)");
+};
+template<class VecT>
+class VectorizedMemOp<Half,VecT,StreamingMemory> :
+  public UnsupportedStreamingMemOp<Half,VecT> {};
+template<class VecT>
+class VectorizedMemOp<BFloat16,VecT,StreamingMemory> :
+  public UnsupportedStreamingMemOp<BFloat16,VecT> {};
+
+/*
+ * A vector of VecSize 16 bits floats is half the size of the float vector,
+ * aligned accesses thus only require an alignment on sizeof(VecT)/2.
+ * binary16 conversions need f16c (-mf16c, implied by -march=haswell), bf16
+ * ones are performed with integer instructions: the float upper half is
+ * rounded to nearest even, NaNs with a full mantissa are not preserved.
+ * Streaming stores use movnti for the 8 bytes of a 128 bits vector, and
+ * movntdq otherwise
+ */
+#ifdef USE_AVX
+#ifdef __F16C__
+template<>
+class VectorizedMemOp<Half,__m128> : public ConvertingMemOp<Half,__m128> {
+ public:
+  static __m128 load( const Half* ptr ) {
+    return _mm_cvtph_ps( _mm_loadl_epi64(
+      reinterpret_cast<const __m128i*>(ptr) ) );
+  }
+  static void store( Half* ptr, __m128 value) {
+    _mm_storel_epi64( reinterpret_cast<__m128i*>(ptr), Narrow( value ) );
+  }
+ protected:
+  static __m128i Narrow( __m128 value ) {
+    return _mm_cvtps_ph( value, _MM_FROUND_TO_NEAREST_INT );
+  }
+};
+template<>
+class VectorizedMemOp<Half,__m128,StreamingMemory> :
+    public VectorizedMemOp<Half,__m128,AlignedMemory> {
+ public:
+  static void store( Half* ptr, __m128 value) {
+    _mm_stream_si64( reinterpret_cast<long long*>(ptr),
+      _mm_cvtsi128_si64( Narrow( value ) ) );
+  }
+  static void fence() {
+    _mm_sfence();
+  }
+};
+#endif //__F16C__
+template<>
+class VectorizedMemOp<BFloat16,__m128> :
+    public ConvertingMemOp<BFloat16,__m128> {
+ public:
+  static __m128 load( const BFloat16* ptr ) {
+    return _mm_castsi128_ps( _mm_unpacklo_epi16( _mm_setzero_si128(),
+      _mm_loadl_epi64( reinterpret_cast<const __m128i*>(ptr) ) ) );
+  }
+  static void store( BFloat16* ptr, __m128 value) {
+    _mm_storel_epi64( reinterpret_cast<__m128i*>(ptr), Narrow( value ) );
+  }
+ protected:
+  static __m128i Narrow( __m128 value ) {
+    __m128i bits = _mm_castps_si128( value );
+    __m128i odd = _mm_and_si128( _mm_srli_epi32( bits, 16 ),
+      _mm_set1_epi32(1) );
+    bits = _mm_srli_epi32( _mm_add_epi32( bits,
+      _mm_add_epi32( odd, _mm_set1_epi32(0x7FFF) ) ), 16 );
+    return _mm_packus_epi32( bits, bits );
+  }
+};
+template<>
+class VectorizedMemOp<BFloat16,__m128,StreamingMemory> :
+    public VectorizedMemOp<BFloat16,__m128,AlignedMemory> {
+ public:
+  static void store( BFloat16* ptr, __m128 value) {
+    _mm_stream_si64( reinterpret_cast<long long*>(ptr),
+      _mm_cvtsi128_si64( Narrow( value ) ) );
+  }
+  static void fence() {
+    _mm_sfence();
+  }
+};
+#elif defined USE_AVX2
+#ifdef __F16C__
+template<>
+class VectorizedMemOp<Half,__m256> : public ConvertingMemOp<Half,__m256> {
+ public:
+  static __m256 load( const Half* ptr ) {
+    return _mm256_cvtph_ps( _mm_load_si128(
+      reinterpret_cast<const __m128i*>(ptr) ) );
+  }
+  static void store( Half* ptr, __m256 value) {
+    _mm_store_si128( reinterpret_cast<__m128i*>(ptr), Narrow( value ) );
+  }
+ protected:
+  static __m128i Narrow( __m256 value ) {
+    return _mm256_cvtps_ph( value, _MM_FROUND_TO_NEAREST_INT );
+  }
+};
+template<>
+class VectorizedMemOp<Half,__m256,UnalignedMemory> :
+    public VectorizedMemOp<Half,__m256,AlignedMemory> {
+ public:
+  static __m256 load( const Half* ptr ) {
+    return _mm256_cvtph_ps( _mm_loadu_si128(
+      reinterpret_cast<const __m128i*>(ptr) ) );
+  }
+  static void store( Half* ptr, __m256 value) {
+    _mm_storeu_si128( reinterpret_cast<__m128i*>(ptr), Narrow( value ) );
+  }
+};
+template<>
+class VectorizedMemOp<Half,__m256,StreamingMemory> :
+    public VectorizedMemOp<Half,__m256,AlignedMemory> {
+ public:
+  static void store( Half* ptr, __m256 value) {
+    _mm_stream_si128( reinterpret_cast<__m128i*>(ptr), Narrow( value ) );
+  }
+  static void fence() {
+    _mm_sfence();
+  }
+};
+#endif //__F16C__
+template<>
+class VectorizedMemOp<BFloat16,__m256> :
+    public ConvertingMemOp<BFloat16,__m256> {
+ public:
+  static __m256 load( const BFloat16* ptr ) {
+    return Widen( _mm_load_si128( reinterpret_cast<const __m128i*>(ptr) ) );
+  }
+  static void store( BFloat16* ptr, __m256 value) {
+    _mm_store_si128( reinterpret_cast<__m128i*>(ptr), Narrow( value ) );
+  }
+ protected:
+  static __m256 Widen( __m128i value ) {
+    return _mm256_castsi256_ps( _mm256_slli_epi32(
+      _mm256_cvtepu16_epi32( value ), 16 ) );
+  }
+  static __m128i Narrow( __m256 value ) {
+    __m256i bits = _mm256_castps_si256( value );
+    __m256i odd = _mm256_and_si256( _mm256_srli_epi32( bits, 16 ),
+      _mm256_set1_epi32(1) );
+    bits = _mm256_srli_epi32( _mm256_add_epi32( bits,
+      _mm256_add_epi32( odd, _mm256_set1_epi32(0x7FFF) ) ), 16 );
+    return _mm_packus_epi32( _mm256_castsi256_si128( bits ),
+      _mm256_extracti128_si256( bits, 1 ) );
+  }
+};
+template<>
+class VectorizedMemOp<BFloat16,__m256,UnalignedMemory> :
+    public VectorizedMemOp<BFloat16,__m256,AlignedMemory> {
+ public:
+  static __m256 load( const BFloat16* ptr ) {
+    return Widen( _mm_loadu_si128( reinterpret_cast<const __m128i*>(ptr) ) );
+  }
+  static void store( BFloat16* ptr, __m256 value) {
+    _mm_storeu_si128( reinterpret_cast<__m128i*>(ptr), Narrow( value ) );
+  }
+};
+template<>
+class VectorizedMemOp<BFloat16,__m256,StreamingMemory> :
+    public VectorizedMemOp<BFloat16,__m256,AlignedMemory> {
+ public:
+  static void store( BFloat16* ptr, __m256 value) {
+    _mm_stream_si128( reinterpret_cast<__m128i*>(ptr), Narrow( value ) );
+  }
+  static void fence() {
+    _mm_sfence();
+  }
+};
+#elif defined USE_AVX512
+template<>
+class VectorizedMemOp<Half,__m512> : public ConvertingMemOp<Half,__m512> {
+ public:
+  static __m512 load( const Half* ptr ) {
+    return _mm512_cvtph_ps( _mm256_load_si256(
+      reinterpret_cast<const __m256i*>(ptr) ) );
+  }
+  static void store( Half* ptr, __m512 value) {
+    _mm256_store_si256( reinterpret_cast<__m256i*>(ptr), Narrow( value ) );
+  }
+#if defined __AVX512BW__ && defined __AVX512VL__
+  static __m512 maskload( const Half* ptr, int count ) {
+    return _mm512_cvtph_ps( _mm256_maskz_loadu_epi16( Mask(count), ptr ) );
+  }
+  static void maskstore( Half* ptr, __m512 value, int count ) {
+    _mm256_mask_storeu_epi16( ptr, Mask(count), Narrow( value ) );
+  }
+#endif
+ protected:
+  static __m256i Narrow( __m512 value ) {
+    return _mm512_cvtps_ph( value,
+      _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC );
+  }
+  static __mmask16 Mask( int count ) {
+    return static_cast<__mmask16>((1u<<count)-1u);
+  }
+};
+template<>
+class VectorizedMemOp<Half,__m512,UnalignedMemory> :
+    public VectorizedMemOp<Half,__m512,AlignedMemory> {
+ public:
+  static __m512 load( const Half* ptr ) {
+    return _mm512_cvtph_ps( _mm256_loadu_si256(
+      reinterpret_cast<const __m256i*>(ptr) ) );
+  }
+  static void store( Half* ptr, __m512 value) {
+    _mm256_storeu_si256( reinterpret_cast<__m256i*>(ptr), Narrow( value ) );
+  }
+};
+template<>
+class VectorizedMemOp<Half,__m512,StreamingMemory> :
+    public VectorizedMemOp<Half,__m512,AlignedMemory> {
+ public:
+  static void store( Half* ptr, __m512 value) {
+    _mm256_stream_si256( reinterpret_cast<__m256i*>(ptr), Narrow( value ) );
+  }
+  static void fence() {
+    _mm_sfence();
+  }
+};
+template<>
+class VectorizedMemOp<BFloat16,__m512> :
+    public ConvertingMemOp<BFloat16,__m512> {
+ public:
+  static __m512 load( const BFloat16* ptr ) {
+    return Widen( _mm256_load_si256( reinterpret_cast<const __m256i*>(ptr) ) );
+  }
+  static void store( BFloat16* ptr, __m512 value) {
+    _mm256_store_si256( reinterpret_cast<__m256i*>(ptr), Narrow( value ) );
+  }
+#if defined __AVX512BW__ && defined __AVX512VL__
+  static __m512 maskload( const BFloat16* ptr, int count ) {
+    return Widen( _mm256_maskz_loadu_epi16( Mask(count), ptr ) );
+  }
+  static void maskstore( BFloat16* ptr, __m512 value, int count ) {
+    _mm256_mask_storeu_epi16( ptr, Mask(count), Narrow( value ) );
+  }
+#endif
+ protected:
+  static __m512 Widen( __m256i value ) {
+    return _mm512_castsi512_ps( _mm512_slli_epi32(
+      _mm512_cvtepu16_epi32( value ), 16 ) );
+  }
+  static __m256i Narrow( __m512 value ) {
+#ifdef __AVX512BF16__
+    //vcvtneps2bf16 also handles NaNs properly
+    return reinterpret_cast<__m256i>( _mm512_cvtneps_pbh( value ) );
+#else
+    __m512i bits = _mm512_castps_si512( value );
+    __m512i odd = _mm512_and_si512( _mm512_srli_epi32( bits, 16 ),
+      _mm512_set1_epi32(1) );
+    bits = _mm512_srli_epi32( _mm512_add_epi32( bits,
+      _mm512_add_epi32( odd, _mm512_set1_epi32(0x7FFF) ) ), 16 );
+    return _mm512_cvtepi32_epi16( bits );
+#endif
+  }
+  static __mmask16 Mask( int count ) {
+    return static_cast<__mmask16>((1u<<count)-1u);
+  }
+};
+template<>
+class VectorizedMemOp<BFloat16,__m512,UnalignedMemory> :
+    public VectorizedMemOp<BFloat16,__m512,AlignedMemory> {
+ public:
+  static __m512 load( const BFloat16* ptr ) {
+    return Widen( _mm256_loadu_si256(
+      reinterpret_cast<const __m256i*>(ptr) ) );
+  }
+  static void store( BFloat16* ptr, __m512 value) {
+    _mm256_storeu_si256( reinterpret_cast<__m256i*>(ptr), Narrow( value ) );
+  }
+};
+template<>
+class VectorizedMemOp<BFloat16,__m512,StreamingMemory> :
+    public VectorizedMemOp<BFloat16,__m512,AlignedMemory> {
+ public:
+  static void store( BFloat16* ptr, __m512 value) {
+    _mm256_stream_si256( reinterpret_cast<__m256i*>(ptr), Narrow( value ) );
+  }
+  static void fence() {
+    _mm_sfence();
+  }
+};
+#endif
+
+VECTORIZATION_NAMESPACE_END
+#endif //HALFFLOAT_H
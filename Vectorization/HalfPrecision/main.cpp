@@ -0,0 +1,143 @@
+/*
+ * main.cpp
+ *
+ *  Created on: 16 oct. 2026
+ *      Author: gnthibault
+ */
+
+//STL
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+//Local
+#include "../Convolution.h"
+
+/*
+ * Size of the benchmarked line, way larger than the last level cache, such
+ * that the convolution is bound by the memory bandwidth
+ */
+#define LARGESIZE (1<<25)
+#define NRUN 10
+
+/*
+ * 1D convolutions are memory bound: a 7 taps filter performs 14 flops per
+ * element, for 8 bytes of float traffic. Storing the signal as 16 bits floats
+ * halves this traffic, while the filter still accumulates in float registers,
+ * VectorizedMemOp converting on load and store.
+ * This example checks the Half and BFloat16 paths against the float one, then
+ * compares their runtimes on a large line
+ */
+
+template<> const float MyFilter<float,3,3>::Buf[7] = {1.f/64.f,6.f/64.f,
+  15.f/64.f,20.f/64.f,15.f/64.f,6.f/64.f,1.f/64.f};
+template<> const float MyFilter<float,2,1>::Buf[4] = {-0.5f,1.5f,0.25f,-0.25f};
+
+//build with (f16c is needed for hardware binary16 conversions)
+//g++ ./main.cpp -std=c++14 -O3 -mavx -mf16c -o test -DUSE_AVX
+//g++ ./main.cpp -std=c++14 -O3 -mavx2 -mfma -mf16c -o test -DUSE_AVX2
+//g++ ./main.cpp -std=c++14 -O3 -march=skylake-avx512 -o test -DUSE_AVX512
+//g++ ./main.cpp -std=c++14 -O3 -march=cooperlake -o test -DUSE_AVX512
+
+/*
+ * Convolve a 16 bits signal, and compare with the float convolution of the
+ * same values, rounded to the storage type: only the final rounding may
+ * differ, by at most one unit in the last place
+ */
+template<class FILT, typename STORAGE_T, class POLICY=AlignedMemory,
+  class STORE_POLICY=POLICY>
+bool CheckStorage(int size, int offset, float ulp) {
+  std::vector<STORAGE_T,PackAllocator<STORAGE_T>> input(size+offset);
+  std::vector<STORAGE_T,PackAllocator<STORAGE_T>> output(size+offset);
+  std::vector<float,PackAllocator<float>> reference(size);
+  std::vector<float,PackAllocator<float>> control(size,0.f);
+  for (int i = 0; i < size+offset; i++) {
+    input[i] = static_cast<float>(rand())/static_cast<float>(RAND_MAX)-0.5f;
+  }
+  std::copy(input.begin()+offset, input.end(), reference.begin());
+
+  Convolution<FILT,POLICY,STORE_POLICY>::Convolve(input.data()+offset,
+    output.data()+offset, size);
+  Convolution<FILT>::NaiveConvolve(reference.data(), control.data(), 0, size,
+    size);
+  return std::equal(control.cbegin(), control.cend(), output.cbegin()+offset,
+    [ulp](float ref, STORAGE_T out) {
+      return std::abs(static_cast<float>(out)-ref) <=
+        ulp*std::max(std::abs(ref),1e-3f); });
+}
+
+template<typename IN_T, typename OUT_T>
+double TimeConvolve(const IN_T* in, OUT_T* out, int size) {
+  double msec=std::numeric_limits<double>::max();
+  for (int k = 0; k < NRUN; k++) {
+    auto start = std::chrono::steady_clock::now();
+    Convolution<MyFilter<float,3,3>>::Convolve(in, out, size);
+    auto stop = std::chrono::steady_clock::now();
+    msec = std::min(msec,
+      std::chrono::duration<double, std::milli>(stop-start).count());
+  }
+  return msec;
+}
+
+void Report(const char* name, double msec, double refMsec, int bytesPerElt) {
+  std::cout << "Runtime for " << name << " convolution is " << msec
+    << " msec, " << static_cast<double>(LARGESIZE)*bytesPerElt/msec*1e-6
+    << " GB/s, speedup " << refMsec/msec << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  //binary16 has a 11 bits significand, bfloat16 a 8 bits one
+  const float halfUlp = 1.f/1024.f;
+  const float bfloatUlp = 1.f/128.f;
+  bool isOK = true;
+  for (int size = 1; size <= 512; size++) {
+    isOK &= CheckStorage<MyFilter<float,3,3>,Half>(size, 0, halfUlp);
+    isOK &= CheckStorage<MyFilter<float,2,1>,Half>(size, 0, halfUlp);
+    isOK &= CheckStorage<MyFilter<float,3,3>,Half,UnalignedMemory>(size, 1,
+      halfUlp);
+    isOK &= CheckStorage<MyFilter<float,3,3>,BFloat16>(size, 0, bfloatUlp);
+    isOK &= CheckStorage<MyFilter<float,2,1>,BFloat16>(size, 0, bfloatUlp);
+    isOK &= CheckStorage<MyFilter<float,3,3>,BFloat16,UnalignedMemory>(size,
+      1, bfloatUlp);
+    //Non temporal stores, where the instruction set provides them
+#ifndef USE_NEON
+#if !(defined USE_AVX || defined USE_AVX2) || defined __F16C__
+    isOK &= CheckStorage<MyFilter<float,3,3>,Half,AlignedMemory,
+      StreamingMemory>(size, 0, halfUlp);
+#endif
+    isOK &= CheckStorage<MyFilter<float,3,3>,BFloat16,AlignedMemory,
+      StreamingMemory>(size, 0, bfloatUlp);
+#endif
+  }
+  if (isOK) {
+    std::cout << "All half precision tests returned True Value" << std::endl;
+  } else {
+    std::cout << " WARNING : There may be a bug in half precision"
+      << std::endl;
+  }
+
+  std::vector<float,PackAllocator<float>> floatIn(LARGESIZE, 1.f);
+  std::vector<float,PackAllocator<float>> floatOut(LARGESIZE);
+  std::vector<Half,PackAllocator<Half>> halfIn(LARGESIZE, Half(1.f));
+  std::vector<Half,PackAllocator<Half>> halfOut(LARGESIZE);
+  std::vector<BFloat16,PackAllocator<BFloat16>> bfloatIn(LARGESIZE,
+    BFloat16(1.f));
+  std::vector<BFloat16,PackAllocator<BFloat16>> bfloatOut(LARGESIZE);
+
+  //Bandwidth accounts for one read and one write per element
+  double refMsec = TimeConvolve(floatIn.data(), floatOut.data(), LARGESIZE);
+  Report("float", refMsec, refMsec, 2*sizeof(float));
+  Report("Half", TimeConvolve(halfIn.data(), halfOut.data(), LARGESIZE),
+    refMsec, 2*sizeof(Half));
+  Report("BFloat16", TimeConvolve(bfloatIn.data(), bfloatOut.data(),
+    LARGESIZE), refMsec, 2*sizeof(BFloat16));
+  //Mixed precision: 16 bits input, float output
+  Report("Half to float", TimeConvolve(halfIn.data(), floatOut.data(),
+    LARGESIZE), refMsec, sizeof(Half)+sizeof(float));
+
+  return isOK ? EXIT_SUCCESS : EXIT_FAILURE;
+}
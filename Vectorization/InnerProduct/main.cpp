@@ -8,29 +8,43 @@
 
 //STD
 #include <cstdlib>
-#include <chrono>
 #include <vector>
 #include <iostream>
 #include <algorithm>
 #include <functional>
+#include <numeric>
 
 //boost
 #include <boost/align/aligned_allocator.hpp>
 
 //Local
-#define USE_SSE
 #include "../vectorization.h"
+#include "../MemoryHelper.h"
+#include "../Reduce.h"
+#include "../../Profiling/Benchmark.h"
 
 
-#define NRUN 100
 #define SIZE 524288
 //#define SIZE 8
 
-//g++ ./main.cpp -O3 -std=c++11 -msse2 -ffast-math -o test
+typedef PackType<float> VecT;
+constexpr int VecSize = sizeof(VecT)/sizeof(float);
+
+//Vector types are not known to openmp reductions
+#if defined USE_AVX || defined USE_AVX2 || defined USE_AVX512 || defined USE_NEON
+#pragma omp declare reduction(+: VecT: omp_out += omp_in) \
+	initializer(omp_priv = VecT())
+#endif
+
+//g++ ./main.cpp -O3 -std=c++14 -msse4.1 -DUSE_AVX -ffast-math -fopenmp -o test
+//g++ ./main.cpp -O3 -std=c++14 -mavx2 -mfma -DUSE_AVX2 -ffast-math -fopenmp -o test
+//./test --json innerproduct.json
 int main( int argc, char* argv[] )
 {
-	std::vector<float,boost::alignment::aligned_allocator<float> > floatVec0(SIZE,2);
-	std::vector<float,boost::alignment::aligned_allocator<float> > floatVec1(SIZE,2);
+	BenchmarkRunner runner( argc, argv );
+
+	std::vector<float,boost::alignment::aligned_allocator<float,64> > floatVec0(SIZE,2);
+	std::vector<float,boost::alignment::aligned_allocator<float,64> > floatVec1(SIZE,2);
 
 	for( int i = 0; i < SIZE; i++ )
 	{
@@ -38,48 +52,37 @@ int main( int argc, char* argv[] )
 		floatVec1.at(i) = static_cast <float> (rand()) / (static_cast <float> (RAND_MAX/10));;
 	}
 
-	auto start = std::chrono::steady_clock::now();
-	auto stop = std::chrono::steady_clock::now();
-	auto diff = stop-start;
-	double msec=std::numeric_limits<double>::max();
+	//Each iteration reads both vectors, and performs a multiply and an add
+	const double bytes = 2.0*SIZE*sizeof(float);
+	const double flops = 2.0*SIZE;
 
 	float reference = 0;
-	for(int k = 0; k< NRUN; k++)
+	double refMsec = runner.Run( "std::inner_product", [&]()
 	{
-		start = std::chrono::steady_clock::now();
 		reference = std::inner_product(floatVec0.begin(), floatVec0.end(), floatVec1.begin(), 0.0f);
-		stop = std::chrono::steady_clock::now();
-		diff = stop - start;
-		msec = std::min( msec, std::chrono::duration<double, std::milli>(diff).count());
-	}
-	double refMsec = msec;
-	std::cout << "Runtime for std::inner version is "<< msec << " msec "<< std::endl;
-	msec=std::numeric_limits<double>::max();
+		DoNotOptimize( reference );
+	}, bytes, flops ).median;
 
 	float resultat = 0;
-	for(int k = 0; k< NRUN; k++)
+	double msec = runner.Run( "vectorized inner product", [&]()
 	{
-		start = std::chrono::steady_clock::now();
-		__m128 accumulator = {0.0f,0.0f,0.0f,0.0f};
+		VecT accumulator = VecT();
 
 		//Mixing both vectorization and thread level parallelization
 		#pragma omp parallel for reduction(+:accumulator)
-		for( int i=0; i<SIZE; i+= 128/(sizeof(float)*8) )// 128 bits sse2 / (float = 4 octets * 8 bits par octets)
+		for( int i=0; i<SIZE; i+= VecSize )
 		{
-			accumulator +=	VectorizedMemOp<float,__m128>::load(floatVec0.data()+i) *
-					VectorizedMemOp<float,__m128>::load(floatVec1.data()+i);
+			accumulator +=	VectorizedMemOp<float,VecT>::load(floatVec0.data()+i) *
+					VectorizedMemOp<float,VecT>::load(floatVec1.data()+i);
 		}
-		resultat = VectorSum<float,__m128>::ReduceSum( accumulator );
-		stop = std::chrono::steady_clock::now();
-		diff = stop - start;
-		msec = std::min( msec, std::chrono::duration<double, std::milli>(diff).count());
-	}
+		resultat = VectorSum<float,VecT>::ReduceSum( accumulator );
+		DoNotOptimize( resultat );
+	}, bytes, flops ).median;
 	std::cout << "Speedup for vectorized version is "<< refMsec/msec << std::endl;
-	msec=std::numeric_limits<double>::max();
 
 	std::cout << "Resultat attendu : "<< reference << " Resultat Obtenu : "<< resultat << std::endl;
 
 	//std::for_each( floatDst.cbegin(), floatDst.cend(), [](const float& val){std::cout<<val<<std::endl;});
 
-	return EXIT_SUCCESS;
+	return runner.Finish() ? EXIT_SUCCESS : EXIT_FAILURE;
 }
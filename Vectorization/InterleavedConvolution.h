@@ -0,0 +1,218 @@
+#ifndef INTERLEAVEDCONVOLUTION_H
+#define INTERLEAVEDCONVOLUTION_H
+
+//STL
+#include <algorithm>
+#include <array>
+#include <type_traits>
+#include <vector>
+
+//Local
+#include "Convolution.h"
+
+VECTORIZATION_NAMESPACE_BEGIN
+
+/*
+ * Sum of the taps of a channel, for an output vector whose first tap is
+ * element PREFETCH_BEGIN_IDX of the window: tap k of the channel is
+ * NB_CHANNEL*k elements further, coefs[k] holds the coefficient of tap k of
+ * the channel of each lane
+ */
+template<typename T, int NB_CHANNEL, int PREFETCH_BEGIN_IDX, int SUPPORT_IDX>
+class InterleavedAccumulator {
+public:
+  template<class WINDOW>
+  static PackType<T> Accumulate(const WINDOW& prefetch,
+      const PackType<T>* coefs) {
+    //Recursive call over all previous index of filter support
+    PackType<T> accumulator = InterleavedAccumulator<T,NB_CHANNEL,
+      PREFETCH_BEGIN_IDX,SUPPORT_IDX-1>::Accumulate(prefetch, coefs);
+    return accumulator + coefs[SUPPORT_IDX]*ConvolutionShifter<T,
+      PREFETCH_BEGIN_IDX,NB_CHANNEL*SUPPORT_IDX>::generateNewVec(prefetch);
+  }
+};
+
+//Partial template specialization for iteration 0 of the loop
+template<typename T, int NB_CHANNEL, int PREFETCH_BEGIN_IDX>
+class InterleavedAccumulator<T,NB_CHANNEL,PREFETCH_BEGIN_IDX,0> {
+public:
+  template<class WINDOW>
+  static PackType<T> Accumulate(const WINDOW& prefetch,
+      const PackType<T>* coefs) {
+    return coefs[0]*ConvolutionShifter<T,PREFETCH_BEGIN_IDX,0>::
+      generateNewVec(prefetch);
+  }
+};
+
+/*
+ * Convolution of the NB_CHANNEL channels of an interleaved line, such as
+ * RGB pixels, IQ samples or stereo frames, straight from the interleaved
+ * layout: each channel is convolved with its own coefficients, as
+ * Convolution<FILT,...,BOUNDARY_POLICY> would on the channel alone, and the
+ * outputs are written interleaved, with no split into planes.
+ * The line is seen as n*NB_CHANNEL elements, where tap k of an output is
+ * NB_CHANNEL*k elements away, and an output vector mixes the channels. Its
+ * lanes follow the channel pattern of its first element, that repeats every
+ * NB_CHANNEL vectors, such that vectors are computed by groups of
+ * NB_CHANNEL, one per pattern, each with its own coefficient vectors, that
+ * hold the coefficient of the channel of each lane.
+ * Each group loads the window that covers the taps of its vectors once,
+ * every tap is then taken from it by ConvolutionShifter. Blocks near the
+ * ends of the line are extended frame by frame as given by BOUNDARY_POLICY.
+ * Symmetries of FILT are not exploited, all the taps are summed
+ */
+template<class FILT, int NB_CHANNEL, class BOUNDARY_POLICY=PeriodicBoundary>
+class InterleavedConvolution {
+public:
+  static_assert(NB_CHANNEL >= 1, "At least one channel");
+  static_assert(std::is_floating_point<typename FILT::ScalarType>::value,
+    "InterleavedConvolution needs floating point filters");
+  typedef typename FILT::ScalarType T;
+  typedef typename FILT::VectorType VecT;
+  constexpr static int VecSize = FILT::VecSize;
+  constexpr static int TapSize = FILT::TapSize;
+  //Elements of a group of vectors, one per channel pattern
+  constexpr static int GroupSize = NB_CHANNEL*VecSize;
+  //Number of elements per block, a multiple of GroupSize
+  constexpr static int BlockSize = 32*GroupSize;
+
+  //Same static coefficients for all channels, in and out hold n frames of
+  //NB_CHANNEL elements each
+  static void Convolve(const T* in, T* out, const int n) {
+    std::array<const typename FILT::CoefficientType*,NB_CHANNEL> bufs;
+    bufs.fill(FILT::Buf);
+    ConvolveLine(bufs, in, out, n);
+  }
+
+  //Filter with runtime coefficients, see RuntimeFilter, for all channels
+  static void Convolve(const FILT& filter, const T* in, T* out, const int n) {
+    std::array<const typename FILT::CoefficientType*,NB_CHANNEL> bufs;
+    bufs.fill(filter.Buf);
+    ConvolveLine(bufs, in, out, n);
+  }
+
+  //One filter per channel, filters holds NB_CHANNEL of them
+  static void ConvolveChannels(const FILT* filters, const T* in, T* out,
+      const int n) {
+    std::array<const typename FILT::CoefficientType*,NB_CHANNEL> bufs;
+    for (int c = 0; c < NB_CHANNEL; c++) {
+      bufs[c] = filters[c].Buf;
+    }
+    ConvolveLine(bufs, in, out, n);
+  }
+
+protected:
+  typedef VectorizedMemOp<T,VecT,UnalignedMemory> MemOp;
+  //Whole vectors of the window before and after the ones of the group
+  constexpr static int LeftVec =
+    (NB_CHANNEL*FILT::TapSizeLeft+VecSize-1)/VecSize;
+  constexpr static int RightVec =
+    (NB_CHANNEL*FILT::TapSizeRight+VecSize-1)/VecSize;
+  //Element of the window that holds the first tap of the group
+  constexpr static int PrefetchBeginIdx =
+    LeftVec*VecSize-NB_CHANNEL*FILT::TapSizeLeft;
+  //Vectors loaded per group
+  constexpr static int GroupCardinality = LeftVec+NB_CHANNEL+RightVec;
+
+  static void ConvolveLine(const std::array<
+      const typename FILT::CoefficientType*,NB_CHANNEL>& bufs, const T* in,
+      T* out, const int n) {
+    if (n <= 0) {
+      return;
+    }
+    PERF_SCOPE("InterleavedConvolution::Convolve");
+    //Coefficients of vector p of a group, whose lane j is an element of
+    //channel (p*VecSize+j)%NB_CHANNEL
+    VecT coefs[NB_CHANNEL*TapSize];
+    alignas(sizeof(VecT)) T lanes[VecSize];
+    for (int p = 0; p < NB_CHANNEL; p++) {
+      for (int k = 0; k < TapSize; k++) {
+        for (int j = 0; j < VecSize; j++) {
+          lanes[j] = bufs[(p*VecSize+j)%NB_CHANNEL][k];
+        }
+        coefs[p*TapSize+k] = MemOp::load(lanes);
+      }
+    }
+    const int size = n*NB_CHANNEL;
+    std::vector<T> extended;
+    for (int first = 0; first < size; first += BlockSize) {
+      const int blockSize = std::min(BlockSize, size-first);
+      const int nbGroup = (blockSize+GroupSize-1)/GroupSize;
+      //Windows of all the groups of the block
+      const int begin = first-LeftVec*VecSize;
+      const int srcSize = nbGroup*GroupSize+(LeftVec+RightVec)*VecSize;
+      const T* src;
+      if (begin < 0 || begin+srcSize > size) {
+        extended.resize(srcSize);
+        Extend(in, n, begin, extended.data(), srcSize);
+        src = extended.data();
+      } else {
+        src = in+begin;
+      }
+      for (int g = 0; g < nbGroup; g++) {
+        VecT window[GroupCardinality];
+        for (int v = 0; v < GroupCardinality; v++) {
+          window[v] = MemOp::load(src+g*GroupSize+v*VecSize);
+        }
+        ProcessGroup(coefs, PrefetchWindow<VecT,GroupCardinality,0>(window),
+          out+first+g*GroupSize, blockSize-g*GroupSize,
+          std::integral_constant<int,0>());
+      }
+    }
+  }
+
+  /*
+   * Vectors PHASE to NB_CHANNEL-1 of a group, of which count elements, at
+   * most, are written
+   */
+  template<class WINDOW, int PHASE>
+  static void ProcessGroup(const VecT* coefs, const WINDOW& prefetch, T* out,
+      const int count, std::integral_constant<int,PHASE>) {
+    const int remaining = count-PHASE*VecSize;
+    if (remaining <= 0) {
+      return;
+    }
+    const VecT result = InterleavedAccumulator<T,NB_CHANNEL,
+      PrefetchBeginIdx+PHASE*VecSize,TapSize-1>::Accumulate(prefetch,
+      coefs+PHASE*TapSize);
+    if (remaining >= VecSize) {
+      MemOp::store(out+PHASE*VecSize, result);
+    } else {
+      MemOp::maskstore(out+PHASE*VecSize, result, remaining);
+    }
+    ProcessGroup(coefs, prefetch, out, count,
+      std::integral_constant<int,PHASE+1>());
+  }
+
+  template<class WINDOW>
+  static void ProcessGroup(const VecT*, const WINDOW&, T*, const int,
+      std::integral_constant<int,NB_CHANNEL>) {}
+
+  /*
+   * Elements [first,first+size) of the interleaved line extended frame by
+   * frame: element x is channel x mod NB_CHANNEL of the frame that
+   * BOUNDARY_POLICY gives for frame floor(x/NB_CHANNEL)
+   */
+  static void Extend(const T* in, const int n, const int first, T* dst,
+      const int size) {
+    const int lineSize = n*NB_CHANNEL;
+    const int begin = std::min(std::max(first, 0), first+size);
+    const int end = std::max(std::min(first+size, lineSize), begin);
+    for (int x = first; x < begin; x++) {
+      dst[x-first] = ExtendedElement(in, n, x);
+    }
+    std::copy(in+begin, in+end, dst+begin-first);
+    for (int x = end; x < first+size; x++) {
+      dst[x-first] = ExtendedElement(in, n, x);
+    }
+  }
+
+  static T ExtendedElement(const T* in, const int n, const int x) {
+    const int channel = positive_modulo(x, NB_CHANNEL);
+    const int frame = BOUNDARY_POLICY::Index((x-channel)/NB_CHANNEL, n);
+    return frame < 0 ? T(0) : in[frame*NB_CHANNEL+channel];
+  }
+};
+
+VECTORIZATION_NAMESPACE_END
+#endif //INTERLEAVEDCONVOLUTION_H
@@ -0,0 +1,168 @@
+/*
+ * main.cpp
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: gnthibault
+ */
+
+//STL
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//Local
+#include "../InterleavedConvolution.h"
+#include "../../Profiling/Benchmark.h"
+
+/*
+ * Stereo, RGB and RGBA lines, each channel having its own filter, must give
+ * the outputs of Convolution on each channel alone, for all boundaries and
+ * for lines shorter than the filters. The interleaved convolution is then
+ * timed against a split into planes, one Convolve per plane, and a merge
+ */
+template<> const float MyFilter<float,3,3>::Buf[7] = {-1.f/16.f,0.f,
+  9.f/16.f,1.f,9.f/16.f,0.f,-1.f/16.f};
+
+#define NBFRAME (1024*1024)
+
+//build with
+//g++ ./main.cpp -std=c++14 -O3 -mavx2 -mfma -o test -DUSE_AVX2
+//g++ ./main.cpp -std=c++14 -O3 -march=skylake-avx512 -o test -DUSE_AVX512
+//./test --json interleavedconvolution.json
+
+//Dyadic coefficients, such that sums of small integers are exact
+template<class FILT>
+FILT RandomFilter() {
+  typedef typename FILT::ScalarType T;
+  std::vector<T> coefficients(FILT::TapSize);
+  std::generate(coefficients.begin(), coefficients.end(), []() {
+    return static_cast<T>(rand()%129-64)/T(64); });
+  return FILT(coefficients.data());
+}
+
+template<class FILT, int NB_CHANNEL, class BOUNDARY>
+bool Check(int n) {
+  typedef typename FILT::ScalarType T;
+  std::vector<FILT> filters;
+  for (int c = 0; c < NB_CHANNEL; c++) {
+    filters.push_back(RandomFilter<FILT>());
+  }
+  std::vector<T> in(n*NB_CHANNEL);
+  std::generate(in.begin(), in.end(), []() {
+    return static_cast<T>(rand()%16-8); });
+
+  //Reference, channel by channel
+  std::vector<T> control(n*NB_CHANNEL);
+  std::vector<T> plane(n), planeOut(n);
+  for (int c = 0; c < NB_CHANNEL; c++) {
+    for (int i = 0; i < n; i++) {
+      plane[i] = in[i*NB_CHANNEL+c];
+    }
+    std::fill(planeOut.begin(), planeOut.end(), T(0));
+    Convolution<FILT,UnalignedMemory,UnalignedMemory,BOUNDARY>::
+      NaiveConvolve(filters[c], plane.data(), planeOut.data(), 0, n, n);
+    for (int i = 0; i < n; i++) {
+      control[i*NB_CHANNEL+c] = planeOut[i];
+    }
+  }
+
+  //One more element, that must not be written
+  std::vector<T> out(n*NB_CHANNEL+1, T(-1));
+  InterleavedConvolution<FILT,NB_CHANNEL,BOUNDARY>::ConvolveChannels(
+    filters.data(), in.data(), out.data(), n);
+  return std::equal(control.begin(), control.end(), out.begin()) &&
+    out.back() == T(-1);
+}
+
+template<class FILT, int NB_CHANNEL>
+bool CheckBoundaries() {
+  bool isOK = true;
+  for (int n : {1, 2, 5, 17, 100, 1000, 5000}) {
+    isOK &= Check<FILT,NB_CHANNEL,PeriodicBoundary>(n) &&
+      Check<FILT,NB_CHANNEL,MirrorBoundary>(n) &&
+      Check<FILT,NB_CHANNEL,ClampBoundary>(n) &&
+      Check<FILT,NB_CHANNEL,ZeroBoundary>(n);
+  }
+  return isOK;
+}
+
+//Static coefficients, shared by all channels
+template<int NB_CHANNEL>
+bool CheckStatic(int n) {
+  typedef MyFilter<float,3,3> FILT;
+  std::vector<float> in(n*NB_CHANNEL);
+  std::generate(in.begin(), in.end(), []() {
+    return static_cast<float>(rand()%16-8); });
+  std::vector<float> control(n*NB_CHANNEL, 0.f);
+  std::vector<float> out(n*NB_CHANNEL);
+  typedef RuntimeFilter<Filter<float,3,3>> Runtime;
+  std::vector<Runtime> filters(NB_CHANNEL, Runtime(FILT::Buf));
+  InterleavedConvolution<Runtime,NB_CHANNEL>::ConvolveChannels(
+    filters.data(), in.data(), control.data(), n);
+  InterleavedConvolution<FILT,NB_CHANNEL>::Convolve(in.data(), out.data(), n);
+  return control == out;
+}
+
+template<int NB_CHANNEL>
+void Benchmark(BenchmarkRunner& runner, const std::string& layout) {
+  typedef MyFilter<float,3,3> FILT;
+  std::vector<float,PackAllocator<float>> in(NBFRAME*NB_CHANNEL);
+  std::vector<float,PackAllocator<float>> out(NBFRAME*NB_CHANNEL);
+  std::vector<float,PackAllocator<float>> planes(NBFRAME*NB_CHANNEL);
+  std::vector<float,PackAllocator<float>> planesOut(NBFRAME*NB_CHANNEL);
+  std::generate(in.begin(), in.end(), []() {
+    return static_cast<float>(rand())/static_cast<float>(RAND_MAX); });
+  const double bytes = 2.*sizeof(float)*NBFRAME*NB_CHANNEL;
+  const double flops = (2.*FILT::TapSize-1.)*NBFRAME*NB_CHANNEL;
+  const double refMsec = runner.Run(layout+", split into planes", [&]() {
+      for (int i = 0; i < NBFRAME; i++) {
+        for (int c = 0; c < NB_CHANNEL; c++) {
+          planes[c*NBFRAME+i] = in[i*NB_CHANNEL+c];
+        }
+      }
+      for (int c = 0; c < NB_CHANNEL; c++) {
+        Convolution<FILT>::Convolve(planes.data()+c*NBFRAME,
+          planesOut.data()+c*NBFRAME, NBFRAME);
+      }
+      for (int i = 0; i < NBFRAME; i++) {
+        for (int c = 0; c < NB_CHANNEL; c++) {
+          out[i*NB_CHANNEL+c] = planesOut[c*NBFRAME+i];
+        }
+      }
+      ClobberMemory();
+    }, bytes, flops).median;
+  const double msec = runner.Run(layout+", interleaved", [&]() {
+      InterleavedConvolution<FILT,NB_CHANNEL>::Convolve(in.data(),
+        out.data(), NBFRAME);
+      ClobberMemory();
+    }, bytes, flops).median;
+  std::cout << "Speedup of interleaved " << layout << " convolution is "
+    << refMsec/msec << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  bool isOK = CheckBoundaries<RuntimeFilter<Filter<float,3,3>>,2>() &&
+    CheckBoundaries<RuntimeFilter<Filter<float,2,4>>,3>() &&
+    CheckBoundaries<RuntimeFilter<Filter<float,1,1>>,4>() &&
+    CheckBoundaries<RuntimeFilter<Filter<float,0,5>>,3>() &&
+    CheckBoundaries<RuntimeFilter<Filter<float,9,9>>,5>() &&
+    CheckBoundaries<RuntimeFilter<Filter<double,3,3>>,2>() &&
+    CheckBoundaries<RuntimeFilter<Filter<double,2,1>>,3>() &&
+    CheckBoundaries<RuntimeFilter<Filter<float,2,2>>,1>() &&
+    CheckStatic<3>(1000);
+  if (isOK) {
+    std::cout << "All interleaved convolution tests returned True Value"
+      << std::endl;
+  } else {
+    std::cout << " WARNING : There may be a bug in interleaved convolution"
+      << std::endl;
+  }
+
+  BenchmarkRunner runner(argc, argv);
+  Benchmark<2>(runner, "stereo");
+  Benchmark<3>(runner, "RGB");
+  Benchmark<4>(runner, "RGBA");
+  return runner.Finish() && isOK ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,175 @@
+#ifndef INTERPOLATINGCONVOLUTION_H
+#define INTERPOLATINGCONVOLUTION_H
+
+//STL
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+//Local
+#include "Convolution.h"
+#include "UpsampledConcatAndCut.h"
+
+VECTORIZATION_NAMESPACE_BEGIN
+
+/*
+ * Upsampling by FACTOR with zero insertion, followed by a convolution, that
+ * only computes the non zero taps: the line of n elements is extended by
+ * BOUNDARY_POLICY, then upsampled into u, u[FACTOR*i] = in[i] and zeros in
+ * between, and out[j] = sum over k of Buf[k]*u[j+k-TapSizeLeft], for j in
+ * [0,UpsampledSize(n)).
+ * Polyphase decomposition: output phase p, out[FACTOR*i+p], only sees the
+ * taps k such that p+k-TapSizeLeft is a multiple of FACTOR, that apply to
+ * in[i+(p+k-TapSizeLeft)/FACTOR], such that each input vector costs
+ * TapSize multiply-adds for FACTOR output vectors.
+ * The phases of a vector of inputs are interleaved in registers with
+ * DyadicMerge for FACTOR 2 when it exists for the vector type, and through
+ * a small buffer otherwise
+ */
+template<class FILT, int FACTOR, class BOUNDARY_POLICY=PeriodicBoundary>
+class InterpolatingConvolution {
+public:
+  static_assert(FACTOR >= 1, "Interpolation factor must be positive");
+  static_assert(std::is_floating_point<typename FILT::ScalarType>::value,
+    "InterpolatingConvolution needs floating point filters");
+  typedef typename FILT::ScalarType T;
+  typedef typename FILT::VectorType VecT;
+  constexpr static int VecSize = FILT::VecSize;
+  constexpr static int TapSize = FILT::TapSize;
+  //Number of inputs per block, a multiple of VecSize
+  constexpr static int BlockSize = 64*VecSize;
+
+  //Number of outputs of a line of n elements
+  static int UpsampledSize(const int n) {
+    return FACTOR*n;
+  }
+
+  //out must hold UpsampledSize(n) elements, it may not be aligned
+  static void Convolve(const T* in, T* out, const int n) {
+    ConvolveLine(FILT::Buf, in, out, n);
+  }
+
+  //Filter with runtime coefficients, see RuntimeFilter
+  static void Convolve(const FILT& filter, const T* in, T* out, const int n) {
+    ConvolveLine(filter.Buf, in, out, n);
+  }
+
+protected:
+  typedef VectorizedMemOp<T,VecT,UnalignedMemory> MemOp;
+  //Range of the inputs that contribute to the outputs of in[i], relative
+  //to i: in[i+MinOffset] for out[FACTOR*i] and in[i+MaxOffset] for
+  //out[FACTOR*i+FACTOR-1]
+  constexpr static int MinOffset = -(FILT::TapSizeLeft/FACTOR);
+  constexpr static int MaxOffset = (FACTOR-1+FILT::TapSizeRight)/FACTOR;
+  //Inputs of a block, and their padding to whole vectors
+  constexpr static int WindowSize = BlockSize+MaxOffset-MinOffset;
+  constexpr static int WindowPitch = (WindowSize+VecSize-1)/VecSize*VecSize;
+
+  static void ConvolveLine(const typename FILT::CoefficientType* buf,
+      const T* in, T* out, const int n) {
+    if (n <= 0) {
+      return;
+    }
+    PERF_SCOPE("InterpolatingConvolution::Convolve");
+    VecT coefs[TapSize];
+    for (int k = 0; k < TapSize; k++) {
+      coefs[k] = VecT() + buf[k];
+    }
+    std::vector<T,PackAllocator<T>> window(WindowPitch, T(0));
+    for (int first = 0; first < n; first += BlockSize) {
+      const int blockSize = std::min(BlockSize, n-first);
+      //Inputs of the block, extended by BOUNDARY_POLICY near the ends of
+      //the line, and for the last block, whose loads may go beyond
+      const int begin = first+MinOffset;
+      const T* src;
+      if (begin < 0 || first+BlockSize+MaxOffset > n) {
+        const int size = blockSize+MaxOffset-MinOffset;
+        BOUNDARY_POLICY::Extend(in, n, begin, window.data(), size);
+        std::fill(window.begin()+size, window.end(), T(0));
+        src = window.data();
+      } else {
+        src = in+begin;
+      }
+      ConvolveBlock(coefs, src-MinOffset, out+FACTOR*first, blockSize,
+        std::integral_constant<bool,
+          FACTOR == 2 && DyadicMerge<T,VecT>::Vectorized>());
+    }
+  }
+
+  //Phases interleaved in registers
+  static void ConvolveBlock(const VecT* coefs, const T* src, T* out,
+      const int blockSize, std::true_type) {
+    for (int i = 0; i < blockSize; i += VecSize) {
+      VecT low, high;
+      DyadicMerge<T,VecT>::Merge(PhaseSum<0>(coefs, src+i),
+        PhaseSum<1>(coefs, src+i), low, high);
+      const int count = 2*(blockSize-i);
+      if (count >= 2*VecSize) {
+        MemOp::store(out+2*i, low);
+        MemOp::store(out+2*i+VecSize, high);
+      } else if (count > VecSize) {
+        MemOp::store(out+2*i, low);
+        MemOp::maskstore(out+2*i+VecSize, high, count-VecSize);
+      } else {
+        MemOp::maskstore(out+2*i, low, count);
+      }
+    }
+  }
+
+  //Phases interleaved through a buffer
+  static void ConvolveBlock(const VecT* coefs, const T* src, T* out,
+      const int blockSize, std::false_type) {
+    alignas(sizeof(VecT)) T phases[FACTOR][VecSize];
+    for (int i = 0; i < blockSize; i += VecSize) {
+      StorePhases(coefs, src+i, phases,
+        std::integral_constant<int,FACTOR-1>());
+      const int count = std::min(VecSize, blockSize-i);
+      for (int t = 0; t < count; t++) {
+        for (int p = 0; p < FACTOR; p++) {
+          out[FACTOR*(i+t)+p] = phases[p][t];
+        }
+      }
+    }
+  }
+
+  template<int PHASE>
+  static void StorePhases(const VecT* coefs, const T* src,
+      T phases[FACTOR][VecSize], std::integral_constant<int,PHASE>) {
+    VectorizedMemOp<T,VecT>::store(phases[PHASE],
+      PhaseSum<PHASE>(coefs, src));
+    StorePhases(coefs, src, phases, std::integral_constant<int,PHASE-1>());
+  }
+
+  static void StorePhases(const VecT* coefs, const T* src,
+      T phases[FACTOR][VecSize], std::integral_constant<int,-1>) {}
+
+  //First tap of phase PHASE, TapSize when it has none
+  template<int PHASE>
+  constexpr static int FirstTap() {
+    return ((FILT::TapSizeLeft-PHASE)%FACTOR+FACTOR)%FACTOR;
+  }
+
+  //Outputs of phase PHASE for a vector of inputs, src being the first one
+  template<int PHASE>
+  static VecT PhaseSum(const VecT* coefs, const T* src) {
+    constexpr int first = FirstTap<PHASE>();
+    if (first >= TapSize) {
+      return VecT() + T(0);
+    }
+    VecT acc = coefs[first]*MemOp::load(src+Offset<PHASE>(first));
+    for (int k = first+FACTOR; k < TapSize; k += FACTOR) {
+      acc += coefs[k]*MemOp::load(src+Offset<PHASE>(k));
+    }
+    return acc;
+  }
+
+  //Input of tap k of phase PHASE, relative to the current one, k being one
+  //of the taps of this phase
+  template<int PHASE>
+  constexpr static int Offset(int k) {
+    return (PHASE+k-FILT::TapSizeLeft)/FACTOR;
+  }
+};
+
+VECTORIZATION_NAMESPACE_END
+#endif //INTERPOLATINGCONVOLUTION_H
@@ -0,0 +1,172 @@
+/*
+ * main.cpp
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: gnthibault
+ */
+
+//STL
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//Local
+#include "../InterpolatingConvolution.h"
+#include "../../Profiling/Benchmark.h"
+
+/*
+ * Synthesis filter banks and signal enlargement: UpsampledConcatAndCut is
+ * checked against scalar zero insertion, and InterpolatingConvolution
+ * against the convolution of the zero inserted signal, for factors 1 to 4.
+ * Both are then timed against zero insertion followed by Convolve, on a
+ * line of 32K floats, upsampled to 64K or 128K
+ */
+template<> const float MyFilter<float,1,1>::Buf[3] = {1.f/2.f,1.f,1.f/2.f};
+template<> const float MyFilter<float,3,3>::Buf[7] = {-1.f/16.f,0.f,
+  9.f/16.f,1.f,9.f/16.f,0.f,-1.f/16.f};
+template<> const float MyFilter<float,2,4>::Buf[7] = {-1.f/8.f,2.f/8.f,
+  3.f/8.f,5.f/8.f,-3.f/8.f,1.f/8.f,1.f/8.f};
+template<> const float MyFilter<float,7,7>::Buf[15] = {-5.f/2048.f,0.f,
+  49.f/2048.f,0.f,-245.f/2048.f,0.f,1225.f/2048.f,1.f,1225.f/2048.f,0.f,
+  -245.f/2048.f,0.f,49.f/2048.f,0.f,-5.f/2048.f};
+template<> const double MyFilter<double,3,3>::Buf[7] = {-1./16.,0.,9./16.,1.,
+  9./16.,0.,-1./16.};
+
+#define LINESIZE (32*1024)
+
+//build with
+//g++ ./main.cpp -std=c++14 -O3 -mavx2 -mfma -o test -DUSE_AVX2
+//g++ ./main.cpp -std=c++14 -O3 -march=skylake-avx512 -o test -DUSE_AVX512
+//./test --json interpolating.json
+
+template<typename T, int PHASE>
+bool CheckUpsampled() {
+  typedef PackType<T> VecT;
+  constexpr int VecSize = sizeof(VecT)/sizeof(T);
+  std::vector<T,PackAllocator<T>> in(VecSize);
+  std::vector<T,PackAllocator<T>> out(2*VecSize);
+  std::vector<T> control(2*VecSize, T(0));
+  for (int i = 0; i < VecSize; i++) {
+    in[i] = T(i+1);
+    control[2*i+PHASE] = in[i];
+  }
+  VecT low, high;
+  UpsampledConcatAndCut<T,VecT,PHASE>::Concat(
+    VectorizedMemOp<T,VecT>::load(in.data()), low, high);
+  VectorizedMemOp<T,VecT>::store(out.data(), low);
+  VectorizedMemOp<T,VecT>::store(out.data()+VecSize, high);
+  return std::equal(control.begin(), control.end(), out.begin());
+}
+
+/*
+ * Results must be the convolution of the zero inserted line, extended by
+ * the boundary, for any size, including several blocks and a partial last
+ * vector. Inputs are small integers, such that results are exact with the
+ * dyadic coefficients above, whatever the multiply-adds the compiler fuses
+ */
+template<class FILT, int FACTOR, class BOUNDARY>
+bool Check(int size) {
+  typedef typename FILT::ScalarType T;
+  typedef InterpolatingConvolution<FILT,FACTOR,BOUNDARY> Interpolating;
+  std::vector<T> in(size);
+  std::generate(in.begin(), in.end(), []() {
+    return static_cast<T>(rand()%16); });
+  std::vector<T> control(Interpolating::UpsampledSize(size));
+  for (int j = 0; j < static_cast<int>(control.size()); j++) {
+    T acc = T(0);
+    for (int k = 0; k < FILT::TapSize; k++) {
+      //Upsampled index, floor division for the left border
+      const int u = j+k-FILT::TapSizeLeft;
+      const int i = (u >= 0 ? u : u-FACTOR+1)/FACTOR;
+      const int idx = BOUNDARY::Index(i, size);
+      if (u-FACTOR*i == 0 && idx >= 0) {
+        acc += FILT::Buf[k]*in[idx];
+      }
+    }
+    control[j] = acc;
+  }
+
+  //One more element, that must not be written
+  std::vector<T> out(control.size()+1, T(-1));
+  Interpolating::Convolve(in.data(), out.data(), size);
+  bool isOK = std::equal(control.begin(), control.end(), out.begin()) &&
+    out.back() == T(-1);
+
+  //Runtime coefficients
+  typedef RuntimeFilter<Filter<T,FILT::TapSizeLeft,FILT::TapSizeRight>>
+    Runtime;
+  std::fill(out.begin(), out.end(), T(-1));
+  InterpolatingConvolution<Runtime,FACTOR,BOUNDARY>::Convolve(
+    Runtime(FILT::Buf), in.data(), out.data(), size);
+  isOK &= std::equal(control.begin(), control.end(), out.begin());
+  return isOK;
+}
+
+template<class FILT, int FACTOR>
+bool CheckBoundaries(int size) {
+  return Check<FILT,FACTOR,PeriodicBoundary>(size) &&
+    Check<FILT,FACTOR,MirrorBoundary>(size) &&
+    Check<FILT,FACTOR,ClampBoundary>(size) &&
+    Check<FILT,FACTOR,ZeroBoundary>(size);
+}
+
+template<class FILT>
+bool CheckFactors(int size) {
+  return CheckBoundaries<FILT,1>(size) && CheckBoundaries<FILT,2>(size) &&
+    CheckBoundaries<FILT,3>(size) && CheckBoundaries<FILT,4>(size);
+}
+
+template<class FILT, int FACTOR>
+void Benchmark(BenchmarkRunner& runner) {
+  typedef InterpolatingConvolution<FILT,FACTOR> Interpolating;
+  const int outSize = Interpolating::UpsampledSize(LINESIZE);
+  std::vector<float,PackAllocator<float>> in(LINESIZE);
+  std::vector<float,PackAllocator<float>> upsampled(outSize, 0.f);
+  std::vector<float,PackAllocator<float>> out(outSize);
+  std::generate(in.begin(), in.end(), []() {
+    return static_cast<float>(rand())/static_cast<float>(RAND_MAX); });
+  const double bytes = sizeof(float)*(in.size()+out.size());
+  const double flops = (2.*FILT::TapSize-1.)*in.size();
+  const std::string name = std::to_string(FILT::TapSize)+" taps, factor "+
+    std::to_string(FACTOR);
+  const double refMsec = runner.Run(name+", upsample then convolve", [&]() {
+      for (int i = 0; i < LINESIZE; i++) {
+        upsampled[FACTOR*i] = in[i];
+      }
+      Convolution<FILT>::Convolve(upsampled.data(), out.data(), outSize);
+      ClobberMemory();
+    }, bytes, flops).median;
+  const double msec = runner.Run(name+", polyphase", [&]() {
+      Interpolating::Convolve(in.data(), out.data(), LINESIZE);
+      ClobberMemory();
+    }, bytes, flops).median;
+  std::cout << "Speedup of the polyphase interpolation for " << name
+    << " is " << refMsec/msec << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  bool isOK = CheckUpsampled<float,0>() && CheckUpsampled<float,1>() &&
+    CheckUpsampled<double,0>() && CheckUpsampled<double,1>();
+  for (int size : {1, 2, 3, 7, 16, 33, 100, 1001, 2100}) {
+    isOK &= CheckFactors<MyFilter<float,1,1>>(size);
+    isOK &= CheckFactors<MyFilter<float,3,3>>(size);
+    isOK &= CheckFactors<MyFilter<float,2,4>>(size);
+    isOK &= CheckFactors<MyFilter<float,7,7>>(size);
+    isOK &= CheckFactors<MyFilter<double,3,3>>(size);
+  }
+  if (isOK) {
+    std::cout << "All interpolating tests returned True Value" << std::endl;
+  } else {
+    std::cout << " WARNING : There may be a bug in interpolating convolution"
+      << std::endl;
+  }
+
+  BenchmarkRunner runner(argc, argv);
+  Benchmark<MyFilter<float,3,3>,2>(runner);
+  Benchmark<MyFilter<float,7,7>,2>(runner);
+  Benchmark<MyFilter<float,3,3>,4>(runner);
+  Benchmark<MyFilter<float,7,7>,4>(runner);
+  return runner.Finish() && isOK ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,394 @@
+#ifndef LIFTINGWAVELET_H
+#define LIFTINGWAVELET_H
+
+//STL
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+//Local
+#include "MemoryHelper.h"
+#include "SubsampledConcatAndCut.h"
+#include "UpsampledConcatAndCut.h"
+
+VECTORIZATION_NAMESPACE_BEGIN
+
+/*
+ * Lifting step of a wavelet, on the even samples s and the odd samples d of
+ * a line:
+ * - predict: d[i] += Current*s[i] + Neighbour*s[i+1]
+ * - update: s[i] += Current*d[i] + Neighbour*d[i-1]
+ * Samples beyond the ends are given by a whole sample symmetric extension
+ * of the line, ... c b | a b c ... x y z | y x ..., that is the nearest
+ * sample of the same parity
+ */
+struct LiftingStep {
+  bool Predict;
+  double Current;
+  double Neighbour;
+};
+
+/*
+ * Wavelets, as NbSteps lifting steps, followed by a scaling of the
+ * approximation s by Scale, and of the details d by 1/Scale
+ */
+struct HaarWavelet {
+  constexpr static int NbSteps = 2;
+  constexpr static double Scale = 1.;
+  static LiftingStep Step(int k) {
+    return k == 0 ? LiftingStep{true,-1.,0.} : LiftingStep{false,0.5,0.};
+  }
+};
+
+//Le Gall 5/3, the reversible filter of JPEG 2000
+struct Cdf53Wavelet {
+  constexpr static int NbSteps = 2;
+  constexpr static double Scale = 1.;
+  static LiftingStep Step(int k) {
+    return k == 0 ? LiftingStep{true,-0.5,-0.5} :
+      LiftingStep{false,0.25,0.25};
+  }
+};
+
+//Cohen-Daubechies-Feauveau 9/7, the irreversible filter of JPEG 2000
+struct Cdf97Wavelet {
+  constexpr static int NbSteps = 4;
+  constexpr static double Scale = 1.149604398;
+  static LiftingStep Step(int k) {
+    constexpr double coefs[NbSteps] = {-1.586134342, -0.05298011854,
+      0.8829110762, 0.4435068522};
+    return LiftingStep{k%2 == 0, coefs[k], coefs[k]};
+  }
+};
+
+/*
+ * Multi-level discrete wavelet transform, with the lifting scheme.
+ * A level transforms a line of n samples into its ceil(n/2) approximation
+ * coefficients, followed by its floor(n/2) detail coefficients, the next
+ * level then transforms the approximation only (Mallat layout).
+ * - Forward and Inverse work in place on a line, with a scratch buffer of n
+ *   elements, that is allocated when it is not given. The samples are split
+ *   into even and odd ones with DyadicSplit, and merged back by DyadicMerge
+ * - Forward2D and Inverse2D transform the rows, then the columns of the
+ *   approximation quadrant, at each level. Rows are distributed over OpenMP
+ *   threads, as are strips of ColumnStrip columns, whose lifting steps work
+ *   on whole rows of the strip, such that columns are vectorized as well
+ * Lifting steps are exactly inverted, up to the rounding of floating point
+ * operations
+ */
+template<typename T, class WAVELET>
+class LiftingWavelet {
+public:
+  static_assert(std::is_floating_point<T>::value,
+    "LiftingWavelet needs floating point samples");
+  typedef PackType<T> VecT;
+  constexpr static int VecSize = sizeof(VecT)/sizeof(T);
+  //Number of columns transformed together in the 2D transform
+  constexpr static int ColumnStrip = 32*VecSize;
+
+  //Number of elements of level l of a line of n elements, l=0 being n
+  static int LevelSize(const int n, const int level) {
+    int size = n;
+    for (int l = 0; l < level; l++) {
+      size = (size+1)/2;
+    }
+    return size;
+  }
+
+  static void Forward(T* data, const int n, const int levels,
+      T* scratch=nullptr) {
+    std::vector<T> buffer(scratch == nullptr ? n : 0);
+    T* tmp = scratch == nullptr ? buffer.data() : scratch;
+    for (int level = 0; level < levels; level++) {
+      ForwardLine(data, LevelSize(n, level), tmp);
+    }
+  }
+
+  static void Inverse(T* data, const int n, const int levels,
+      T* scratch=nullptr) {
+    std::vector<T> buffer(scratch == nullptr ? n : 0);
+    T* tmp = scratch == nullptr ? buffer.data() : scratch;
+    for (int level = levels-1; level >= 0; level--) {
+      InverseLine(data, LevelSize(n, level), tmp);
+    }
+  }
+
+  //Image of width x height elements, pitch elements apart from one row to
+  //the next one
+  static void Forward2D(T* data, const int width, const int height,
+      const int pitch, const int levels) {
+    for (int level = 0; level < levels; level++) {
+      const int w = LevelSize(width, level);
+      const int h = LevelSize(height, level);
+      Rows(data, w, h, pitch, false);
+      Columns(data, w, h, pitch, false);
+    }
+  }
+
+  static void Inverse2D(T* data, const int width, const int height,
+      const int pitch, const int levels) {
+    for (int level = levels-1; level >= 0; level--) {
+      const int w = LevelSize(width, level);
+      const int h = LevelSize(height, level);
+      Columns(data, w, h, pitch, true);
+      Rows(data, w, h, pitch, true);
+    }
+  }
+
+protected:
+  typedef VectorizedMemOp<T,VecT,UnalignedMemory> MemOp;
+
+  /*
+   * Applies the lifting steps of WAVELET to ns even and nd odd samples,
+   * through lift(predict,dst,src0,src1,count,c0,c1), that must compute
+   * for t in [0,count):
+   *   dst[dst+t] += c0*src[src0+t] + c1*src[src1+t]
+   * dst being d and src being s when predict is true, and conversely,
+   * and through scale(predict,factor), that scales d, or s, by factor.
+   * Indices beyond the ends are replaced by the nearest valid ones, such
+   * that count elements are always contiguous
+   */
+  template<class LIFT, class SCALE>
+  static void Lifting(const int ns, const int nd, const bool inverse,
+      LIFT lift, SCALE scale) {
+    if (inverse && WAVELET::Scale != 1.) {
+      scale(false, T(1./WAVELET::Scale));
+      scale(true, T(WAVELET::Scale));
+    }
+    for (int k = 0; k < WAVELET::NbSteps; k++) {
+      const LiftingStep step = WAVELET::Step(inverse ?
+        WAVELET::NbSteps-1-k : k);
+      const T c0 = T(inverse ? -step.Current : step.Current);
+      const T c1 = T(inverse ? -step.Neighbour : step.Neighbour);
+      if (step.Predict) {
+        //s[i+1] for i < ns-1, s[ns-1] for the last d of even lines
+        const int count = std::min(nd, ns-1);
+        lift(true, 0, 0, 1, count, c0, c1);
+        if (count < nd) {
+          lift(true, count, count, ns-1, 1, c0, c1);
+        }
+      } else {
+        //d[0] stands for d[-1], and d[nd-1] for d[nd] of odd lines
+        lift(false, 0, 0, 0, 1, c0, c1);
+        lift(false, 1, 1, 0, nd-1, c0, c1);
+        if (ns > nd) {
+          lift(false, nd, nd-1, nd-1, 1, c0, c1);
+        }
+      }
+    }
+    if (!inverse && WAVELET::Scale != 1.) {
+      scale(false, T(WAVELET::Scale));
+      scale(true, T(1./WAVELET::Scale));
+    }
+  }
+
+  //dst[t] += c0*a[t] + c1*b[t], for t in [0,size)
+  static void Lift(T* dst, const T* a, const T* b, const T c0, const T c1,
+      const int size) {
+    const VecT v0 = VecT() + c0;
+    const VecT v1 = VecT() + c1;
+    int t = 0;
+    for (; t+VecSize <= size; t += VecSize) {
+      MemOp::store(dst+t, MemOp::load(dst+t) + v0*MemOp::load(a+t) +
+        v1*MemOp::load(b+t));
+    }
+    if (t < size) {
+      MemOp::maskstore(dst+t, MemOp::maskload(dst+t, size-t) +
+        v0*MemOp::maskload(a+t, size-t) + v1*MemOp::maskload(b+t, size-t),
+        size-t);
+    }
+  }
+
+  static void Scale(T* dst, const T factor, const int size) {
+    const VecT v = VecT() + factor;
+    int t = 0;
+    for (; t+VecSize <= size; t += VecSize) {
+      MemOp::store(dst+t, v*MemOp::load(dst+t));
+    }
+    for (; t < size; t++) {
+      dst[t] *= factor;
+    }
+  }
+
+  //One level on a line: split to scratch, lifting there, then copy back
+  static void ForwardLine(T* data, const int n, T* scratch) {
+    if (n < 2) {
+      return;
+    }
+    const int ns = (n+1)/2;
+    const int nd = n/2;
+    T* s = scratch;
+    T* d = scratch+ns;
+    Split(data, s, d, nd,
+      std::integral_constant<bool,DyadicSplit<T,VecT>::Vectorized>());
+    if (ns > nd) {
+      s[nd] = data[n-1];
+    }
+    Lifting(ns, nd, false, LineLift(s, d), LineScale(s, d, ns, nd));
+    std::copy(scratch, scratch+n, data);
+  }
+
+  //One level on a line: lifting in place, then merge to scratch
+  static void InverseLine(T* data, const int n, T* scratch) {
+    if (n < 2) {
+      return;
+    }
+    const int ns = (n+1)/2;
+    const int nd = n/2;
+    T* s = data;
+    T* d = data+ns;
+    Lifting(ns, nd, true, LineLift(s, d), LineScale(s, d, ns, nd));
+    Merge(s, d, scratch, nd,
+      std::integral_constant<bool,DyadicMerge<T,VecT>::Vectorized>());
+    if (ns > nd) {
+      scratch[n-1] = s[nd];
+    }
+    std::copy(scratch, scratch+n, data);
+  }
+
+  static auto LineLift(T* s, T* d) {
+    return [s,d](bool predict, int dst, int src0, int src1, int count, T c0,
+        T c1) {
+      const T* src = predict ? s : d;
+      Lift((predict ? d : s)+dst, src+src0, src+src1, c0, c1, count);
+    };
+  }
+
+  static auto LineScale(T* s, T* d, int ns, int nd) {
+    return [s,d,ns,nd](bool predict, T factor) {
+      Scale(predict ? d : s, factor, predict ? nd : ns);
+    };
+  }
+
+  //Even and odd elements of the first 2*nbPair elements of in
+  static void Split(const T* in, T* even, T* odd, const int nbPair,
+      std::true_type) {
+    int i = 0;
+    for (; i+VecSize <= nbPair; i += VecSize) {
+      VecT e, o;
+      DyadicSplit<T,VecT>::Split(MemOp::load(in+2*i),
+        MemOp::load(in+2*i+VecSize), e, o);
+      MemOp::store(even+i, e);
+      MemOp::store(odd+i, o);
+    }
+    Split(in+2*i, even+i, odd+i, nbPair-i, std::false_type());
+  }
+
+  static void Split(const T* in, T* even, T* odd, const int nbPair,
+      std::false_type) {
+    for (int i = 0; i < nbPair; i++) {
+      even[i] = in[2*i];
+      odd[i] = in[2*i+1];
+    }
+  }
+
+  static void Merge(const T* even, const T* odd, T* out, const int nbPair,
+      std::true_type) {
+    int i = 0;
+    for (; i+VecSize <= nbPair; i += VecSize) {
+      VecT a, b;
+      DyadicMerge<T,VecT>::Merge(MemOp::load(even+i), MemOp::load(odd+i), a,
+        b);
+      MemOp::store(out+2*i, a);
+      MemOp::store(out+2*i+VecSize, b);
+    }
+    Merge(even+i, odd+i, out+2*i, nbPair-i, std::false_type());
+  }
+
+  static void Merge(const T* even, const T* odd, T* out, const int nbPair,
+      std::false_type) {
+    for (int i = 0; i < nbPair; i++) {
+      out[2*i] = even[i];
+      out[2*i+1] = odd[i];
+    }
+  }
+
+  static void Rows(T* data, const int w, const int h, const int pitch,
+      const bool inverse) {
+    if (w < 2) {
+      return;
+    }
+    #pragma omp parallel
+    {
+      std::vector<T> scratch(w);
+      #pragma omp for schedule(static)
+      for (int y = 0; y < h; y++) {
+        if (inverse) {
+          InverseLine(data+static_cast<std::ptrdiff_t>(y)*pitch, w,
+            scratch.data());
+        } else {
+          ForwardLine(data+static_cast<std::ptrdiff_t>(y)*pitch, w,
+            scratch.data());
+        }
+      }
+    }
+  }
+
+  /*
+   * Columns are lifted in place, row i of s being row 2i of the strip, and
+   * row i of d being row 2i+1, then the rows of d are moved below the ones
+   * of s through a scratch buffer, and conversely for the inverse
+   */
+  static void Columns(T* data, const int w, const int h, const int pitch,
+      const bool inverse) {
+    if (h < 2) {
+      return;
+    }
+    const int ns = (h+1)/2;
+    const int nd = h/2;
+    const int nbStrip = (w+ColumnStrip-1)/ColumnStrip;
+    #pragma omp parallel
+    {
+      std::vector<T> scratch(static_cast<std::size_t>(nd)*ColumnStrip);
+      #pragma omp for schedule(static)
+      for (int strip = 0; strip < nbStrip; strip++) {
+        T* base = data+strip*ColumnStrip;
+        const int width = std::min(ColumnStrip, w-strip*ColumnStrip);
+        auto row = [base,pitch](int i) {
+          return base+static_cast<std::ptrdiff_t>(i)*pitch;
+        };
+        auto lift = [&](bool predict, int dst, int src0, int src1, int count,
+            T c0, T c1) {
+          const int dstParity = predict ? 1 : 0;
+          for (int t = 0; t < count; t++) {
+            Lift(row(2*(dst+t)+dstParity), row(2*(src0+t)+1-dstParity),
+              row(2*(src1+t)+1-dstParity), c0, c1, width);
+          }
+        };
+        auto scale = [&](bool predict, T factor) {
+          for (int i = predict ? 1 : 0; i < h; i += 2) {
+            Scale(row(i), factor, width);
+          }
+        };
+        if (inverse) {
+          for (int i = 0; i < nd; i++) {
+            std::copy(row(ns+i), row(ns+i)+width, scratch.data()+i*width);
+          }
+          for (int i = ns-1; i > 0; i--) {
+            std::copy(row(i), row(i)+width, row(2*i));
+          }
+          for (int i = 0; i < nd; i++) {
+            std::copy(scratch.data()+i*width, scratch.data()+(i+1)*width,
+              row(2*i+1));
+          }
+          Lifting(ns, nd, true, lift, scale);
+        } else {
+          Lifting(ns, nd, false, lift, scale);
+          for (int i = 0; i < nd; i++) {
+            std::copy(row(2*i+1), row(2*i+1)+width, scratch.data()+i*width);
+          }
+          for (int i = 1; i < ns; i++) {
+            std::copy(row(2*i), row(2*i)+width, row(i));
+          }
+          for (int i = 0; i < nd; i++) {
+            std::copy(scratch.data()+i*width, scratch.data()+(i+1)*width,
+              row(ns+i));
+          }
+        }
+      }
+    }
+  }
+};
+
+VECTORIZATION_NAMESPACE_END
+#endif //LIFTINGWAVELET_H
@@ -0,0 +1,207 @@
+/*
+ * main.cpp
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: gnthibault
+ */
+
+//STL
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//Local
+#include "../LiftingWavelet.h"
+#include "../../Profiling/Benchmark.h"
+
+/*
+ * Multi-level wavelet transforms: LiftingWavelet is checked against a
+ * scalar lifting implementation, for lines and images of any size, and for
+ * perfect reconstruction. Throughput of a forward and inverse transform is
+ * then measured, in samples per second, on a line of 256K floats, and on a
+ * 1024x1024 image
+ */
+
+#define LINESIZE (256*1024)
+#define IMAGESIZE 1024
+
+//build with
+//g++ ./main.cpp -std=c++14 -O3 -mavx2 -mfma -fopenmp -o test -DUSE_AVX2
+//g++ ./main.cpp -std=c++14 -O3 -march=skylake-avx512 -fopenmp -o test -DUSE_AVX512
+//OMP_NUM_THREADS=4 ./test --json wavelet.json
+
+//One level on n samples, stride elements apart, with the definition of
+//LiftingStep
+template<typename T, class WAVELET>
+void NaiveForward(T* x, int n, int stride) {
+  if (n < 2) {
+    return;
+  }
+  const int ns = (n+1)/2;
+  const int nd = n/2;
+  std::vector<T> s(ns), d(nd);
+  for (int i = 0; i < n; i++) {
+    (i%2 == 0 ? s[i/2] : d[i/2]) = x[i*stride];
+  }
+  for (int k = 0; k < WAVELET::NbSteps; k++) {
+    const LiftingStep step = WAVELET::Step(k);
+    const T c0 = T(step.Current), c1 = T(step.Neighbour);
+    if (step.Predict) {
+      for (int i = 0; i < nd; i++) {
+        d[i] = d[i] + c0*s[i] + c1*s[std::min(i+1,ns-1)];
+      }
+    } else {
+      for (int i = 0; i < ns; i++) {
+        s[i] = s[i] + c0*d[std::min(i,nd-1)] + c1*d[std::max(i-1,0)];
+      }
+    }
+  }
+  for (int i = 0; i < ns; i++) {
+    x[i*stride] = s[i]*T(WAVELET::Scale);
+  }
+  for (int i = 0; i < nd; i++) {
+    x[(ns+i)*stride] = d[i]*T(1./WAVELET::Scale);
+  }
+}
+
+template<typename T, class WAVELET>
+void NaiveForward2D(T* x, int width, int height, int pitch, int levels) {
+  for (int level = 0; level < levels; level++) {
+    const int w = LiftingWavelet<T,WAVELET>::LevelSize(width, level);
+    const int h = LiftingWavelet<T,WAVELET>::LevelSize(height, level);
+    for (int y = 0; y < h; y++) {
+      NaiveForward<T,WAVELET>(x+y*pitch, w, 1);
+    }
+    for (int c = 0; c < w; c++) {
+      NaiveForward<T,WAVELET>(x+c, h, pitch);
+    }
+  }
+}
+
+/*
+ * Haar and 5/3 coefficients are dyadic, such that their results are exact
+ * for small integer inputs, whatever the multiply-adds the compiler fuses,
+ * 9/7 ones are compared with a tolerance
+ */
+template<typename T>
+bool Near(const std::vector<T>& a, const std::vector<T>& b, T tolerance) {
+  for (size_t i = 0; i < a.size(); i++) {
+    if (std::abs(a[i]-b[i]) > tolerance*(T(1)+std::abs(b[i]))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template<typename T, class WAVELET>
+bool Check(int n, int levels, T tolerance) {
+  typedef LiftingWavelet<T,WAVELET> Wavelet;
+  std::vector<T> in(n);
+  std::generate(in.begin(), in.end(), []() {
+    return static_cast<T>(rand()%16); });
+  std::vector<T> control(in);
+  for (int level = 0; level < levels; level++) {
+    NaiveForward<T,WAVELET>(control.data(), Wavelet::LevelSize(n, level), 1);
+  }
+  std::vector<T> out(in);
+  Wavelet::Forward(out.data(), n, levels);
+  bool isOK = Near(out, control, tolerance);
+  std::vector<T> scratch(n);
+  Wavelet::Inverse(out.data(), n, levels, scratch.data());
+  isOK &= Near(out, in, tolerance);
+  return isOK;
+}
+
+template<typename T, class WAVELET>
+bool Check2D(int width, int height, int pitch, int levels, T tolerance) {
+  typedef LiftingWavelet<T,WAVELET> Wavelet;
+  std::vector<T> in(height*pitch);
+  std::generate(in.begin(), in.end(), []() {
+    return static_cast<T>(rand()%16); });
+  std::vector<T> control(in);
+  NaiveForward2D<T,WAVELET>(control.data(), width, height, pitch, levels);
+  std::vector<T> out(in);
+  Wavelet::Forward2D(out.data(), width, height, pitch, levels);
+  bool isOK = Near(out, control, tolerance);
+  Wavelet::Inverse2D(out.data(), width, height, pitch, levels);
+  isOK &= Near(out, in, tolerance);
+  return isOK;
+}
+
+template<typename T, class WAVELET>
+bool CheckAll(T tolerance) {
+  bool isOK = true;
+  for (int n : {1, 2, 3, 4, 5, 17, 64, 100, 1001}) {
+    for (int levels : {1, 2, 5}) {
+      isOK &= Check<T,WAVELET>(n, levels, tolerance);
+    }
+  }
+  for (int width : {1, 2, 7, 33, 300}) {
+    for (int height : {1, 3, 16, 45}) {
+      isOK &= Check2D<T,WAVELET>(width, height, width, 3, tolerance);
+      isOK &= Check2D<T,WAVELET>(width, height, width+5, 1, tolerance);
+    }
+  }
+  return isOK;
+}
+
+/*
+ * Forward and inverse transforms are timed together, such that the data
+ * repeatedly transformed in place keeps the same range
+ */
+template<class WAVELET>
+void Benchmark(BenchmarkRunner& runner, const std::string& wavelet) {
+  typedef LiftingWavelet<float,WAVELET> Wavelet;
+  std::vector<float> line(LINESIZE);
+  std::vector<float> scratch(LINESIZE);
+  std::generate(line.begin(), line.end(), []() {
+    return static_cast<float>(rand())/static_cast<float>(RAND_MAX); });
+  //Each level of each transform reads and writes the line twice
+  const double bytes = 8.*sizeof(float)*LINESIZE;
+  auto report = [](const std::string& name, double samples, double msec) {
+    std::cout << "Throughput of " << name << " is " << samples/msec/1e3
+      << " Msamples/s" << std::endl;
+  };
+  std::string name = wavelet+", 5 levels, line of "+std::to_string(LINESIZE)+
+    ", forward and inverse";
+  report(name, LINESIZE, runner.Run(name, [&]() {
+      Wavelet::Forward(line.data(), LINESIZE, 5, scratch.data());
+      Wavelet::Inverse(line.data(), LINESIZE, 5, scratch.data());
+      ClobberMemory();
+    }, bytes).median);
+
+  const int size = IMAGESIZE*IMAGESIZE;
+  std::vector<float,PackAllocator<float>> image(size);
+  std::generate(image.begin(), image.end(), []() {
+    return static_cast<float>(rand())/static_cast<float>(RAND_MAX); });
+  name = wavelet+", 3 levels, image of "+std::to_string(IMAGESIZE)+"x"+
+    std::to_string(IMAGESIZE)+", forward and inverse";
+  report(name, size, runner.Run(name, [&]() {
+      Wavelet::Forward2D(image.data(), IMAGESIZE, IMAGESIZE, IMAGESIZE, 3);
+      Wavelet::Inverse2D(image.data(), IMAGESIZE, IMAGESIZE, IMAGESIZE, 3);
+      ClobberMemory();
+    }, 2.*bytes*size/LINESIZE).median);
+}
+
+int main(int argc, char* argv[]) {
+  bool isOK = CheckAll<float,HaarWavelet>(0.f);
+  isOK &= CheckAll<float,Cdf53Wavelet>(0.f);
+  isOK &= CheckAll<float,Cdf97Wavelet>(1e-4f);
+  isOK &= CheckAll<double,Cdf53Wavelet>(0.);
+  isOK &= CheckAll<double,Cdf97Wavelet>(1e-12);
+  if (isOK) {
+    std::cout << "All wavelet tests returned True Value" << std::endl;
+  } else {
+    std::cout << " WARNING : There may be a bug in the wavelet transform"
+      << std::endl;
+  }
+
+  BenchmarkRunner runner(argc, argv);
+  Benchmark<HaarWavelet>(runner, "Haar");
+  Benchmark<Cdf53Wavelet>(runner, "CDF 5/3");
+  Benchmark<Cdf97Wavelet>(runner, "CDF 9/7");
+  return runner.Finish() && isOK ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -7,7 +7,6 @@
 
 //STD
 #include <cstdlib>
-#include <chrono>
 #include <vector>
 #include <iostream>
 #include <algorithm>
@@ -17,14 +16,10 @@
 #include <boost/align/aligned_allocator.hpp>
 
 //Local
-#define USE_SSE
 #include "../vectorization.h"
+#include "../MemoryHelper.h"
 #include "../SimdVec.h"
-
-// forward-declaration to allow use in Iter
-template<typename T> class SimdVec;
-
-#define NRUN 100
+#include "../../Profiling/Benchmark.h"
 
 /*
  * Choose size such that size*4 bytes * 2 < processor cache size
@@ -32,108 +27,152 @@ template<typename T> class SimdVec;
  */
 #define SIZE 262144
 
+/*
+ * Size used to compare regular and non temporal stores, buffers should be
+ * way larger than the last level cache
+ */
+#define LARGESIZE (1<<25)
+
 /*
  * This code perform no computation, instead, it shows how to load and store packs of data, here
- * we used the single floating point type and the SSE2 vectorized instructions
+ * we used the single floating point type and the vectorized instructions selected at compile time,
+ * with the various memory access policies of VectorizedMemOp
  */
 
-//g++ ./main.cpp -std=c++11 -O3 -msse2 -o test
+typedef PackType<float> VecT;
+constexpr int VecSize = sizeof(VecT)/sizeof(float);
+
+//Vectorized copy of size elements, size must be a multiple of VecSize
+template<class LOAD_POLICY, class STORE_POLICY>
+void VectorizedCopy( const float* src, float* dst, int size )
+{
+	for( int i=0; i<size; i+= VecSize )
+	{
+		VectorizedMemOp<float,VecT,STORE_POLICY>::store( dst+i,
+				VectorizedMemOp<float,VecT,LOAD_POLICY>::load(src+i) );
+	}
+	VectorizedMemOp<float,VecT,STORE_POLICY>::fence();
+}
+
+//Check that the copy was performed, then reset the destination
+bool CheckAndReset( float* dst, int size )
+{
+	bool isOK = std::all_of(dst,dst+size,[](float in){return in == 1.f;});
+	std::fill( dst, dst+size, 0.f);
+	return isOK;
+}
+
+//Time the copy, counting one read and one write per element
+template<class LOAD_POLICY, class STORE_POLICY>
+void TimeCopy( BenchmarkRunner& runner, const std::string& name,
+		const float* src, float* dst, int size, bool& isOK )
+{
+	runner.Run( name, [&]() { VectorizedCopy<LOAD_POLICY,STORE_POLICY>( src, dst, size ); },
+			2.0*size*sizeof(float) );
+	isOK &= CheckAndReset( dst, size );
+}
+
+//g++ ./main.cpp -std=c++14 -O3 -msse4.1 -DUSE_AVX -o test
+//g++ ./main.cpp -std=c++14 -O3 -mavx2 -DUSE_AVX2 -o test
+//g++ ./main.cpp -std=c++14 -O3 -march=skylake-avx512 -DUSE_AVX512 -o test
+//./test --cpu 0 --json loadstore.json
 int main( int argc, char* argv[] )
 {
+	BenchmarkRunner runner( argc, argv );
+
 	/*
 	 * In order to be able to use vectorization, one should first ensure that memory is aligned, because
 	 * load and store of pack of data from and to vectorized registers is impossible for unaligned adresses
 	 * and may result in segfault (or not if you are lucky and your operating system always gives you aligned
 	 * memory.
 	 */
-	std::vector<float,boost::alignment::aligned_allocator<float> > floatVec(SIZE,1.f); //SIZE*4octets = 2Mo
-	std::vector<float,boost::alignment::aligned_allocator<float> > floatDst(SIZE,0.f); //SIZE*4octets = 2Mo
-
-	//Initialize timing tools
-	auto start = std::chrono::steady_clock::now();
-	auto stop = std::chrono::steady_clock::now();
-	auto diff = stop-start;
-	double msec=std::numeric_limits<double>::max();
+	std::vector<float,PackAllocator<float> > floatVec(SIZE,1.f); //SIZE*4octets = 2Mo
+	std::vector<float,PackAllocator<float> > floatDst(SIZE,0.f); //SIZE*4octets = 2Mo
+	const double bytes = 2.0*SIZE*sizeof(float);
 
 	//Initialize verification tool
 	bool isOK = true;
 
 	//Good old memcpy
-	for(int k = 0; k< NRUN; k++)
+	runner.Run( "memcpy", [&]()
 	{
-		start = std::chrono::steady_clock::now();
 		memcpy( floatDst.data(), floatVec.data(), floatDst.size()*sizeof(float));
-		stop = std::chrono::steady_clock::now();
-		diff = stop - start;
-		msec = std::min( msec, std::chrono::duration<double, std::micro>(diff).count());
-		//Check if copy was performed
-		isOK &= std::all_of(floatDst.cbegin(),floatDst.cend(),[](float in){return in == 1.f;});
-		//Reset vector to 0 value
-		std::fill( floatDst.begin(), floatDst.end(), 0.f);
-	}
-	std::cout << "Runtime for memcpy version is "<< msec << " µsec "<< std::endl;
-	msec=std::numeric_limits<double>::max();
+	}, bytes );
+	isOK &= CheckAndReset( floatDst.data(), SIZE );
 
 	//The more versatile std::copy
-	for(int k = 0; k< NRUN; k++)
+	runner.Run( "std::copy", [&]()
 	{
-		start = std::chrono::steady_clock::now();
 		std::copy( floatVec.cbegin(), floatVec.cend(), floatDst.begin() );
-		stop = std::chrono::steady_clock::now();
-		diff = stop - start;
-		msec = std::min( msec, std::chrono::duration<double, std::micro>(diff).count());
-		isOK &= std::all_of(floatDst.cbegin(),floatDst.cend(),[](float in){return in == 1.f;});
-		std::fill( floatDst.begin(), floatDst.end(), 0.f);
-	}
-	std::cout << "Runtime for std::copy is "<< msec << " µsec "<< std::endl;
-	msec=std::numeric_limits<double>::max();
+	}, bytes );
+	isOK &= CheckAndReset( floatDst.data(), SIZE );
 
 	//Our homemade vectorized memcpy
-	for(int k = 0; k< NRUN; k++)
+	runner.Run( "vectorized handwritten copy", [&]()
 	{
-		start = std::chrono::steady_clock::now();
 		#pragma unroll
-		for( int i=0; i<SIZE; i+= 128/(sizeof(float)*8) )// 128bits sse2/(1float=4bytes*8bits)
+		for( int i=0; i<SIZE; i+= VecSize )
 		{
-			VectorizedMemOp<float,__m128>::store(
+			VectorizedMemOp<float,VecT>::store(
 					floatDst.data()+i,
-					VectorizedMemOp<float,__m128>::load(floatVec.data()+i) );
+					VectorizedMemOp<float,VecT>::load(floatVec.data()+i) );
 		}
-		stop = std::chrono::steady_clock::now();
-		diff = stop - start;
-		msec = std::min( msec, std::chrono::duration<double, std::micro>(diff).count());
-		isOK &= std::all_of(floatDst.cbegin(),floatDst.cend(),[](float in){return in == 1.f;});
-		std::fill( floatDst.begin(), floatDst.end(), 0.f);
-	}
-	std::cout << "Runtime for vectorized handwritten version is "<< msec << " µsec "<< std::endl;
-	double throughput = ((double)SIZE*sizeof(float))/(1024.0*1024.0*1024.0);
-	throughput /= (msec*1e-6);
-	std::cout << "Memory Throughput in this case is "<< throughput <<" GBytes/sec"<<std::endl;
-	msec=std::numeric_limits<double>::max();
-
+	}, bytes );
+	isOK &= CheckAndReset( floatDst.data(), SIZE );
 
 	//A more functional way to do this copy, using a handwritten container
 	SimdVec<float> sse2VecSrc( SIZE, 1 );
 	SimdVec<float> sse2VecDst( SIZE, 0 );
-	for(int k = 0; k< NRUN; k++)
+	runner.Run( "vectorized functional copy", [&]()
 	{
 		auto dst = sse2VecDst.begin();
-		start = std::chrono::steady_clock::now();
 		for( const auto src : sse2VecSrc )
 		{
 			dst.set( src );
 			dst++;
 		}
-		stop = std::chrono::steady_clock::now();
-		diff = stop - start;
-		msec = std::min( msec, std::chrono::duration<double, std::micro>(diff).count());
-		//Check if copy went well
-		isOK &= std::all_of(sse2VecDst.cscalarbegin(), sse2VecDst.cscalarend(),
-				[](float in){return in == 1.f;} );
-		//Reset inner vector to 0 value
-		std::fill( sse2VecDst.scalarbegin(), sse2VecDst.scalarend(), 0.f);
-	}
-	std::cout << "Runtime for vectorized functional version is "<< msec << " µsec "<< std::endl;
+	}, bytes );
+	//Check if copy went well
+	isOK &= std::all_of(sse2VecDst.cscalarbegin(), sse2VecDst.cscalarend(),
+			[](float in){return in == 1.f;} );
+
+	/*
+	 * Unaligned accesses: with aligned load/store, this would crash (or not...) as soon as the
+	 * pointer is shifted by a single element
+	 */
+	TimeCopy<UnalignedMemory,UnalignedMemory>( runner, "vectorized unaligned copy",
+			floatVec.data()+1, floatDst.data()+1, SIZE-VecSize, isOK );
+
+	//Software prefetch of the source
+	TimeCopy<PrefetchMemory<>,AlignedMemory>( runner, "vectorized prefetching copy",
+			floatVec.data(), floatDst.data(), SIZE, isOK );
+
+	/*
+	 * Non temporal stores only make sense when the destination does not fit in the cache: they
+	 * avoid reading the destination lines before writing them, and do not evict the source
+	 */
+	std::vector<float,PackAllocator<float> > largeSrc(LARGESIZE,1.f);
+	std::vector<float,PackAllocator<float> > largeDst(LARGESIZE,0.f);
+	TimeCopy<AlignedMemory,AlignedMemory>( runner, "large regular copy",
+			largeSrc.data(), largeDst.data(), LARGESIZE, isOK );
+	TimeCopy<AlignedMemory,StreamingMemory>( runner, "large streaming copy",
+			largeSrc.data(), largeDst.data(), LARGESIZE, isOK );
+
+	//Same thing with the container
+	SimdVec<float> largeVecSrc( LARGESIZE, 1 );
+	SimdVec<float,StreamingMemory> largeVecDst( LARGESIZE, 0 );
+	runner.Run( "large streaming functional copy", [&]()
+	{
+		auto dst = largeVecDst.begin();
+		for( auto src = largeVecSrc.cbegin(); src != largeVecSrc.cend(); ++src )
+		{
+			dst.set( *src );
+			dst++;
+		}
+		largeVecDst.fence();
+	}, 2.0*LARGESIZE*sizeof(float) );
+	isOK &= std::all_of(largeVecDst.cscalarbegin(), largeVecDst.cscalarend(),
+			[](float in){return in == 1.f;} );
 
 	if(isOK)
 	{
@@ -143,6 +182,5 @@ int main( int argc, char* argv[] )
 		std::cout << "WARNING: not all copy were OK !" << std::endl;
 	}
 
-
-	return EXIT_SUCCESS;
+	return isOK && runner.Finish() ? EXIT_SUCCESS : EXIT_FAILURE;
 }
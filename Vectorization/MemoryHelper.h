@@ -1,20 +1,98 @@
 #ifndef MEMORYHELPER_H
 #define MEMORYHELPER_H
 
+// STL
+#include <algorithm>
+
 // Local
 #include "MetaHelper.h"
 #include "vectorization.h"
 
-//Default implementation work for non-vectorized case
+VECTORIZATION_NAMESPACE_BEGIN
+
+/*
+ * Memory access policies for VectorizedMemOp:
+ * - AlignedMemory: pointers must be aligned on the vector size
+ * - UnalignedMemory: any pointer to an element is valid
+ * - StreamingMemory: aligned loads, and non temporal stores that go to
+ *   DRAM without polluting the cache, usefull for large outputs that are not
+ *   read again soon. fence() must be called before other threads read them
+ * - PrefetchMemory: aligned accesses, and each load also issues a software
+ *   prefetch DISTANCE bytes ahead of the loaded address
+ */
+struct AlignedMemory {};
+struct UnalignedMemory {};
+struct StreamingMemory {};
+template<int DISTANCE=512>
+struct PrefetchMemory {};
+
+/*
+ * Policies that are not specialized for a given vector type behave as the
+ * aligned one, this is only the case when aligned and unaligned accesses
+ * are the same (scalar, neon)
+ */
+template<typename T, class VecT, class POLICY=AlignedMemory>
+class VectorizedMemOp : public VectorizedMemOp<T,VecT,AlignedMemory> {};
+
+/*
+ * Default implementation work for non-vectorized case
+ * maskload only loads the count first elements of a vector, the other ones
+ * are set to zero, and maskstore only writes the count first elements.
+ * Masked out elements are never accessed, such that they can be used to
+ * process the end of a buffer that is not a multiple of the vector size,
+ * whatever its alignment
+ */
 template<typename T, class VecT>
-class VectorizedMemOp {
+class VectorizedMemOp<T,VecT,AlignedMemory> {
  public:
   static VecT load( const T* ptr ) {
     return *ptr;
   }
-  static void store( float* ptr, VecT value) {
+  static void store( T* ptr, VecT value) {
     *ptr = value;
   }
+  static VecT maskload( const T* ptr, int count ) {
+    return count > 0 ? *ptr : 0;
+  }
+  static void maskstore( T* ptr, VecT value, int count ) {
+    if (count > 0) {
+      *ptr = value;
+    }
+  }
+  //Make non temporal stores visible, nothing to do for regular stores
+  static void fence() {}
+};
+
+template<typename T, class VecT, int DISTANCE>
+class VectorizedMemOp<T,VecT,PrefetchMemory<DISTANCE>> :
+    public VectorizedMemOp<T,VecT,AlignedMemory> {
+ public:
+  static VecT load( const T* ptr ) {
+    //read access, keep in all cache levels
+    __builtin_prefetch( reinterpret_cast<const char*>(ptr)+DISTANCE, 0, 3 );
+    return VectorizedMemOp<T,VecT,AlignedMemory>::load( ptr );
+  }
+};
+
+/*
+ * Fallback for instruction sets that lack masked memory operations:
+ * elements are inserted one by one through a temporary aligned buffer
+ */
+template<typename T, class VecT>
+class ScalarInsertMemOp {
+ public:
+  static VecT maskload( const T* ptr, int count ) {
+    alignas(sizeof(VecT)) T tmp[VecSize] = {};
+    std::copy(ptr, ptr+count, tmp);
+    return VectorizedMemOp<T,VecT>::load( tmp );
+  }
+  static void maskstore( T* ptr, VecT value, int count ) {
+    alignas(sizeof(VecT)) T tmp[VecSize];
+    VectorizedMemOp<T,VecT>::store( tmp, value );
+    std::copy(tmp, tmp+count, ptr);
+  }
+ protected:
+  constexpr static int VecSize = sizeof(VecT)/sizeof(T);
 };
 
 #ifdef USE_AVX
@@ -27,6 +105,49 @@ class VectorizedMemOp<float,__m128> {
   static void store( float* ptr, __m128 value) {
     _mm_store_ps( ptr, value );
   }
+  static void fence() {}
+#ifdef __AVX__
+  static __m128 maskload( const float* ptr, int count ) {
+    return _mm_maskload_ps( ptr, Mask(count) );
+  }
+  static void maskstore( float* ptr, __m128 value, int count ) {
+    _mm_maskstore_ps( ptr, Mask(count), value );
+  }
+ protected:
+  //Sign bit of the count first elements is set
+  static __m128i Mask( int count ) {
+    return _mm_cmpgt_epi32( _mm_set1_epi32(count), _mm_setr_epi32(0,1,2,3) );
+  }
+#else
+  static __m128 maskload( const float* ptr, int count ) {
+    return ScalarInsertMemOp<float,__m128>::maskload( ptr, count );
+  }
+  static void maskstore( float* ptr, __m128 value, int count ) {
+    ScalarInsertMemOp<float,__m128>::maskstore( ptr, value, count );
+  }
+#endif
+};
+template<>
+class VectorizedMemOp<float,__m128,UnalignedMemory> :
+    public VectorizedMemOp<float,__m128,AlignedMemory> {
+ public:
+  static __m128 load( const float* ptr ) {
+    return _mm_loadu_ps( ptr );
+  }
+  static void store( float* ptr, __m128 value) {
+    _mm_storeu_ps( ptr, value );
+  }
+};
+template<>
+class VectorizedMemOp<float,__m128,StreamingMemory> :
+    public VectorizedMemOp<float,__m128,AlignedMemory> {
+ public:
+  static void store( float* ptr, __m128 value) {
+    _mm_stream_ps( ptr, value );
+  }
+  static void fence() {
+    _mm_sfence();
+  }
 };
 template<>
 class VectorizedMemOp<double,__m128d> {
@@ -37,6 +158,92 @@ class VectorizedMemOp<double,__m128d> {
   static void store( double* ptr, __m128d value) {
     _mm_store_pd( ptr, value );
   }
+  static void fence() {}
+#ifdef __AVX__
+  static __m128d maskload( const double* ptr, int count ) {
+    return _mm_maskload_pd( ptr, Mask(count) );
+  }
+  static void maskstore( double* ptr, __m128d value, int count ) {
+    _mm_maskstore_pd( ptr, Mask(count), value );
+  }
+ protected:
+  //Both 32 bits halves of a 64 bits element share the same mask value
+  static __m128i Mask( int count ) {
+    return _mm_cmpgt_epi32( _mm_set1_epi32(count), _mm_setr_epi32(0,0,1,1) );
+  }
+#else
+  static __m128d maskload( const double* ptr, int count ) {
+    return ScalarInsertMemOp<double,__m128d>::maskload( ptr, count );
+  }
+  static void maskstore( double* ptr, __m128d value, int count ) {
+    ScalarInsertMemOp<double,__m128d>::maskstore( ptr, value, count );
+  }
+#endif
+};
+template<>
+class VectorizedMemOp<double,__m128d,UnalignedMemory> :
+    public VectorizedMemOp<double,__m128d,AlignedMemory> {
+ public:
+  static __m128d load( const double* ptr ) {
+    return _mm_loadu_pd( ptr );
+  }
+  static void store( double* ptr, __m128d value) {
+    _mm_storeu_pd( ptr, value );
+  }
+};
+template<>
+class VectorizedMemOp<double,__m128d,StreamingMemory> :
+    public VectorizedMemOp<double,__m128d,AlignedMemory> {
+ public:
+  static void store( double* ptr, __m128d value) {
+    _mm_stream_pd( ptr, value );
+  }
+  static void fence() {
+    _mm_sfence();
+  }
+};
+/*
+ * Integer vectors: a single implementation for all element types, masked
+ * operations exist only for 32 and 64 bits elements, up to avx2
+ */
+template<typename T>
+class VectorizedMemOp<T,__m128i> {
+ public:
+  static __m128i load( const T* ptr ) {
+    return _mm_load_si128( reinterpret_cast<const __m128i*>(ptr) );
+  }
+  static void store( T* ptr, __m128i value) {
+    _mm_store_si128( reinterpret_cast<__m128i*>(ptr), value );
+  }
+  static void fence() {}
+  static __m128i maskload( const T* ptr, int count ) {
+    return ScalarInsertMemOp<T,__m128i>::maskload( ptr, count );
+  }
+  static void maskstore( T* ptr, __m128i value, int count ) {
+    ScalarInsertMemOp<T,__m128i>::maskstore( ptr, value, count );
+  }
+};
+template<typename T>
+class VectorizedMemOp<T,__m128i,UnalignedMemory> :
+    public VectorizedMemOp<T,__m128i,AlignedMemory> {
+ public:
+  static __m128i load( const T* ptr ) {
+    return _mm_loadu_si128( reinterpret_cast<const __m128i*>(ptr) );
+  }
+  static void store( T* ptr, __m128i value) {
+    _mm_storeu_si128( reinterpret_cast<__m128i*>(ptr), value );
+  }
+};
+template<typename T>
+class VectorizedMemOp<T,__m128i,StreamingMemory> :
+    public VectorizedMemOp<T,__m128i,AlignedMemory> {
+ public:
+  static void store( T* ptr, __m128i value) {
+    _mm_stream_si128( reinterpret_cast<__m128i*>(ptr), value );
+  }
+  static void fence() {
+    _mm_sfence();
+  }
 };
 #elif defined USE_AVX2
 template<>
@@ -48,6 +255,41 @@ class VectorizedMemOp<float,__m256> {
   static void store( float* ptr, __m256 value) {
     _mm256_store_ps( ptr, value );
   }
+  static void fence() {}
+  static __m256 maskload( const float* ptr, int count ) {
+    return _mm256_maskload_ps( ptr, Mask(count) );
+  }
+  static void maskstore( float* ptr, __m256 value, int count ) {
+    _mm256_maskstore_ps( ptr, Mask(count), value );
+  }
+ protected:
+  //Sign bit of the count first elements is set
+  static __m256i Mask( int count ) {
+    return _mm256_cmpgt_epi32( _mm256_set1_epi32(count),
+      _mm256_setr_epi32(0,1,2,3,4,5,6,7) );
+  }
+};
+template<>
+class VectorizedMemOp<float,__m256,UnalignedMemory> :
+    public VectorizedMemOp<float,__m256,AlignedMemory> {
+ public:
+  static __m256 load( const float* ptr ) {
+    return _mm256_loadu_ps( ptr );
+  }
+  static void store( float* ptr, __m256 value) {
+    _mm256_storeu_ps( ptr, value );
+  }
+};
+template<>
+class VectorizedMemOp<float,__m256,StreamingMemory> :
+    public VectorizedMemOp<float,__m256,AlignedMemory> {
+ public:
+  static void store( float* ptr, __m256 value) {
+    _mm256_stream_ps( ptr, value );
+  }
+  static void fence() {
+    _mm_sfence();
+  }
 };
 template<>
 class VectorizedMemOp<double,__m256d> {
@@ -58,6 +300,243 @@ class VectorizedMemOp<double,__m256d> {
   static void store( double* ptr, __m256d value) {
     _mm256_store_pd( ptr, value );
   }
+  static void fence() {}
+  static __m256d maskload( const double* ptr, int count ) {
+    return _mm256_maskload_pd( ptr, Mask(count) );
+  }
+  static void maskstore( double* ptr, __m256d value, int count ) {
+    _mm256_maskstore_pd( ptr, Mask(count), value );
+  }
+ protected:
+  //Both 32 bits halves of a 64 bits element share the same mask value
+  static __m256i Mask( int count ) {
+    return _mm256_cmpgt_epi32( _mm256_set1_epi32(count),
+      _mm256_setr_epi32(0,0,1,1,2,2,3,3) );
+  }
+};
+template<>
+class VectorizedMemOp<double,__m256d,UnalignedMemory> :
+    public VectorizedMemOp<double,__m256d,AlignedMemory> {
+ public:
+  static __m256d load( const double* ptr ) {
+    return _mm256_loadu_pd( ptr );
+  }
+  static void store( double* ptr, __m256d value) {
+    _mm256_storeu_pd( ptr, value );
+  }
+};
+template<>
+class VectorizedMemOp<double,__m256d,StreamingMemory> :
+    public VectorizedMemOp<double,__m256d,AlignedMemory> {
+ public:
+  static void store( double* ptr, __m256d value) {
+    _mm256_stream_pd( ptr, value );
+  }
+  static void fence() {
+    _mm_sfence();
+  }
+};
+template<typename T>
+class VectorizedMemOp<T,__m256i> {
+ public:
+  static __m256i load( const T* ptr ) {
+    return _mm256_load_si256( reinterpret_cast<const __m256i*>(ptr) );
+  }
+  static void store( T* ptr, __m256i value) {
+    _mm256_store_si256( reinterpret_cast<__m256i*>(ptr), value );
+  }
+  static void fence() {}
+  static __m256i maskload( const T* ptr, int count ) {
+    if (sizeof(T) == sizeof(int)) {
+      return _mm256_maskload_epi32( reinterpret_cast<const int*>(ptr),
+        Mask(count) );
+    }
+    return ScalarInsertMemOp<T,__m256i>::maskload( ptr, count );
+  }
+  static void maskstore( T* ptr, __m256i value, int count ) {
+    if (sizeof(T) == sizeof(int)) {
+      _mm256_maskstore_epi32( reinterpret_cast<int*>(ptr), Mask(count),
+        value );
+    } else {
+      ScalarInsertMemOp<T,__m256i>::maskstore( ptr, value, count );
+    }
+  }
+ protected:
+  static __m256i Mask( int count ) {
+    return _mm256_cmpgt_epi32( _mm256_set1_epi32(count),
+      _mm256_setr_epi32(0,1,2,3,4,5,6,7) );
+  }
+};
+template<typename T>
+class VectorizedMemOp<T,__m256i,UnalignedMemory> :
+    public VectorizedMemOp<T,__m256i,AlignedMemory> {
+ public:
+  static __m256i load( const T* ptr ) {
+    return _mm256_loadu_si256( reinterpret_cast<const __m256i*>(ptr) );
+  }
+  static void store( T* ptr, __m256i value) {
+    _mm256_storeu_si256( reinterpret_cast<__m256i*>(ptr), value );
+  }
+};
+template<typename T>
+class VectorizedMemOp<T,__m256i,StreamingMemory> :
+    public VectorizedMemOp<T,__m256i,AlignedMemory> {
+ public:
+  static void store( T* ptr, __m256i value) {
+    _mm256_stream_si256( reinterpret_cast<__m256i*>(ptr), value );
+  }
+  static void fence() {
+    _mm_sfence();
+  }
+};
+#elif defined USE_AVX512
+template<>
+class VectorizedMemOp<float,__m512> {
+ public:
+  static __m512 load( const float* ptr ) {
+    return _mm512_load_ps( ptr );
+  }
+  static void store( float* ptr, __m512 value) {
+    _mm512_store_ps( ptr, value );
+  }
+  static void fence() {}
+  //k-masks never touch masked out elements, even for unaligned accesses
+  static __m512 maskload( const float* ptr, int count ) {
+    return _mm512_maskz_loadu_ps( Mask(count), ptr );
+  }
+  static void maskstore( float* ptr, __m512 value, int count ) {
+    _mm512_mask_storeu_ps( ptr, Mask(count), value );
+  }
+ protected:
+  static __mmask16 Mask( int count ) {
+    return static_cast<__mmask16>((1u<<count)-1u);
+  }
+};
+template<>
+class VectorizedMemOp<float,__m512,UnalignedMemory> :
+    public VectorizedMemOp<float,__m512,AlignedMemory> {
+ public:
+  static __m512 load( const float* ptr ) {
+    return _mm512_loadu_ps( ptr );
+  }
+  static void store( float* ptr, __m512 value) {
+    _mm512_storeu_ps( ptr, value );
+  }
+};
+template<>
+class VectorizedMemOp<float,__m512,StreamingMemory> :
+    public VectorizedMemOp<float,__m512,AlignedMemory> {
+ public:
+  static void store( float* ptr, __m512 value) {
+    _mm512_stream_ps( ptr, value );
+  }
+  static void fence() {
+    _mm_sfence();
+  }
+};
+template<>
+class VectorizedMemOp<double,__m512d> {
+ public:
+  static __m512d load( const double* ptr ) {
+    return _mm512_load_pd( ptr );
+  }
+  static void store( double* ptr, __m512d value) {
+    _mm512_store_pd( ptr, value );
+  }
+  static void fence() {}
+  static __m512d maskload( const double* ptr, int count ) {
+    return _mm512_maskz_loadu_pd( Mask(count), ptr );
+  }
+  static void maskstore( double* ptr, __m512d value, int count ) {
+    _mm512_mask_storeu_pd( ptr, Mask(count), value );
+  }
+ protected:
+  static __mmask8 Mask( int count ) {
+    return static_cast<__mmask8>((1u<<count)-1u);
+  }
+};
+template<>
+class VectorizedMemOp<double,__m512d,UnalignedMemory> :
+    public VectorizedMemOp<double,__m512d,AlignedMemory> {
+ public:
+  static __m512d load( const double* ptr ) {
+    return _mm512_loadu_pd( ptr );
+  }
+  static void store( double* ptr, __m512d value) {
+    _mm512_storeu_pd( ptr, value );
+  }
+};
+template<>
+class VectorizedMemOp<double,__m512d,StreamingMemory> :
+    public VectorizedMemOp<double,__m512d,AlignedMemory> {
+ public:
+  static void store( double* ptr, __m512d value) {
+    _mm512_stream_pd( ptr, value );
+  }
+  static void fence() {
+    _mm_sfence();
+  }
+};
+/*
+ * 8 and 16 bits masked operations require avx512bw, PackType of such types
+ * is only a vector when it is available
+ */
+template<typename T>
+class VectorizedMemOp<T,__m512i> {
+ public:
+  static __m512i load( const T* ptr ) {
+    return _mm512_load_si512( ptr );
+  }
+  static void store( T* ptr, __m512i value) {
+    _mm512_store_si512( ptr, value );
+  }
+  static void fence() {}
+  static __m512i maskload( const T* ptr, int count ) {
+    switch (sizeof(T)) {
+#ifdef __AVX512BW__
+      case 1: return _mm512_maskz_loadu_epi8( Mask(count), ptr );
+      case 2: return _mm512_maskz_loadu_epi16( Mask(count), ptr );
+#endif
+      case 4: return _mm512_maskz_loadu_epi32( Mask(count), ptr );
+      default: return _mm512_maskz_loadu_epi64( Mask(count), ptr );
+    }
+  }
+  static void maskstore( T* ptr, __m512i value, int count ) {
+    switch (sizeof(T)) {
+#ifdef __AVX512BW__
+      case 1: _mm512_mask_storeu_epi8( ptr, Mask(count), value ); break;
+      case 2: _mm512_mask_storeu_epi16( ptr, Mask(count), value ); break;
+#endif
+      case 4: _mm512_mask_storeu_epi32( ptr, Mask(count), value ); break;
+      default: _mm512_mask_storeu_epi64( ptr, Mask(count), value );
+    }
+  }
+ protected:
+  static __mmask64 Mask( int count ) {
+    return count >= 64 ? ~0ULL : (1ULL<<count)-1ULL;
+  }
+};
+template<typename T>
+class VectorizedMemOp<T,__m512i,UnalignedMemory> :
+    public VectorizedMemOp<T,__m512i,AlignedMemory> {
+ public:
+  static __m512i load( const T* ptr ) {
+    return _mm512_loadu_si512( ptr );
+  }
+  static void store( T* ptr, __m512i value) {
+    _mm512_storeu_si512( ptr, value );
+  }
+};
+template<typename T>
+class VectorizedMemOp<T,__m512i,StreamingMemory> :
+    public VectorizedMemOp<T,__m512i,AlignedMemory> {
+ public:
+  static void store( T* ptr, __m512i value) {
+    _mm512_stream_si512( reinterpret_cast<__m512i*>(ptr), value );
+  }
+  static void fence() {
+    _mm_sfence();
+  }
 };
 #elif defined USE_NEON
 template<>
@@ -69,6 +548,13 @@ class VectorizedMemOp<float,float32x4_t> {
   static void store( float* ptr, float32x4_t value) {
     vst1q_f32( ptr, value );
   }
+  static void fence() {}
+  static float32x4_t maskload( const float* ptr, int count ) {
+    return ScalarInsertMemOp<float,float32x4_t>::maskload( ptr, count );
+  }
+  static void maskstore( float* ptr, float32x4_t value, int count ) {
+    ScalarInsertMemOp<float,float32x4_t>::maskstore( ptr, value, count );
+  }
 };
 template<>
 class VectorizedMemOp<double,float64x2_t> {
@@ -79,7 +565,16 @@ class VectorizedMemOp<double,float64x2_t> {
   static void store( double* ptr, float64x2_t value) {
     vst1q_f64( ptr, value );
   }
+  static void fence() {}
+  static float64x2_t maskload( const double* ptr, int count ) {
+    return ScalarInsertMemOp<double,float64x2_t>::maskload( ptr, count );
+  }
+  static void maskstore( double* ptr, float64x2_t value, int count ) {
+    ScalarInsertMemOp<double,float64x2_t>::maskstore( ptr, value, count );
+  }
 };
 #endif
+
+VECTORIZATION_NAMESPACE_END
 #endif //MEMORYHELPER_H
 
@@ -1,6 +1,11 @@
 #ifndef REDUCE_H
 #define REDUCE_H
 
+// Local
+#include "vectorization.h"
+
+VECTORIZATION_NAMESPACE_BEGIN
+
 //Default implementation work for non-vectorized case
 template<typename T, class VecT>
 class VectorSum {
@@ -50,6 +55,79 @@ class VectorSum<float,__m128> {
     //return _mm_extract_ps (shufl a, 0);
   }
 };
+template<>
+class VectorSum<double,__m128d> {
+ public:
+  static double ReduceSum( __m128d value ) {
+    return _mm_cvtsd_f64( _mm_add_pd(value, _mm_unpackhi_pd(value,value)) );
+  }
+};
+#elif defined USE_AVX2
+/*
+ * Sum all 8 float elements of a 256 bits vector, we first add the two 128 bits
+ * lanes together, then use the same butterfly pattern as in the 128 bits case
+ */
+template<>
+class VectorSum<float,__m256> {
+ public:
+  static float ReduceSum( __m256 value ) {
+    //|7+3|6+2|5+1|4+0|
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(value),
+      _mm256_extractf128_ps(value,1));
+    __m128 shufl = _mm_shuffle_ps(sum,sum, _MM_SHUFFLE(1,0,3,2));
+    sum = _mm_add_ps(sum, shufl);
+    shufl = _mm_shuffle_ps(sum,sum, _MM_SHUFFLE(2,3,0,1));
+    sum = _mm_add_ps(sum, shufl);
+    return _mm_cvtss_f32( sum );
+  }
+};
+template<>
+class VectorSum<double,__m256d> {
+ public:
+  static double ReduceSum( __m256d value ) {
+    __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(value),
+      _mm256_extractf128_pd(value,1));
+    return _mm_cvtsd_f64( _mm_add_pd(sum, _mm_unpackhi_pd(sum,sum)) );
+  }
+};
+#elif defined USE_AVX512
+/*
+ * The reduce intrinsics are sequences, not a single instruction, they perform
+ * the same lane halving pattern as what we do for 256 bits
+ */
+template<>
+class VectorSum<float,__m512> {
+ public:
+  static float ReduceSum( __m512 value ) {
+    return _mm512_reduce_add_ps( value );
+  }
+};
+template<>
+class VectorSum<double,__m512d> {
+ public:
+  static double ReduceSum( __m512d value ) {
+    return _mm512_reduce_add_pd( value );
+  }
+};
+#elif defined USE_NEON
+template<>
+class VectorSum<float,float32x4_t> {
+ public:
+  static float ReduceSum( float32x4_t value ) {
+    float32x2_t sum = vadd_f32(vget_low_f32(value), vget_high_f32(value));
+    return vget_lane_f32(vpadd_f32(sum, sum), 0);
+  }
+};
+#ifdef __aarch64__
+template<>
+class VectorSum<double,float64x2_t> {
+ public:
+  static double ReduceSum( float64x2_t value ) {
+    return vaddvq_f64( value );
+  }
+};
+#endif //__aarch64__
 #endif
 
+VECTORIZATION_NAMESPACE_END
 #endif //REDUCE_H
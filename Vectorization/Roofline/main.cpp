@@ -0,0 +1,127 @@
+/*
+ * main.cpp
+ *
+ *  Created on: 16 oct. 2026
+ *      Author: gnthibault
+ */
+
+//STL
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//Local
+#include "../Convolution.h"
+#include "../HalfFloat.h"
+#include "../Reduce.h"
+#include "../../Profiling/Benchmark.h"
+
+/*
+ * Roofline characterization of a few kernels of this repository: each kernel
+ * runs on working sets that fit in each memory level of the host, and the
+ * harness reports its arithmetic intensity, the memory level that serves it,
+ * and the fraction of the attainable performance it reaches.
+ * - the inner product performs 2 flops per 8 bytes, it follows the bandwidth
+ *   of each level
+ * - the 7 taps convolution performs 13 flops per 8 bytes, it should be
+ *   compute bound in L1 and bandwidth bound beyond
+ * - storing the signal in Half doubles its intensity
+ * - numerical integration does not access memory at all
+ */
+
+template<> const float MyFilter<float,3,3>::Buf[7] = {1.f/64.f,6.f/64.f,
+  15.f/64.f,20.f/64.f,15.f/64.f,6.f/64.f,1.f/64.f};
+
+typedef MyFilter<float,3,3> Filter7;
+typedef PackType<float> VecT;
+constexpr int VecSize = sizeof(VecT)/sizeof(float);
+
+//build with
+//g++ ./main.cpp -std=c++14 -O3 -mavx2 -mfma -mf16c -o test -DUSE_AVX2
+//g++ ./main.cpp -std=c++14 -O3 -march=skylake-avx512 -o test -DUSE_AVX512
+//./test --json roofline.json
+
+float InnerProduct(const float* a, const float* b, int size) {
+  //Independent accumulators, such that the add latency does not limit loads
+  VecT acc0 = VecT(), acc1 = VecT();
+  int i = 0;
+  for (; i+2*VecSize <= size; i += 2*VecSize) {
+    acc0 += VectorizedMemOp<float,VecT>::load(a+i)*
+      VectorizedMemOp<float,VecT>::load(b+i);
+    acc1 += VectorizedMemOp<float,VecT>::load(a+i+VecSize)*
+      VectorizedMemOp<float,VecT>::load(b+i+VecSize);
+  }
+  float sum = VectorSum<float,VecT>::ReduceSum(acc0+acc1);
+  for (; i < size; i++) {
+    sum += a[i]*b[i];
+  }
+  return sum;
+}
+
+float Integrate(int nbSteps) {
+  const float step = 1.f/static_cast<float>(nbSteps);
+  float sum = 0.f;
+  #pragma omp simd reduction(+:sum)
+  for (int i = 0; i < nbSteps; i++) {
+    const float x = (static_cast<float>(i)+0.5f)*step;
+    sum += 4.f/(1.f+x*x);
+  }
+  return sum*step;
+}
+
+int main(int argc, char* argv[]) {
+  BenchmarkRunner runner(argc, argv);
+  runner.EnableRoofline();
+
+  //One working set per cache level, a quarter of its capacity, and a last
+  //one served by the main memory
+  std::vector<std::pair<std::string,size_t>> workingSets;
+  for (const MemoryLevel& level : runner.Machine().levels) {
+    if (level.name == "DRAM") {
+      const double lastLevel = workingSets.empty() ? 0. :
+        runner.Machine().levels[workingSets.size()-1].bytes;
+      workingSets.emplace_back(level.name, static_cast<size_t>(std::min(
+        std::max(2.*lastLevel, 64.*1024.*1024.), 512.*1024.*1024.)));
+    } else {
+      workingSets.emplace_back(level.name, static_cast<size_t>(level.bytes/4));
+    }
+  }
+
+  for (const auto& workingSet : workingSets) {
+    const std::string suffix = " (" + workingSet.first + ")";
+    //Both float kernels read one buffer and write (or read) another one
+    const int size = static_cast<int>(workingSet.second/(2*sizeof(float)));
+    std::vector<float,PackAllocator<float>> in(size, 1.f);
+    std::vector<float,PackAllocator<float>> out(size, 0.f);
+
+    runner.Run("inner product"+suffix, [&]() {
+      float result = InnerProduct(in.data(), out.data(), size);
+      DoNotOptimize(result);
+    }, 2.*sizeof(float)*size, 2.*size);
+
+    //6 adds and 7 multiplies per output, one read and one write
+    runner.Run("7 taps convolution"+suffix, [&]() {
+      Convolution<Filter7>::Convolve(in.data(), out.data(), size);
+      ClobberMemory();
+    }, 2.*sizeof(float)*size, 13.*size);
+
+    //Same number of elements, half the bytes
+    std::vector<Half,PackAllocator<Half>> halfIn(size, Half(1.f));
+    std::vector<Half,PackAllocator<Half>> halfOut(size);
+    runner.Run("7 taps Half convolution"+suffix, [&]() {
+      Convolution<Filter7>::Convolve(halfIn.data(), halfOut.data(), size);
+      ClobberMemory();
+    }, 2.*sizeof(Half)*size, 13.*size);
+  }
+
+  //Per step: 1 add and 1 mul for x, 1 mul, 1 add and 1 div, then the sum
+  const int nbSteps = 1<<24;
+  runner.Run("numerical integration", [&]() {
+    float pi = Integrate(nbSteps);
+    DoNotOptimize(pi);
+  }, 0., 6.*nbSteps);
+
+  return runner.Finish() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,105 @@
+/*
+ * Kernels.cpp
+ *
+ *  Created on: 16 oct. 2026
+ *      Author: gnthibault
+ */
+
+/*
+ * This file is compiled once per instruction set, with the matching USE_XXX
+ * flag. Thanks to the inline namespace opened by vectorization.h, all
+ * template instances (Convolution, VectorizedMemOp, ...) get a distinct
+ * symbol name in every object file, so that linker never picks an avx2
+ * instance for the sse table.
+ * Beware that STL and boost instances are not protected this way, this is
+ * why we only use them outside of the hot loops. At -O0, they are not
+ * inlined either, the objects then share weak definitions, such as
+ * std::__copy_m<float> or boost::alignment::aligned_alloc, compiled for
+ * different instruction sets, of which the linker keeps any one: the scalar
+ * table could end up running avx512 code. This file must thus be built with
+ * -O1 or higher, otherwise each flavour has to be linked in its own shared
+ * object, built with -fvisibility=hidden
+ */
+#ifndef __OPTIMIZE__
+#error "Kernels.cpp must be built with -O1 or higher, see above"
+#endif
+
+//STL
+#include <vector>
+
+//Local
+#include "Kernels.h"
+#include "../Convolution.h"
+#include "../Reduce.h"
+
+/*
+ * Filters used by the kernels of the table: binomial smoothing filters
+ */
+template<> const float MyFilter<float,1,1>::Buf[3] = {0.25f,0.5f,0.25f};
+template<> const float MyFilter<float,3,3>::Buf[7] = {1.f/64.f,6.f/64.f,
+  15.f/64.f,20.f/64.f,15.f/64.f,6.f/64.f,1.f/64.f};
+
+namespace VECTORIZATION_ISA {
+
+namespace {
+
+/*
+ * Horizontal part of the mean filter
+ */
+class MeanFilter : public Filter<float,1,1> {
+public:
+  static const float Buf[3];
+};
+const float MeanFilter::Buf[3] = {1.f/9.f,1.f/9.f,1.f/9.f};
+
+typedef PackType<float> VecT;
+constexpr int VecSize = sizeof(VecT)/sizeof(float);
+
+template<class FILT>
+void ConvolveLine(const float* in, float* out, int lineSize) {
+  Convolution<FILT>::Convolve(in, out, lineSize);
+}
+
+float DotProduct(const float* a, const float* b, int size) {
+  VecT accumulator = VecT();
+  int i = 0;
+  for (; i+VecSize <= size; i+=VecSize) {
+    accumulator += VectorizedMemOp<float,VecT>::load(a+i)*
+      VectorizedMemOp<float,VecT>::load(b+i);
+  }
+  //Remainder, masked out elements are loaded as zero
+  accumulator += VectorizedMemOp<float,VecT>::maskload(a+i,size-i)*
+    VectorizedMemOp<float,VecT>::maskload(b+i,size-i);
+  return VectorSum<float,VecT>::ReduceSum(accumulator);
+}
+
+/*
+ * Vertical sum of the 3 neighbouring lines using vector additions, then
+ * horizontal 3 taps convolution of the result
+ */
+void MeanFilter3x3(const float* in, float* out, int sizeX, int sizeY) {
+  std::vector<float,PackAllocator<float>> column(sizeX);
+  for (int j = 0; j < sizeY; j++) {
+    const float* up = in+((j+sizeY-1)%sizeY)*sizeX;
+    const float* center = in+j*sizeX;
+    const float* down = in+((j+1)%sizeY)*sizeX;
+    for (int i = 0; i < sizeX; i+=VecSize) {
+      VectorizedMemOp<float,VecT>::store(column.data()+i,
+        VectorizedMemOp<float,VecT>::load(up+i)+
+        VectorizedMemOp<float,VecT>::load(center+i)+
+        VectorizedMemOp<float,VecT>::load(down+i));
+    }
+    ConvolveLine<MeanFilter>(column.data(), out+j*sizeX, sizeX);
+  }
+}
+
+} //anonymous namespace
+
+extern const KernelTable Kernels = {
+  &ConvolveLine<MyFilter<float,1,1>>,
+  &ConvolveLine<MyFilter<float,3,3>>,
+  &DotProduct,
+  &MeanFilter3x3
+};
+
+} //namespace VECTORIZATION_ISA
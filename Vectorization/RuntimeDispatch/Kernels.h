@@ -0,0 +1,41 @@
+/*
+ * Kernels.h
+ *
+ *  Created on: 16 oct. 2026
+ *      Author: gnthibault
+ */
+
+#ifndef RUNTIMEDISPATCH_KERNELS_H
+#define RUNTIMEDISPATCH_KERNELS_H
+
+//Local
+#include "../vectorization.h"
+#include "../CpuDispatch.h"
+
+/*
+ * Set of kernels compiled once per instruction set from Kernels.cpp.
+ * All buffers are expected to be aligned on 64 bytes, such that any of the
+ * variants can process them, and line sizes to be a multiple of 16 floats for
+ * the 2D filter.
+ */
+struct KernelTable {
+  //3 taps and 7 taps periodic convolution of a line
+  void (*Convolve3)(const float* in, float* out, int lineSize);
+  void (*Convolve7)(const float* in, float* out, int lineSize);
+  //Inner product of two vectors
+  float (*DotProduct)(const float* a, const float* b, int size);
+  //3*3 mean filter of a periodic image
+  void (*MeanFilter3x3)(const float* in, float* out, int sizeX, int sizeY);
+};
+
+/*
+ * One table per instruction set, each one is defined in the object file
+ * built with the matching flags, see main.cpp for the build lines
+ */
+namespace scalar { extern const KernelTable Kernels; }
+namespace sse { extern const KernelTable Kernels; }
+namespace avx { extern const KernelTable Kernels; }
+namespace avx2 { extern const KernelTable Kernels; }
+namespace avx512 { extern const KernelTable Kernels; }
+
+#endif //RUNTIMEDISPATCH_KERNELS_H
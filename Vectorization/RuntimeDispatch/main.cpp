@@ -0,0 +1,147 @@
+/*
+ * main.cpp
+ *
+ *  Created on: 16 oct. 2026
+ *      Author: gnthibault
+ */
+
+//STL
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+//Boost
+#include <boost/align/aligned_allocator.hpp>
+
+//Local
+#include "Kernels.h"
+
+#define SIZEX 1024
+#define SIZEY 1024
+#define NRUN 20
+
+/*
+ * This example shows how to ship a single binary that uses the best
+ * vectorized flavour of the kernels available on the host.
+ * Kernels.cpp is compiled once per instruction set, then the cpuid based
+ * detection of CpuDispatch.h selects, once at startup, which table of
+ * function pointers is going to be used.
+ * The only cost on the hot path is an indirect call per kernel invocation.
+ */
+
+//Build with, kernels at -O1 or higher (see Kernels.cpp)
+/*
+g++ -std=c++14 -O3 -c Kernels.cpp -o kernels_scalar.o
+g++ -std=c++14 -O3 -msse4.1 -DUSE_AVX -c Kernels.cpp -o kernels_sse.o
+g++ -std=c++14 -O3 -mavx -DUSE_AVX -c Kernels.cpp -o kernels_avx.o
+g++ -std=c++14 -O3 -mavx2 -mfma -DUSE_AVX2 -c Kernels.cpp -o kernels_avx2.o
+g++ -std=c++14 -O3 -march=skylake-avx512 -DUSE_AVX512 -c Kernels.cpp \
+  -o kernels_avx512.o
+g++ -std=c++14 -O3 ./main.cpp kernels_*.o -o test
+*/
+
+//Check a given variant with
+//VECTORIZATION_MAX_ISA=sse ./test
+
+/*
+ * Resolved once, during static initialization
+ */
+Isa chosenIsa = Isa::Scalar;
+const KernelTable& kernels = ResolveDispatch<KernelTable>({
+  {Isa::Scalar, &scalar::Kernels},
+  {Isa::Sse, &sse::Kernels},
+  {Isa::Avx, &avx::Kernels},
+  {Isa::Avx2, &avx2::Kernels},
+  {Isa::Avx512, &avx512::Kernels}}, &chosenIsa);
+
+typedef std::vector<float,boost::alignment::aligned_allocator<float,64>>
+  AlignedVector;
+
+bool IsClose(const AlignedVector& a, const AlignedVector& b) {
+  return std::equal(a.cbegin(), a.cend(), b.cbegin(), [](float x, float y) {
+    return std::abs(x-y) <= 1e-5f*std::max(1.f,std::abs(y)); });
+}
+
+template<typename FuncT>
+double MinRuntime(FuncT func) {
+  double msec=std::numeric_limits<double>::max();
+  for (int k = 0; k < NRUN; k++) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    auto stop = std::chrono::steady_clock::now();
+    msec = std::min(msec,
+      std::chrono::duration<double, std::milli>(stop-start).count());
+  }
+  return msec;
+}
+
+int main(int argc, char* argv[]) {
+  std::cout << "Best instruction set on this host is "
+    << CpuFeatures::Name(CpuFeatures::Best()) << ", dispatching to "
+    << CpuFeatures::Name(chosenIsa) << std::endl;
+
+  AlignedVector image(SIZEX*SIZEY), other(SIZEX*SIZEY);
+  AlignedVector output(SIZEX*SIZEY), control(SIZEX*SIZEY);
+  for (size_t i = 0; i < image.size(); i++) {
+    image[i] = static_cast<float>(rand())/static_cast<float>(RAND_MAX);
+    other[i] = static_cast<float>(rand())/static_cast<float>(RAND_MAX);
+  }
+
+  //Check the dispatched table against the scalar one, on all line sizes
+  bool isOK = true;
+  for (int size = 1; size <= 512; size++) {
+    kernels.Convolve3(image.data(), output.data(), size);
+    scalar::Kernels.Convolve3(image.data(), control.data(), size);
+    isOK &= IsClose(AlignedVector(output.begin(), output.begin()+size),
+      AlignedVector(control.begin(), control.begin()+size));
+    kernels.Convolve7(image.data(), output.data(), size);
+    scalar::Kernels.Convolve7(image.data(), control.data(), size);
+    isOK &= IsClose(AlignedVector(output.begin(), output.begin()+size),
+      AlignedVector(control.begin(), control.begin()+size));
+    float dot = kernels.DotProduct(image.data(), other.data(), size);
+    float dotControl = scalar::Kernels.DotProduct(image.data(), other.data(),
+      size);
+    isOK &= std::abs(dot-dotControl) <= 1e-5f*std::abs(dotControl);
+  }
+  kernels.MeanFilter3x3(image.data(), output.data(), SIZEX, SIZEY);
+  scalar::Kernels.MeanFilter3x3(image.data(), control.data(), SIZEX, SIZEY);
+  isOK &= IsClose(output, control);
+  if (isOK) {
+    std::cout << "All kernels match the scalar version" << std::endl;
+  } else {
+    std::cout << "WARNING : dispatched kernels do not match the scalar "
+      "version" << std::endl;
+  }
+
+  //Now compare runtimes
+  double refMsec = MinRuntime([&]() {
+    scalar::Kernels.Convolve7(image.data(), output.data(), image.size()); });
+  double msec = MinRuntime([&]() {
+    kernels.Convolve7(image.data(), output.data(), image.size()); });
+  std::cout << "Speedup for dispatched 7 taps convolution is "
+    << refMsec/msec << std::endl;
+
+  float result = 0;
+  refMsec = MinRuntime([&]() {
+    result += scalar::Kernels.DotProduct(image.data(), other.data(),
+      image.size()); });
+  msec = MinRuntime([&]() {
+    result += kernels.DotProduct(image.data(), other.data(),
+      image.size()); });
+  std::cout << "Speedup for dispatched dot product is "
+    << refMsec/msec << std::endl;
+
+  refMsec = MinRuntime([&]() {
+    scalar::Kernels.MeanFilter3x3(image.data(), output.data(), SIZEX,
+      SIZEY); });
+  msec = MinRuntime([&]() {
+    kernels.MeanFilter3x3(image.data(), output.data(), SIZEX, SIZEY); });
+  std::cout << "Speedup for dispatched 3*3 mean filter is "
+    << refMsec/msec << std::endl;
+
+  return isOK ? EXIT_SUCCESS : EXIT_FAILURE;
+}
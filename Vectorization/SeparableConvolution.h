@@ -0,0 +1,181 @@
+#ifndef SEPARABLECONVOLUTION_H
+#define SEPARABLECONVOLUTION_H
+
+//STL
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+//Local
+#include "Convolution.h"
+
+VECTORIZATION_NAMESPACE_BEGIN
+
+/*
+ * 2D separable convolution of a sizeX*sizeY image, with ROW_FILT along x
+ * and COL_FILT along y, the image being extended along both axes with
+ * BOUNDARY_POLICY, as in Convolution<FILT>::Convolve.
+ * - the row pass is the 1D Convolve, reading the input with LOAD_POLICY
+ * - the vertical pass processes whole rows as vectors: each output vector is
+ *   the weighted sum of the vectors at the same abscissa in the
+ *   COL_FILT::TapSize intermediate rows around it, without any shuffle
+ * The image is processed by strips of rows, distributed over the OpenMP
+ * threads. Each thread keeps its intermediate rows in a ring of
+ * COL_FILT::TapSize rows only, the row pass of a new row replacing the
+ * oldest one, such that intermediate results never leave the L2 cache (for
+ * 4K float rows and 31 taps, this is 480KB), and only the TapSize-1 rows
+ * around each strip are computed twice.
+ * Rows are stride elements apart, in and out must be vector aligned, with a
+ * vector aligned stride, unless LOAD_POLICY and STORE_POLICY are
+ * UnalignedMemory
+ */
+template<class ROW_FILT, class COL_FILT, class LOAD_POLICY=AlignedMemory,
+  class STORE_POLICY=AlignedMemory, class BOUNDARY_POLICY=PeriodicBoundary>
+class SeparableConvolution {
+public:
+  static_assert(std::is_same<typename ROW_FILT::ScalarType,
+    typename COL_FILT::ScalarType>::value,
+    "Row and column filters must share the same scalar type");
+  static_assert(std::is_floating_point<typename COL_FILT::ScalarType>::value,
+    "SeparableConvolution needs floating point filters");
+
+  template<typename IN_T, typename OUT_T>
+  static void Convolve(const IN_T* in, OUT_T* out, const int sizeX,
+      const int sizeY, const int stride, const int stripHeight=0) {
+    ConvolveStrips(
+      [](const IN_T* inRow, T* outRow, int size) {
+        RowConvolution::Convolve(inRow, outRow, size); },
+      COL_FILT::Buf, in, out, sizeX, sizeY, stride, stripHeight);
+  }
+
+  //Filters with runtime coefficients, see RuntimeFilter
+  template<typename IN_T, typename OUT_T>
+  static void Convolve(const ROW_FILT& rowFilter, const COL_FILT& colFilter,
+      const IN_T* in, OUT_T* out, const int sizeX, const int sizeY,
+      const int stride, const int stripHeight=0) {
+    ConvolveStrips(
+      [&rowFilter](const IN_T* inRow, T* outRow, int size) {
+        RowConvolution::Convolve(rowFilter, inRow, outRow, size); },
+      colFilter.Buf, in, out, sizeX, sizeY, stride, stripHeight);
+  }
+
+  //Default strip height: the rows computed twice are at most 1/4 of a strip
+  static int DefaultStripHeight() {
+    return std::max(16, 4*(COL_FILT::TapSize-1));
+  }
+
+protected:
+  typedef typename COL_FILT::ScalarType T;
+  typedef typename COL_FILT::VectorType VecT;
+  constexpr static int VecSize = COL_FILT::VecSize;
+  constexpr static int TapSize = COL_FILT::TapSize;
+  typedef Convolution<ROW_FILT,LOAD_POLICY,AlignedMemory,BOUNDARY_POLICY>
+    RowConvolution;
+
+  template<class ROW_PASS, typename IN_T, typename OUT_T>
+  static void ConvolveStrips(ROW_PASS rowPass,
+      const typename COL_FILT::CoefficientType* colBuf, const IN_T* in,
+      OUT_T* out, const int sizeX, const int sizeY, const int stride,
+      int stripHeight) {
+    if (sizeX <= 0 || sizeY <= 0) {
+      return;
+    }
+    stripHeight = std::min(sizeY, stripHeight > 0 ? stripHeight :
+      DefaultStripHeight());
+    const int nbStrip = (sizeY+stripHeight-1)/stripHeight;
+    //Intermediate rows are padded to a whole number of vectors
+    const int pitch = (sizeX+VecSize-1)/VecSize*VecSize;
+
+    #pragma omp parallel
+    {
+      std::vector<T,PackAllocator<T>> ring(TapSize*pitch, T(0));
+      VecT coefs[TapSize];
+      for (int k = 0; k < TapSize; k++) {
+        coefs[k] = VecT() + colBuf[k];
+      }
+
+      #pragma omp for schedule(dynamic)
+      for (int strip = 0; strip < nbStrip; strip++) {
+        const int first = strip*stripHeight;
+        const int last = std::min(sizeY, first+stripHeight);
+        //Row y of the image lives in ring slot (y-first+TapSizeLeft)%TapSize
+        auto slot = [&](int y) {
+          return ring.data()+((y-first+COL_FILT::TapSizeLeft)%TapSize)*pitch;
+        };
+        //Row pass of the row that stands for y, or zeros out of the image
+        auto computeRow = [&](int y) {
+          const int src = BOUNDARY_POLICY::Index(y,sizeY);
+          if (src >= 0) {
+            rowPass(in+src*stride, slot(y), sizeX);
+          } else {
+            std::fill(slot(y), slot(y)+pitch, T(0));
+          }
+        };
+        //Rows above the first output, and below it up to the last tap but one
+        for (int y = first-COL_FILT::TapSizeLeft;
+            y < first+COL_FILT::TapSizeRight; y++) {
+          computeRow(y);
+        }
+        for (int y = first; y < last; y++) {
+          computeRow(y+COL_FILT::TapSizeRight);
+          const T* rows[TapSize];
+          for (int k = 0; k < TapSize; k++) {
+            rows[k] = slot(y-COL_FILT::TapSizeLeft+k);
+          }
+          VerticalPass(rows, coefs, out+y*stride, sizeX);
+        }
+      }
+    }
+    VectorizedMemOp<OUT_T,VecT,STORE_POLICY>::fence();
+  }
+
+  /*
+   * One output row, from the TapSize intermediate rows of its support
+   */
+  template<typename OUT_T>
+  static void VerticalPass(const T* const* rows, const VecT* coefs,
+      OUT_T* out, const int sizeX) {
+    int x = 0;
+    for (; x+VecSize <= sizeX; x += VecSize) {
+      VectorizedMemOp<OUT_T,VecT,STORE_POLICY>::store(out+x,
+        VerticalSum(rows, coefs, x));
+    }
+    //Intermediate rows are padded, only the store has to be masked
+    if (x < sizeX) {
+      VectorizedMemOp<OUT_T,VecT,STORE_POLICY>::maskstore(out+x,
+        VerticalSum(rows, coefs, x), sizeX-x);
+    }
+  }
+
+  static VecT VerticalSum(const T* const* rows, const VecT* coefs,
+      const int x) {
+    if (COL_FILT::Symmetry == FilterSymmetry::None || TapSize == 1) {
+      VecT acc = coefs[0]*VectorizedMemOp<T,VecT>::load(rows[0]+x);
+      for (int k = 1; k < TapSize; k++) {
+        acc += coefs[k]*VectorizedMemOp<T,VecT>::load(rows[k]+x);
+      }
+      return acc;
+    }
+    //Symmetric filters: mirrored rows are folded first, see
+    //FoldedConvolutionAccumulator
+    VecT acc = coefs[0]*Fold(rows, x, 0);
+    if (TapSize%2 == 1 && COL_FILT::Symmetry == FilterSymmetry::Symmetric) {
+      acc += coefs[TapSize/2]*VectorizedMemOp<T,VecT>::load(
+        rows[TapSize/2]+x);
+    }
+    for (int k = 1; k < TapSize/2; k++) {
+      acc += coefs[k]*Fold(rows, x, k);
+    }
+    return acc;
+  }
+
+  static VecT Fold(const T* const* rows, const int x, const int k) {
+    const VecT top = VectorizedMemOp<T,VecT>::load(rows[k]+x);
+    const VecT bottom = VectorizedMemOp<T,VecT>::load(rows[TapSize-1-k]+x);
+    return COL_FILT::Symmetry == FilterSymmetry::Symmetric ? top+bottom :
+      top-bottom;
+  }
+};
+
+VECTORIZATION_NAMESPACE_END
+#endif //SEPARABLECONVOLUTION_H
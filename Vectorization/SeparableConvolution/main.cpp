@@ -0,0 +1,219 @@
+/*
+ * main.cpp
+ *
+ *  Created on: 16 oct. 2026
+ *      Author: gnthibault
+ */
+
+//STL
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+//Local
+#include "../SeparableConvolution.h"
+#include "../../Profiling/Benchmark.h"
+
+/*
+ * Separable 2D filters on a 4K image: gaussian blurs (binomial coefficients)
+ * and the horizontal Sobel derivative, that smoothes along y and derives
+ * along x.
+ * The strip engine is checked against a direct 2D reference, then compared
+ * with the textbook two pass version, that convolves all rows into a full
+ * size intermediate image, then filters its columns: the intermediate image
+ * does not fit in cache, it is written then read back from memory
+ */
+
+template<> const float MyFilter<float,1,1>::Buf[3] = {1.f/4.f,2.f/4.f,1.f/4.f};
+template<> const float MyFilter<float,3,3>::Buf[7] = {1.f/64.f,6.f/64.f,
+  15.f/64.f,20.f/64.f,15.f/64.f,6.f/64.f,1.f/64.f};
+template<> const float MyFilter<float,7,7>::Buf[15] = {1.f/16384.f,
+  14.f/16384.f,91.f/16384.f,364.f/16384.f,1001.f/16384.f,2002.f/16384.f,
+  3003.f/16384.f,3432.f/16384.f,3003.f/16384.f,2002.f/16384.f,1001.f/16384.f,
+  364.f/16384.f,91.f/16384.f,14.f/16384.f,1.f/16384.f};
+//Derivative part of the Sobel operator
+template<> const float MyFilter<float,1,0>::Buf[2] = {-1.f,1.f};
+template<> const float MyFilter<float,2,1>::Buf[4] = {1.f,2.f,-3.f,4.f};
+//Folded vertical passes
+template<> const float MyFilter<float,2,2,FilterSymmetry::Symmetric>::Buf[5] =
+  {1.f,4.f,6.f,4.f,1.f};
+template<> const float MyFilter<float,1,1,FilterSymmetry::Antisymmetric>::
+  Buf[3] = {-1.f,0.f,1.f};
+
+#define SIZEX 3840
+#define SIZEY 2160
+
+//build with
+//g++ ./main.cpp -std=c++14 -O3 -mavx2 -mfma -fopenmp -o test -DUSE_AVX2
+//g++ ./main.cpp -std=c++14 -O3 -march=skylake-avx512 -fopenmp -o test -DUSE_AVX512
+//OMP_NUM_THREADS=4 ./test --json separable.json
+
+/*
+ * Direct 2D convolution, by the outer product of both filters, summed row
+ * pass first, as the engine does
+ */
+template<class ROW_FILT, class COL_FILT, class BOUNDARY>
+void NaiveConvolve2D(const float* in, float* out, int sizeX, int sizeY,
+    int stride) {
+  std::vector<float> rows(COL_FILT::TapSize);
+  for (int y = 0; y < sizeY; y++) {
+    for (int x = 0; x < sizeX; x++) {
+      for (int k = 0; k < COL_FILT::TapSize; k++) {
+        const int row = BOUNDARY::Index(y+k-COL_FILT::TapSizeLeft, sizeY);
+        rows[k] = 0.f;
+        for (int j = 0; j < ROW_FILT::TapSize && row >= 0; j++) {
+          const int col = BOUNDARY::Index(x+j-ROW_FILT::TapSizeLeft, sizeX);
+          if (col >= 0) {
+            rows[k] += ROW_FILT::Buf[j]*in[row*stride+col];
+          }
+        }
+      }
+      float sum = COL_FILT::Buf[0]*rows[0];
+      for (int k = 1; k < COL_FILT::TapSize; k++) {
+        sum += COL_FILT::Buf[k]*rows[k];
+      }
+      out[y*stride+x] = sum;
+    }
+  }
+}
+
+/*
+ * Results must be exact on integer valued images, for any size, stride and
+ * strip height, including strips that are smaller than the filter
+ */
+template<class ROW_FILT, class COL_FILT, class BOUNDARY=PeriodicBoundary>
+bool Check(int sizeX, int sizeY, int stripHeight) {
+  constexpr int VecSize = sizeof(PackType<float>)/sizeof(float);
+  const int stride = (sizeX+2*VecSize-1)/VecSize*VecSize;
+  std::vector<float,PackAllocator<float>> in(stride*sizeY);
+  std::vector<float,PackAllocator<float>> out(stride*sizeY, 0.f);
+  std::vector<float,PackAllocator<float>> control(stride*sizeY, 0.f);
+  std::generate(in.begin(), in.end(), []() {
+    return static_cast<float>(rand()%16); });
+
+  SeparableConvolution<ROW_FILT,COL_FILT,AlignedMemory,AlignedMemory,
+    BOUNDARY>::Convolve(in.data(), out.data(), sizeX, sizeY, stride,
+    stripHeight);
+  NaiveConvolve2D<ROW_FILT,COL_FILT,BOUNDARY>(in.data(), control.data(),
+    sizeX, sizeY, stride);
+  bool isOK = true;
+  for (int y = 0; y < sizeY; y++) {
+    isOK &= std::equal(control.begin()+y*stride,
+      control.begin()+y*stride+sizeX, out.begin()+y*stride);
+  }
+
+  //Same filters, coefficients given at runtime
+  typedef RuntimeFilter<Filter<float,ROW_FILT::TapSizeLeft,
+    ROW_FILT::TapSizeRight,ROW_FILT::Symmetry>> RowFilter;
+  typedef RuntimeFilter<Filter<float,COL_FILT::TapSizeLeft,
+    COL_FILT::TapSizeRight,COL_FILT::Symmetry>> ColFilter;
+  std::fill(out.begin(), out.end(), 0.f);
+  SeparableConvolution<RowFilter,ColFilter,AlignedMemory,AlignedMemory,
+    BOUNDARY>::Convolve(RowFilter(ROW_FILT::Buf), ColFilter(COL_FILT::Buf),
+    in.data(), out.data(), sizeX, sizeY, stride, stripHeight);
+  for (int y = 0; y < sizeY; y++) {
+    isOK &= std::equal(control.begin()+y*stride,
+      control.begin()+y*stride+sizeX, out.begin()+y*stride);
+  }
+  return isOK;
+}
+
+/*
+ * Textbook version: full row pass, then full column pass
+ */
+template<class ROW_FILT, class COL_FILT>
+void TwoPassConvolve2D(const float* in, float* tmp, float* out, int sizeX,
+    int sizeY) {
+  #pragma omp parallel for
+  for (int y = 0; y < sizeY; y++) {
+    Convolution<ROW_FILT>::Convolve(in+y*sizeX, tmp+y*sizeX, sizeX);
+  }
+  #pragma omp parallel for
+  for (int y = 0; y < sizeY; y++) {
+    const float* rows[COL_FILT::TapSize];
+    for (int k = 0; k < COL_FILT::TapSize; k++) {
+      rows[k] = tmp+positive_modulo(y+k-COL_FILT::TapSizeLeft, sizeY)*sizeX;
+    }
+    for (int x = 0; x < sizeX; x++) {
+      float sum = COL_FILT::Buf[0]*rows[0][x];
+      for (int k = 1; k < COL_FILT::TapSize; k++) {
+        sum += COL_FILT::Buf[k]*rows[k][x];
+      }
+      out[y*sizeX+x] = sum;
+    }
+  }
+}
+
+template<class ROW_FILT, class COL_FILT>
+void Benchmark(BenchmarkRunner& runner, const char* name,
+    const std::vector<float,PackAllocator<float>>& in,
+    std::vector<float,PackAllocator<float>>& tmp,
+    std::vector<float,PackAllocator<float>>& out) {
+  //Input read and output written once, multiply-add per tap
+  const double bytes = 2.*sizeof(float)*SIZEX*SIZEY;
+  const double flops = 2.*(ROW_FILT::TapSize+COL_FILT::TapSize)*SIZEX*SIZEY;
+  const double refMsec = runner.Run(std::string(name)+", two passes", [&]() {
+      TwoPassConvolve2D<ROW_FILT,COL_FILT>(in.data(), tmp.data(), out.data(),
+        SIZEX, SIZEY);
+      ClobberMemory();
+    }, bytes, flops).median;
+  const double msec = runner.Run(std::string(name)+", strips", [&]() {
+      SeparableConvolution<ROW_FILT,COL_FILT>::Convolve(in.data(),
+        out.data(), SIZEX, SIZEY, SIZEX);
+      ClobberMemory();
+    }, bytes, flops).median;
+  std::cout << "Speedup of the strip engine for " << name << " is "
+    << refMsec/msec << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  bool isOK = true;
+  for (int sizeX : {1, 7, 16, 37, 100}) {
+    for (int sizeY : {1, 5, 33}) {
+      for (int stripHeight : {0, 1, 4}) {
+        isOK &= Check<MyFilter<float,1,1>,MyFilter<float,3,3>>(sizeX, sizeY,
+          stripHeight);
+        isOK &= Check<MyFilter<float,1,0>,MyFilter<float,1,1>>(sizeX, sizeY,
+          stripHeight);
+        isOK &= Check<MyFilter<float,2,1>,MyFilter<float,7,7>>(sizeX, sizeY,
+          stripHeight);
+        isOK &= Check<MyFilter<float,2,1>,
+          MyFilter<float,2,2,FilterSymmetry::Symmetric>>(sizeX, sizeY,
+          stripHeight);
+        isOK &= Check<MyFilter<float,2,2,FilterSymmetry::Symmetric>,
+          MyFilter<float,1,1,FilterSymmetry::Antisymmetric>>(sizeX, sizeY,
+          stripHeight);
+        //Other boundaries, zero rows out of the image included
+        isOK &= Check<MyFilter<float,2,1>,MyFilter<float,3,3>,
+          MirrorBoundary>(sizeX, sizeY, stripHeight);
+        isOK &= Check<MyFilter<float,2,1>,MyFilter<float,3,3>,
+          ClampBoundary>(sizeX, sizeY, stripHeight);
+        isOK &= Check<MyFilter<float,2,1>,MyFilter<float,3,3>,
+          ZeroBoundary>(sizeX, sizeY, stripHeight);
+      }
+    }
+  }
+  if (isOK) {
+    std::cout << "All separable tests returned True Value" << std::endl;
+  } else {
+    std::cout << " WARNING : There may be a bug in separable convolution"
+      << std::endl;
+  }
+
+  BenchmarkRunner runner(argc, argv);
+  std::vector<float,PackAllocator<float>> in(SIZEX*SIZEY);
+  std::vector<float,PackAllocator<float>> tmp(SIZEX*SIZEY);
+  std::vector<float,PackAllocator<float>> out(SIZEX*SIZEY);
+  std::generate(in.begin(), in.end(), []() {
+    return static_cast<float>(rand())/static_cast<float>(RAND_MAX); });
+
+  Benchmark<MyFilter<float,1,0>,MyFilter<float,1,1>>(runner, "Sobel", in, tmp,
+    out);
+  Benchmark<MyFilter<float,3,3>,MyFilter<float,3,3>>(runner, "7x7 gaussian",
+    in, tmp, out);
+  Benchmark<MyFilter<float,7,7>,MyFilter<float,7,7>>(runner,
+    "15x15 gaussian", in, tmp, out);
+
+  return runner.Finish() && isOK ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -21,21 +21,26 @@
 
 //Local
 #include "vectorization.h"
+#include "MemoryHelper.h"
 
+VECTORIZATION_NAMESPACE_BEGIN
+
+// forward-declaration to allow use in SimdIter
+template<typename T, class POLICY> class SimdVec;
 
 /*
  * An iterator must support an operator* method, an operator != method,
  * and an operator++ method
  */
-template<typename T>
+template<typename T, class POLICY=AlignedMemory>
 class SimdIter
 {
 public:
-    SimdIter(SimdVec<T>* vec, size_t idx) : m_idx( idx ), m_vec( vec ) {}
+    SimdIter(SimdVec<T,POLICY>* vec, size_t idx) : m_idx( idx ), m_vec( vec ) {}
 
     // these three methods form the basis of an iterator for use with
     // a range-based for loop
-    bool operator!=(const SimdIter<T>& other) const
+    bool operator!=(const SimdIter<T,POLICY>& other) const
     {
         return m_idx != other.m_idx;
     }
@@ -52,7 +57,7 @@ public:
 	// since it needs to use it
     void set( PackType<T> val );
 
-    SimdIter<T>& operator++() //prefix
+    SimdIter<T,POLICY>& operator++() //prefix
     {
     	// incrementing index accounting for the multiple elements
     	// of the packed type
@@ -63,7 +68,7 @@ public:
         return *this;
     }
 
-    SimdIter<T> operator++(int) //suffix
+    SimdIter<T,POLICY> operator++(int) //suffix
 	{
 	   m_idx+=(sizeof(PackType<T>)/sizeof(T));
 	   return *this;
@@ -71,27 +76,27 @@ public:
 
 private:
     size_t m_idx;
-    SimdVec<T> *m_vec;
+    SimdVec<T,POLICY> *m_vec;
 };
 //The const iterator
-template<typename T>
+template<typename T, class POLICY=AlignedMemory>
 class SimdIterConst
 {
 public:
-	SimdIterConst(const SimdVec<T>* vec, size_t idx) : m_idx( idx ), m_vec( vec ) {}
+	SimdIterConst(const SimdVec<T,POLICY>* vec, size_t idx) : m_idx( idx ), m_vec( vec ) {}
 
-    bool operator!=(const SimdIterConst<T>& other) const
+    bool operator!=(const SimdIterConst<T,POLICY>& other) const
     {
         return m_idx != other.m_idx;
     }
     PackType<T> operator* () const;
     PackType<T> get() const { return *(*this); };
-    SimdIterConst<T>& operator++() //prefix
+    SimdIterConst<T,POLICY>& operator++() //prefix
     {
         m_idx+=(sizeof(PackType<T>)/sizeof(T));
         return *this;
     }
-    SimdIterConst<T> operator++(int) //suffix
+    SimdIterConst<T,POLICY> operator++(int) //suffix
 	{
 	   m_idx+=(sizeof(PackType<T>)/sizeof(T));
 	   return *this;
@@ -99,14 +104,18 @@ public:
 
 private:
     size_t m_idx;
-    const SimdVec<T> *m_vec;
+    const SimdVec<T,POLICY> *m_vec;
 };
 
 /*
  * An iterable object must feature a begin and a end methods that return
  * iterators to the beginning and end of the "vector"
+ * Storage is always aligned, POLICY is the memory access policy used by the
+ * get and set methods, for instance StreamingMemory to fill a large vector
+ * without evicting the data it is computed from from the cache. Call fence()
+ * once such a fill is over
  */
-template<typename T>
+template<typename T, class POLICY=AlignedMemory>
 class SimdVec
 {
 public:
@@ -118,31 +127,31 @@ public:
         m_vec.resize( newSize*nbElementPerVector, initVal );
 	}
 
-    SimdIter<T> begin()
+    SimdIter<T,POLICY> begin()
     {
-        return SimdIter<T>( this, 0 );
+        return SimdIter<T,POLICY>( this, 0 );
     }
-    SimdIterConst<T> cbegin() const
+    SimdIterConst<T,POLICY> cbegin() const
     {
-        return SimdIterConst<T>( this, 0 );
+        return SimdIterConst<T,POLICY>( this, 0 );
     }
-    SimdIter<T> end()
+    SimdIter<T,POLICY> end()
     {
-        return SimdIter<T>( this, m_vec.size() );
+        return SimdIter<T,POLICY>( this, m_vec.size() );
     }
-    SimdIterConst<T> cend() const
+    SimdIterConst<T,POLICY> cend() const
 	{
-		return SimdIterConst<T>( this, m_vec.size() );
+		return SimdIterConst<T,POLICY>( this, m_vec.size() );
 	}
 
     //We also authorize non sse2 iterators
-    typename std::vector<T,boost::alignment::aligned_allocator<T> >::iterator
+    typename std::vector<T,PackAllocator<T> >::iterator
 	scalarbegin() { return m_vec.begin(); }
-    typename std::vector<T,boost::alignment::aligned_allocator<T> >::iterator
+    typename std::vector<T,PackAllocator<T> >::iterator
 	scalarend() { return m_vec.end(); }
-    typename std::vector<T,boost::alignment::aligned_allocator<T> >::const_iterator
+    typename std::vector<T,PackAllocator<T> >::const_iterator
 	cscalarbegin() { return m_vec.cbegin(); }
-    typename std::vector<T,boost::alignment::aligned_allocator<T> >::const_iterator
+    typename std::vector<T,PackAllocator<T> >::const_iterator
     cscalarend() { return m_vec.cend(); }
 
     //This is an unsafe get, be carefull about what
@@ -150,37 +159,44 @@ public:
     //of vector size
     PackType<T> get( size_t idx ) const
     {
-         return VectorizedMemOp<T,PackType<T>>::load(m_vec.data()+idx);
+         return VectorizedMemOp<T,PackType<T>,POLICY>::load(m_vec.data()+idx);
     }
 
     //Unsafe set
     void set( size_t idx, PackType<T> val )
 	{
-    	VectorizedMemOp<T,PackType<T>>::store( m_vec.data()+idx, val );
+    	VectorizedMemOp<T,PackType<T>,POLICY>::store( m_vec.data()+idx, val );
 	}
 
+    //Make non temporal stores visible to other threads
+    void fence() const
+    {
+        VectorizedMemOp<T,PackType<T>,POLICY>::fence();
+    }
+
 protected:
-    std::vector<T,boost::alignment::aligned_allocator<T> > m_vec;
+    std::vector<T,PackAllocator<T> > m_vec;
 };
 
-template<typename T>
-PackType<T> SimdIter<T>::operator*() const
+template<typename T, class POLICY>
+PackType<T> SimdIter<T,POLICY>::operator*() const
 {
      return m_vec->get(m_idx);
 }
 
-template<typename T>
-PackType<T> SimdIterConst<T>::operator*() const
+template<typename T, class POLICY>
+PackType<T> SimdIterConst<T,POLICY>::operator*() const
 {
      return m_vec->get(m_idx);
 }
 
-template<typename T>
-void SimdIter<T>::set(PackType<T> val)
+template<typename T, class POLICY>
+void SimdIter<T,POLICY>::set(PackType<T> val)
 {
      return m_vec->set(m_idx, val);
 }
 
 
+VECTORIZATION_NAMESPACE_END
 
 #endif /* VECTORIZATION_SIMDVEC_H_ */
@@ -0,0 +1,143 @@
+#ifndef STREAMINGCONVOLUTION_H
+#define STREAMINGCONVOLUTION_H
+
+//STL
+#include <algorithm>
+#include <vector>
+
+//Local
+#include "Convolution.h"
+
+VECTORIZATION_NAMESPACE_BEGIN
+
+/*
+ * Convolution of an unbounded stream, pushed by chunks of any size: the
+ * stream is the concatenation of all the chunks, preceded by zeros, and its
+ * outputs are the ones of Convolution<FILT,...,ZeroBoundary>::Convolve on
+ * the whole stream, once Flush has extended it with zeros.
+ * Output j needs the input j+TapSizeRight, such that Push emits the outputs
+ * that are complete, up to TapSizeRight samples behind the input, and
+ * carries the last TapSizeLeft+TapSizeRight samples to the next chunk.
+ * Chunks are appended to this history in an aligned buffer, sized for
+ * MaxChunkSize samples at construction, and processed by the vectorized
+ * kernel of Convolution, with no border buffer since the history is the
+ * actual left context. Nothing is allocated per chunk, longer chunks are
+ * processed by pieces of MaxChunkSize.
+ * STORE_POLICY applies to the outputs, whose alignment depends on the
+ * chunk sizes for most uses
+ */
+template<class FILT, class STORE_POLICY=UnalignedMemory>
+class StreamingConvolution :
+    protected Convolution<FILT,AlignedMemory,STORE_POLICY,ZeroBoundary> {
+public:
+  typedef typename FILT::ScalarType T;
+  //Number of samples carried from a chunk to the next one
+  constexpr static int HistorySize = FILT::TapSizeLeft+FILT::TapSizeRight;
+
+  explicit StreamingConvolution(const int maxChunkSize) :
+      StreamingConvolution(FILT(), maxChunkSize) {}
+
+  //Filter with runtime coefficients, see RuntimeFilter
+  StreamingConvolution(const FILT& filter, const int maxChunkSize) :
+      m_filter(filter), m_maxChunkSize(std::max(1, maxChunkSize)),
+      m_buffer(BufferSize(m_maxChunkSize), T(0)), m_pending(0) {}
+
+  int MaxChunkSize() const {
+    return m_maxChunkSize;
+  }
+
+  /*
+   * Append n samples to the stream, and write the outputs that are
+   * complete, that is n of them once TapSizeRight samples have been pushed.
+   * out must hold n elements, returns the number of outputs written
+   */
+  int Push(const T* chunk, const int n, T* out) {
+    int written = 0;
+    for (int first = 0; first < n; first += m_maxChunkSize) {
+      const int size = std::min(m_maxChunkSize, n-first);
+      std::copy(chunk+first, chunk+first+size,
+        m_buffer.begin()+HistoryBegin+FILT::TapSizeLeft+m_pending);
+      written += Emit(out+written, m_pending+size-FILT::TapSizeRight);
+    }
+    return written;
+  }
+
+  /*
+   * Write the outputs of the last samples, the stream being extended by
+   * zeros, then start a new stream. out must hold TapSizeRight elements,
+   * returns the number of outputs written
+   */
+  int Flush(T* out) {
+    const int count = m_pending;
+    std::fill(m_buffer.begin()+HistoryBegin+FILT::TapSizeLeft+m_pending,
+      m_buffer.begin()+HistoryBegin+HistorySize+m_pending, T(0));
+    Emit(out, count);
+    Reset();
+    return count;
+  }
+
+  //Start a new stream, preceded by zeros
+  void Reset() {
+    std::fill(m_buffer.begin(), m_buffer.end(), T(0));
+    m_pending = 0;
+  }
+
+protected:
+  typedef Convolution<FILT,AlignedMemory,STORE_POLICY,ZeroBoundary> Base;
+  /*
+   * The buffer holds the TapSizeLeft inputs before the next output, then
+   * the m_pending inputs that have not been output yet, then the chunk.
+   * The prefetch area of the next output begins HistoryBegin elements
+   * before, such that it is aligned
+   */
+  constexpr static int HistoryBegin = Base::FirstIndexToProcess-
+    FILT::TapSizeLeft;
+
+  /*
+   * Whole vectors loaded by the kernel for the outputs of a chunk, or of the
+   * TapSizeRight zeros of Flush, which also holds the history followed by
+   * either of them
+   */
+  static int BufferSize(const int maxChunkSize) {
+    const int maxCount = std::max(maxChunkSize, FILT::TapSizeRight);
+    return ((maxCount+FILT::VecSize-1)/FILT::VecSize+
+      Base::PrefetchCardinality)*FILT::VecSize;
+  }
+
+  //Next count outputs, then drop the inputs that no output needs anymore
+  int Emit(T* out, const int count) {
+    if (count <= 0) {
+      m_pending = count+FILT::TapSizeRight;
+      return 0;
+    }
+    Base::template VectorConvolve<AlignedMemory>(Coefficients(m_filter, 0),
+      m_buffer.data(), out, count/FILT::VecSize, count%FILT::VecSize);
+    m_pending = FILT::TapSizeRight;
+    std::copy(m_buffer.begin()+HistoryBegin+count,
+      m_buffer.begin()+HistoryBegin+count+HistorySize,
+      m_buffer.begin()+HistoryBegin);
+    return count;
+  }
+
+  //Runtime coefficients are broadcast for each chunk, on the stack
+  template<class F>
+  static auto Coefficients(const F& filter, int) ->
+      decltype(filter.Broadcast()) {
+    return filter.Broadcast();
+  }
+
+  template<class F>
+  static StaticCoefficients<F> Coefficients(const F&, long) {
+    return StaticCoefficients<F>();
+  }
+
+  FILT m_filter;
+  int m_maxChunkSize;
+  std::vector<T,PackAllocator<T>> m_buffer;
+  //Inputs after the TapSizeLeft history that have no output yet, at most
+  //TapSizeRight between two pushes
+  int m_pending;
+};
+
+VECTORIZATION_NAMESPACE_END
+#endif //STREAMINGCONVOLUTION_H
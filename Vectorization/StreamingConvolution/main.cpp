@@ -0,0 +1,158 @@
+/*
+ * main.cpp
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: gnthibault
+ */
+
+//STL
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//Local
+#include "../StreamingConvolution.h"
+#include "../../Profiling/Benchmark.h"
+
+/*
+ * A stream pushed by chunks of random sizes, below and above MaxChunkSize,
+ * must give the same outputs as the convolution of the whole stream with
+ * zeros on both ends, whatever the chunk boundaries. Pushing by chunks is
+ * then timed against Convolve on each chunk, that does the same work, but
+ * has wrong borders, for chunks of 256 to 4096 floats
+ */
+template<> const float MyFilter<float,1,1>::Buf[3] = {1.f/4.f,2.f/4.f,1.f/4.f};
+template<> const float MyFilter<float,3,3>::Buf[7] = {-1.f/16.f,0.f,
+  9.f/16.f,1.f,9.f/16.f,0.f,-1.f/16.f};
+template<> const float MyFilter<float,2,4>::Buf[7] = {-1.f/8.f,2.f/8.f,
+  3.f/8.f,5.f/8.f,-3.f/8.f,1.f/8.f,1.f/8.f};
+template<> const float MyFilter<float,7,0>::Buf[8] = {1.f/8.f,1.f/8.f,
+  1.f/8.f,1.f/8.f,1.f/8.f,1.f/8.f,1.f/8.f,1.f/8.f};
+template<> const float MyFilter<float,0,5>::Buf[6] = {1.f,-1.f/2.f,1.f/4.f,
+  -1.f/8.f,1.f/16.f,-1.f/32.f};
+template<> const double MyFilter<double,3,3>::Buf[7] = {-1./16.,0.,9./16.,1.,
+  9./16.,0.,-1./16.};
+template<> const int16_t MyIntegerFilter<uint8_t,3,3,6>::Buf[7] = {-3,-9,30,
+  48,30,-9,-3};
+
+#define STREAMSIZE (1024*1024)
+
+//build with
+//g++ ./main.cpp -std=c++14 -O3 -mavx2 -mfma -o test -DUSE_AVX2
+//g++ ./main.cpp -std=c++14 -O3 -march=skylake-avx512 -o test -DUSE_AVX512
+//./test --json streaming.json
+
+/*
+ * Inputs are small integers, such that float results are exact with the
+ * dyadic coefficients above, whatever the multiply-adds the compiler fuses
+ */
+template<class FILT>
+bool Check(const FILT& filter, int size, int maxChunkSize) {
+  typedef typename FILT::ScalarType T;
+  std::vector<T> in(size);
+  std::generate(in.begin(), in.end(), []() {
+    return static_cast<T>(rand()%16); });
+  std::vector<T> control(size, T(0));
+  Convolution<FILT,UnalignedMemory,UnalignedMemory,ZeroBoundary>::
+    NaiveConvolve(filter, in.data(), control.data(), 0, size, size);
+
+  //One more element, that must not be written
+  std::vector<T> out(size+1, T(1));
+  StreamingConvolution<FILT> stream(filter, maxChunkSize);
+  bool isOK = true;
+  int pushed = 0, written = 0;
+  while (pushed < size) {
+    const int chunkSize = std::min(size-pushed, rand()%(2*maxChunkSize)+1);
+    const int count = stream.Push(in.data()+pushed, chunkSize,
+      out.data()+written);
+    pushed += chunkSize;
+    written += count;
+    //Every output whose inputs have all been pushed
+    isOK &= written == std::max(0, pushed-FILT::TapSizeRight);
+  }
+  written += stream.Flush(out.data()+written);
+  isOK &= written == size && out.back() == T(1) &&
+    std::equal(control.begin(), control.end(), out.begin());
+
+  //A second stream, after Flush, starts from zeros again
+  written = stream.Push(in.data(), size, out.data());
+  written += stream.Flush(out.data()+written);
+  isOK &= written == size &&
+    std::equal(control.begin(), control.end(), out.begin());
+  return isOK;
+}
+
+template<class FILT>
+bool CheckChunks(const FILT& filter) {
+  bool isOK = true;
+  for (int size : {1, 5, 100, 3000}) {
+    for (int maxChunkSize : {1, 3, 16, 100, 1000}) {
+      isOK &= Check(filter, size, maxChunkSize);
+    }
+  }
+  return isOK;
+}
+
+template<class FILT>
+bool CheckStatic() {
+  return CheckChunks(FILT());
+}
+
+void Benchmark(BenchmarkRunner& runner, const int chunkSize) {
+  typedef MyFilter<float,3,3> FILT;
+  std::vector<float,PackAllocator<float>> in(STREAMSIZE);
+  std::vector<float,PackAllocator<float>> out(STREAMSIZE);
+  std::generate(in.begin(), in.end(), []() {
+    return static_cast<float>(rand())/static_cast<float>(RAND_MAX); });
+  StreamingConvolution<FILT> stream(chunkSize);
+  const double bytes = 2.*sizeof(float)*STREAMSIZE;
+  const double flops = (2.*FILT::TapSize-1.)*STREAMSIZE;
+  const std::string name = "chunks of "+std::to_string(chunkSize);
+  const double refMsec = runner.Run(name+", convolve each chunk", [&]() {
+      for (int first = 0; first < STREAMSIZE; first += chunkSize) {
+        Convolution<FILT,UnalignedMemory,UnalignedMemory>::Convolve(
+          in.data()+first, out.data()+first, chunkSize);
+      }
+      ClobberMemory();
+    }, bytes, flops).median;
+  const double msec = runner.Run(name+", streaming", [&]() {
+      int written = 0;
+      for (int first = 0; first < STREAMSIZE; first += chunkSize) {
+        written += stream.Push(in.data()+first, chunkSize,
+          out.data()+written);
+      }
+      stream.Flush(out.data()+written);
+      ClobberMemory();
+    }, bytes, flops).median;
+  std::cout << "Overhead of streaming by " << name << " is "
+    << msec/refMsec << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  typedef RuntimeFilter<Filter<float,5,5>> Runtime;
+  const float coefficients[11] = {1.f/32.f,-2.f/32.f,3.f/32.f,-4.f/32.f,
+    5.f/32.f,1.f,5.f/32.f,-4.f/32.f,3.f/32.f,-2.f/32.f,1.f/32.f};
+  bool isOK = CheckStatic<MyFilter<float,1,1>>() &&
+    CheckStatic<MyFilter<float,3,3>>() &&
+    CheckStatic<MyFilter<float,2,4>>() &&
+    CheckStatic<MyFilter<float,7,0>>() &&
+    CheckStatic<MyFilter<float,0,5>>() &&
+    CheckStatic<MyFilter<double,3,3>>() &&
+    CheckStatic<MyIntegerFilter<uint8_t,3,3,6>>() &&
+    CheckChunks(Runtime(coefficients));
+  if (isOK) {
+    std::cout << "All streaming tests returned True Value" << std::endl;
+  } else {
+    std::cout << " WARNING : There may be a bug in streaming convolution"
+      << std::endl;
+  }
+
+  BenchmarkRunner runner(argc, argv);
+  Benchmark(runner, 256);
+  Benchmark(runner, 1024);
+  Benchmark(runner, 4096);
+  return runner.Finish() && isOK ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,10 +1,15 @@
 #ifndef SUBSAMPLEDCONCATANDCUT_H
 #define SUBSAMPLEDCONCATANDCUT_H
 
+// STL
+#include <type_traits>
+
 // Local
 #include "MetaHelper.h"
 #include "vectorization.h"
 
+VECTORIZATION_NAMESPACE_BEGIN
+
 template<typename T, class VecT, int SHIFT>
 struct SubsampledConcatAndCut {
   static VecT  Concat( VecT a, VecT b, VecT c) {
@@ -19,15 +24,19 @@ struct SubsampledConcatAndCut {
 template<>
 struct SubsampledConcatAndCut<float,__m128,0> {
   static __m128  Concat( __m128 a, __m128 b, __m128 c) {
-    return _mm_blend_ps( _mm_permute_ps(a,216),_mm_permute_ps(b,141),
-      0b00001100);
+    return Concat(a,b);
+  }
+  static __m128  Concat( __m128 a, __m128 b) {
+    return _mm_shuffle_ps(a,b,0b10001000);
   }
 };
 template<>
 struct SubsampledConcatAndCut<float,__m128,1> {
   static __m128  Concat( __m128 a, __m128 b, __m128 c) {
-    return _mm_blend_ps( _mm_permute_ps(a,141),_mm_permute_ps(b,216),
-      0b00001100);
+    return Concat(a,b);
+  }
+  static __m128  Concat( __m128 a, __m128 b) {
+    return _mm_shuffle_ps(a,b,0b11011101);
   }
 };
 template<>
@@ -49,18 +58,238 @@ struct SubsampledConcatAndCut<float,__m128,3> {
 template<>
 struct SubsampledConcatAndCut<double,__m128d,0> {
   static __m128d  Concat( __m128d a, __m128d b) {
-    return _mm_blend_pd( a,_mm_permute_pd(b,1),0b00000010);
+    return _mm_shuffle_pd(a,b,0b00);
   }
 };
 template<>
 struct SubsampledConcatAndCut<double,__m128d,1> {
   static __m128d  Concat( __m128d a, __m128d b) {
-    return _mm_blend_pd( _mm_permute_pd(a,1),b,0b00000010);
+    return _mm_shuffle_pd(a,b,0b11);
   }
 };
 #elif defined USE_AVX2
-
+/*
+ * Shifts 0 and 1 only need the pair a,b, other ones also pick the first
+ * elements of c
+ */
+template<>
+struct SubsampledConcatAndCut<float,__m256,0> {
+  static __m256  Concat( __m256 a, __m256 b, __m256 c) {
+    return Concat(a,b);
+  }
+  static __m256  Concat( __m256 a, __m256 b) {
+    return (__m256)_mm256_permute4x64_epi64((__m256i)
+      _mm256_shuffle_ps(a,b,0b10001000),216);
+  }
+};
+template<>
+struct SubsampledConcatAndCut<float,__m256,1> {
+  static __m256  Concat( __m256 a, __m256 b, __m256 c) {
+    return Concat(a,b);
+  }
+  static __m256  Concat( __m256 a, __m256 b) {
+    return (__m256)_mm256_permute4x64_epi64((__m256i)
+      _mm256_shuffle_ps(a,b,0b11011101),216);
+  }
+};
+template<>
+struct SubsampledConcatAndCut<float,__m256,2> {
+  static __m256  Concat( __m256 a, __m256 b, __m256 c) {
+    a=_mm256_permutevar8x32_ps(a,
+      _mm256_set_epi32(0,0,0,0,0,6,4,2));
+    b=_mm256_permutevar8x32_ps(b,
+      _mm256_set_epi32(0,6,4,2,0,0,0,0));
+    a=_mm256_blend_ps(a,b,0b01111000);
+    return _mm256_blend_ps(a,_mm256_permutevar8x32_ps(c,
+      _mm256_set_epi32(0,0,0,0,0,0,0,0)),0b10000000);
+  }
+};
+template<>
+struct SubsampledConcatAndCut<float,__m256,3> {
+  static __m256  Concat( __m256 a, __m256 b, __m256 c) {
+    a=_mm256_permutevar8x32_ps(a,
+      _mm256_set_epi32(0,0,0,0,0,7,5,3));
+    b=_mm256_permutevar8x32_ps(b,
+      _mm256_set_epi32(0,7,5,3,1,0,0,0));
+    a=_mm256_blend_ps(a,b,0b01111000);
+    return _mm256_blend_ps(a,_mm256_permutevar8x32_ps(c,
+      _mm256_set_epi32(1,0,0,0,0,0,0,0)),0b10000000);
+  }
+};
+template<>
+struct SubsampledConcatAndCut<float,__m256,4> {
+  static __m256  Concat( __m256 a, __m256 b, __m256 c) {
+    auto x = (__m256) _mm256_permute2x128_si256(
+      (__m256i)_mm256_permute_ps(a,0b11011000),
+      (__m256i)_mm256_permute_ps(c,0b10001101),97);
+    auto y = (__m256)_mm256_permute4x64_epi64((__m256i)
+      _mm256_permute_ps(b,0b10001101),180);
+    return _mm256_blend_ps(x,y,0b00111100);
+  }
+};
+template<>
+struct SubsampledConcatAndCut<float,__m256,5> {
+  static __m256  Concat( __m256 a, __m256 b, __m256 c) {
+    auto x = (__m256) _mm256_permute2x128_si256(
+      (__m256i)_mm256_permute_ps(a,0b10001101),
+      (__m256i)_mm256_permute_ps(c,0b11011000),97);
+    auto y = (__m256)_mm256_permute4x64_epi64((__m256i)
+      _mm256_permute_ps(b,0b11011000),180);
+    return _mm256_blend_ps(x,y,0b00111100);
+  }
+};
+template<>
+struct SubsampledConcatAndCut<float,__m256,6> {
+  static __m256  Concat( __m256 a, __m256 b, __m256 c) {
+    a=_mm256_permutevar8x32_ps(a,
+      _mm256_set_epi32(0,0,0,0,0,0,0,6));
+    b=_mm256_permutevar8x32_ps(b,
+      _mm256_set_epi32(0,0,0,6,4,2,0,0));
+    a=_mm256_blend_ps(a,b,0b00011110);
+    return _mm256_blend_ps(a,_mm256_permutevar8x32_ps(c,
+      _mm256_set_epi32(4,2,0,0,0,0,0,0)),0b11100000);
+  }
+};
+template<>
+struct SubsampledConcatAndCut<float,__m256,7> {
+  static __m256  Concat( __m256 a, __m256 b, __m256 c) {
+    a=_mm256_permutevar8x32_ps(a,
+      _mm256_set_epi32(0,0,0,0,0,0,0,7));
+    b=_mm256_permutevar8x32_ps(b,
+      _mm256_set_epi32(0,0,0,7,5,3,1,0));
+    a=_mm256_blend_ps(a,b,0b00011110);
+    return _mm256_blend_ps(a,_mm256_permutevar8x32_ps(c,
+      _mm256_set_epi32(5,3,1,0,0,0,0,0)),0b11100000);
+  }
+};
+template<>
+struct SubsampledConcatAndCut<double,__m256d,0> {
+  static __m256d  Concat( __m256d a, __m256d b, __m256d c) {
+    return Concat(a,b);
+  }
+  static __m256d  Concat( __m256d a, __m256d b) {
+    return (__m256d) _mm256_permute2x128_si256(
+      _mm256_permute4x64_epi64((__m256i)a,216),
+      _mm256_permute4x64_epi64((__m256i)b,141),48);
+  }
+};
+template<>
+struct SubsampledConcatAndCut<double,__m256d,1> {
+  static __m256d  Concat( __m256d a, __m256d b, __m256d c) {
+    return Concat(a,b);
+  }
+  static __m256d  Concat( __m256d a, __m256d b) {
+    return (__m256d) _mm256_permute2x128_si256(
+      _mm256_permute4x64_epi64((__m256i)a,141),
+      _mm256_permute4x64_epi64((__m256i)b,216),48);
+  }
+};
+template<>
+struct SubsampledConcatAndCut<double,__m256d,2> {
+  static __m256d  Concat( __m256d a, __m256d b, __m256d c) {
+    auto x = _mm256_permute2x128_si256((__m256i)a,(__m256i)c,97);
+    return _mm256_blend_pd((__m256d)_mm256_permute4x64_epi64(x,180),
+      (__m256d)_mm256_permute4x64_epi64((__m256i)b,225),0b0110);
+  }
+};
+template<>
+struct SubsampledConcatAndCut<double,__m256d,3> {
+  static __m256d  Concat( __m256d a, __m256d b, __m256d c) {
+    auto x = _mm256_permute2x128_si256((__m256i)a,(__m256i)c,97);
+    return _mm256_blend_pd((__m256d)_mm256_permute4x64_epi64(x,225),
+      (__m256d)_mm256_permute4x64_epi64((__m256i)b,180),0b0110);
+  }
+};
+#elif defined USE_AVX512
+/*
+ * vpermt2ps can pick any of the 32 elements of two vectors, such that all
+ * subsampling shifts are handled by the same code: a first permutation among
+ * a and b, then, if the subsampled pattern goes beyond b, a second one among
+ * b and c that is blended in using a k-mask
+ */
+template<int SHIFT>
+struct SubsampledConcatAndCut<float,__m512,SHIFT> {
+  static __m512  Concat( __m512 a, __m512 b, __m512 c) {
+    __m512 x = _mm512_permutex2var_ps(a,Index(0),b);
+    if (HighMask == 0) {
+      return x;
+    }
+    return _mm512_mask_blend_ps(HighMask,x,
+      _mm512_permutex2var_ps(b,Index(16),c));
+  }
+  static __m512  Concat( __m512 a, __m512 b) {
+    return _mm512_permutex2var_ps(a,Index(0),b);
+  }
+ protected:
+  //Index of the k-th subsampled element, relative to a vector pair
+  constexpr static int Idx( int k, int offset ) {
+    return (SHIFT+2*k-offset)&31;
+  }
+  static __m512i Index( int offset ) {
+    return _mm512_setr_epi32(Idx(0,offset),Idx(1,offset),Idx(2,offset),
+      Idx(3,offset),Idx(4,offset),Idx(5,offset),Idx(6,offset),Idx(7,offset),
+      Idx(8,offset),Idx(9,offset),Idx(10,offset),Idx(11,offset),
+      Idx(12,offset),Idx(13,offset),Idx(14,offset),Idx(15,offset));
+  }
+  //Elements that should be taken from c
+  constexpr static __mmask16 HighMask =
+    static_cast<__mmask16>((0xFFFF<<((33-SHIFT)/2))&0xFFFF);
+};
+template<int SHIFT>
+struct SubsampledConcatAndCut<double,__m512d,SHIFT> {
+  static __m512d  Concat( __m512d a, __m512d b, __m512d c) {
+    __m512d x = _mm512_permutex2var_pd(a,Index(0),b);
+    if (HighMask == 0) {
+      return x;
+    }
+    return _mm512_mask_blend_pd(HighMask,x,
+      _mm512_permutex2var_pd(b,Index(8),c));
+  }
+  static __m512d  Concat( __m512d a, __m512d b) {
+    return _mm512_permutex2var_pd(a,Index(0),b);
+  }
+ protected:
+  constexpr static long long Idx( int k, int offset ) {
+    return (SHIFT+2*k-offset)&15;
+  }
+  static __m512i Index( int offset ) {
+    return _mm512_setr_epi64(Idx(0,offset),Idx(1,offset),Idx(2,offset),
+      Idx(3,offset),Idx(4,offset),Idx(5,offset),Idx(6,offset),Idx(7,offset));
+  }
+  constexpr static __mmask8 HighMask =
+    static_cast<__mmask8>((0xFF<<((17-SHIFT)/2))&0xFF);
+};
 #elif defined USE_NEON
 
 #endif
+
+/*
+ * Even and odd elements of the consecutive vectors a,b, that is the two
+ * phases of a dyadic subsampling. Vectorized is false when there is no
+ * SubsampledConcatAndCut for VecT, Split must then not be used
+ */
+template<typename T, class VecT>
+struct DyadicSplit {
+#if defined USE_AVX || defined USE_AVX2 || defined USE_AVX512
+  constexpr static bool Vectorized = std::is_floating_point<T>::value;
+#else
+  constexpr static bool Vectorized = false;
+#endif
+  static void Split( VecT a, VecT b, VecT& even, VecT& odd ) {
+    even = SubsampledConcatAndCut<T,VecT,0>::Concat(a,b);
+    odd = SubsampledConcatAndCut<T,VecT,1>::Concat(a,b);
+  }
+};
+
+//Scalars are their own phases
+template<typename T>
+struct DyadicSplit<T,T> {
+  constexpr static bool Vectorized = true;
+  static void Split( T a, T b, T& even, T& odd ) {
+    even = a;
+    odd = b;
+  }
+};
+
+VECTORIZATION_NAMESPACE_END
 #endif //SUBSAMPLEDCONCATANDCUT_H
@@ -0,0 +1,216 @@
+#ifndef TRANSPOSEDCONVOLUTION_H
+#define TRANSPOSEDCONVOLUTION_H
+
+//STL
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+//Local
+#include "Convolution.h"
+
+VECTORIZATION_NAMESPACE_BEGIN
+
+/*
+ * Convolution of many short lines (a few vectors or less), with one line
+ * per vector lane: lines are processed by groups of VecSize, stored in lane
+ * layout, where element t of line s of a group is at t*VecSize+s.
+ * Each output vector is then the weighted sum of the TapSize input vectors
+ * around it, without any shuffle, such that a line of 8 elements runs at
+ * full vector width, while Convolution would process it with a single
+ * partial vector from its border buffer.
+ * - Convolve works on data that is already in lane layout, see ToLanes and
+ *   FromLanes
+ * - ConvolveBatch takes row-major lines, stride elements apart, and
+ *   transposes each group on the fly, to and from buffers that stay in the
+ *   L1 cache. The scalar transposes cost more than the convolution itself,
+ *   such that it only beats Convolution::ConvolveBatch up to about 16
+ *   elements per line, longer lines are better kept in lane layout
+ * Lines are extended with BOUNDARY_POLICY, as in Convolution
+ */
+template<class FILT, class BOUNDARY_POLICY=PeriodicBoundary>
+class TransposedConvolution {
+public:
+  static_assert(std::is_floating_point<typename FILT::ScalarType>::value,
+    "TransposedConvolution needs floating point filters");
+  typedef typename FILT::ScalarType T;
+  typedef typename FILT::VectorType VecT;
+  constexpr static int VecSize = FILT::VecSize;
+  constexpr static int TapSize = FILT::TapSize;
+
+  //Number of elements of the lane layout of nLines lines, that is padded to
+  //a whole number of groups
+  static std::size_t LaneSize(const int lineSize, const int nLines) {
+    return static_cast<std::size_t>((nLines+VecSize-1)/VecSize)*lineSize*
+      VecSize;
+  }
+
+  /*
+   * Row-major lines, stride elements apart, to lane layout. Lanes of the
+   * last group that do not hold a line are set to zero
+   */
+  static void ToLanes(const T* in, T* lanes, const int lineSize,
+      const int nLines, const int stride) {
+    const int nbGroup = (nLines+VecSize-1)/VecSize;
+    for (int group = 0; group < nbGroup; group++) {
+      Transpose(in+static_cast<std::ptrdiff_t>(group)*VecSize*stride, stride,
+        std::min(VecSize, nLines-group*VecSize), lanes+
+        static_cast<std::ptrdiff_t>(group)*lineSize*VecSize, lineSize);
+    }
+  }
+
+  static void FromLanes(const T* lanes, T* out, const int lineSize,
+      const int nLines, const int stride) {
+    const int nbGroup = (nLines+VecSize-1)/VecSize;
+    for (int group = 0; group < nbGroup; group++) {
+      Untranspose(lanes+static_cast<std::ptrdiff_t>(group)*lineSize*VecSize,
+        out+static_cast<std::ptrdiff_t>(group)*VecSize*stride, stride,
+        std::min(VecSize, nLines-group*VecSize), lineSize);
+    }
+  }
+
+  //in and out are in lane layout, and vector aligned
+  static void Convolve(const T* in, T* out, const int lineSize,
+      const int nLines) {
+    ConvolveGroups(FILT::Buf, in, out, lineSize, nLines, 0, false);
+  }
+
+  //Filter with runtime coefficients, see RuntimeFilter
+  static void Convolve(const FILT& filter, const T* in, T* out,
+      const int lineSize, const int nLines) {
+    ConvolveGroups(filter.Buf, in, out, lineSize, nLines, 0, false);
+  }
+
+  //in and out are row-major, lines being stride elements apart
+  static void ConvolveBatch(const T* in, T* out, const int lineSize,
+      const int nLines, const int stride) {
+    ConvolveGroups(FILT::Buf, in, out, lineSize, nLines, stride, true);
+  }
+
+  static void ConvolveBatch(const FILT& filter, const T* in, T* out,
+      const int lineSize, const int nLines, const int stride) {
+    ConvolveGroups(filter.Buf, in, out, lineSize, nLines, stride, true);
+  }
+
+protected:
+  /*
+   * Each thread extends a group at a time, in lane layout, into a buffer of
+   * lineSize+TapSize-1 vectors, the row of element j being given by
+   * BOUNDARY_POLICY, then computes the output vectors from it
+   */
+  static void ConvolveGroups(const typename FILT::CoefficientType* buf,
+      const T* in, T* out, const int lineSize, const int nLines,
+      const int stride, const bool rowMajor) {
+    if (lineSize <= 0 || nLines <= 0) {
+      return;
+    }
+    const int nbGroup = (nLines+VecSize-1)/VecSize;
+    const int extendedSize = lineSize+TapSize-1;
+    //Source element of each element of the extended line, -1 for a zero
+    std::vector<int> source(extendedSize);
+    for (int j = 0; j < extendedSize; j++) {
+      source[j] = BOUNDARY_POLICY::Index(j-FILT::TapSizeLeft, lineSize);
+    }
+
+    #pragma omp parallel
+    {
+      std::vector<T,PackAllocator<T>> extended(extendedSize*VecSize);
+      std::vector<T,PackAllocator<T>> lanes(rowMajor ? lineSize*VecSize : 0);
+      VecT coefs[TapSize];
+      for (int k = 0; k < TapSize; k++) {
+        coefs[k] = VecT() + buf[k];
+      }
+
+      #pragma omp for schedule(static)
+      for (int group = 0; group < nbGroup; group++) {
+        if (rowMajor) {
+          const std::ptrdiff_t offset = static_cast<std::ptrdiff_t>(group)*
+            VecSize*stride;
+          const int nbLine = std::min(VecSize, nLines-group*VecSize);
+          Transpose(in+offset, stride, nbLine, lanes.data(), lineSize);
+          Extend(lanes.data(), source.data(), extendedSize, extended.data());
+          ConvolveGroup(coefs, extended.data(), lanes.data(), lineSize);
+          Untranspose(lanes.data(), out+offset, stride, nbLine, lineSize);
+        } else {
+          const std::ptrdiff_t offset = static_cast<std::ptrdiff_t>(group)*
+            lineSize*VecSize;
+          Extend(in+offset, source.data(), extendedSize, extended.data());
+          ConvolveGroup(coefs, extended.data(), out+offset, lineSize);
+        }
+      }
+    }
+  }
+
+  //Extension of a group that is already in lane layout, by vector copies
+  static void Extend(const T* lanes, const int* source, const int size,
+      T* extended) {
+    for (int j = 0; j < size; j++) {
+      VectorizedMemOp<T,VecT>::store(extended+j*VecSize, source[j] < 0 ?
+        VecT()+T(0) : VectorizedMemOp<T,VecT>::load(lanes+source[j]*VecSize));
+    }
+  }
+
+  //nbLine row-major lines to a group in lane layout, other lanes are zero
+  static void Transpose(const T* in, const int stride, const int nbLine,
+      T* lanes, const int lineSize) {
+    if (nbLine < VecSize) {
+      std::fill(lanes, lanes+lineSize*VecSize, T(0));
+    }
+    for (int t = 0; t < lineSize; t++) {
+      for (int s = 0; s < nbLine; s++) {
+        lanes[t*VecSize+s] = in[static_cast<std::ptrdiff_t>(s)*stride+t];
+      }
+    }
+  }
+
+  static void Untranspose(const T* lanes, T* out, const int stride,
+      const int nbLine, const int lineSize) {
+    for (int s = 0; s < nbLine; s++) {
+      T* line = out+static_cast<std::ptrdiff_t>(s)*stride;
+      for (int t = 0; t < lineSize; t++) {
+        line[t] = lanes[t*VecSize+s];
+      }
+    }
+  }
+
+  static void ConvolveGroup(const VecT* coefs, const T* extended, T* out,
+      const int lineSize) {
+    for (int t = 0; t < lineSize; t++) {
+      VectorizedMemOp<T,VecT>::store(out+t*VecSize,
+        LaneSum(coefs, extended+t*VecSize));
+    }
+  }
+
+  //Weighted sum of TapSize consecutive vectors, see
+  //SeparableConvolution::VerticalSum for the folding of symmetric filters
+  static VecT LaneSum(const VecT* coefs, const T* window) {
+    if (FILT::Symmetry == FilterSymmetry::None || TapSize == 1) {
+      VecT acc = coefs[0]*VectorizedMemOp<T,VecT>::load(window);
+      for (int k = 1; k < TapSize; k++) {
+        acc += coefs[k]*VectorizedMemOp<T,VecT>::load(window+k*VecSize);
+      }
+      return acc;
+    }
+    VecT acc = coefs[0]*Fold(window, 0);
+    if (TapSize%2 == 1 && FILT::Symmetry == FilterSymmetry::Symmetric) {
+      acc += coefs[TapSize/2]*VectorizedMemOp<T,VecT>::load(
+        window+(TapSize/2)*VecSize);
+    }
+    for (int k = 1; k < TapSize/2; k++) {
+      acc += coefs[k]*Fold(window, k);
+    }
+    return acc;
+  }
+
+  static VecT Fold(const T* window, const int k) {
+    const VecT left = VectorizedMemOp<T,VecT>::load(window+k*VecSize);
+    const VecT right = VectorizedMemOp<T,VecT>::load(
+      window+(TapSize-1-k)*VecSize);
+    return FILT::Symmetry == FilterSymmetry::Symmetric ? left+right :
+      left-right;
+  }
+};
+
+VECTORIZATION_NAMESPACE_END
+#endif //TRANSPOSEDCONVOLUTION_H
@@ -0,0 +1,170 @@
+/*
+ * main.cpp
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: gnthibault
+ */
+
+//STL
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//Local
+#include "../TransposedConvolution.h"
+#include "../../Profiling/Benchmark.h"
+
+/*
+ * Millions of windows of 8 to 32 samples, such as sensor readings:
+ * TransposedConvolution, with one window per vector lane, is checked against
+ * NaiveConvolve on each window, then timed against Convolution, line by
+ * line and with ConvolveBatch, for a total of 1M elements per batch
+ */
+template<> const float MyFilter<float,1,1>::Buf[3] = {1.f/4.f,2.f/4.f,1.f/4.f};
+template<> const float MyFilter<float,3,3>::Buf[7] = {1.f/64.f,6.f/64.f,
+  15.f/64.f,20.f/64.f,15.f/64.f,6.f/64.f,1.f/64.f};
+template<> const float MyFilter<float,3,3,FilterSymmetry::Symmetric>::Buf[7] =
+  {1.f/64.f,6.f/64.f,15.f/64.f,20.f/64.f,15.f/64.f,6.f/64.f,1.f/64.f};
+template<> const float MyFilter<float,2,2,FilterSymmetry::Antisymmetric>::Buf[5]
+  = {1.f/8.f,2.f/8.f,0.f,-2.f/8.f,-1.f/8.f};
+template<> const float MyFilter<float,7,7>::Buf[15] = {1.f/16384.f,
+  14.f/16384.f,91.f/16384.f,364.f/16384.f,1001.f/16384.f,2002.f/16384.f,
+  3003.f/16384.f,3432.f/16384.f,3003.f/16384.f,2002.f/16384.f,1001.f/16384.f,
+  364.f/16384.f,91.f/16384.f,14.f/16384.f,1.f/16384.f};
+template<> const double MyFilter<double,3,3>::Buf[7] = {1./64.,6./64.,15./64.,
+  20./64.,15./64.,6./64.,1./64.};
+
+#define BATCHSIZE (1024*1024)
+
+//build with
+//g++ ./main.cpp -std=c++14 -O3 -mavx2 -mfma -fopenmp -o test -DUSE_AVX2
+//g++ ./main.cpp -std=c++14 -O3 -march=skylake-avx512 -fopenmp -o test -DUSE_AVX512
+//OMP_NUM_THREADS=4 ./test --json transposed.json
+
+/*
+ * Row-major and lane layout results must be the same as NaiveConvolve on
+ * each line, for any number of lines, that may not fill the last group.
+ * Inputs are small integers, such that results are exact with the dyadic
+ * coefficients above, whatever the multiply-adds the compiler fuses
+ */
+template<class FILT, class BOUNDARY>
+bool Check(int lineSize, int nLines, int stride) {
+  typedef typename FILT::ScalarType T;
+  typedef TransposedConvolution<FILT,BOUNDARY> Transposed;
+  std::vector<T,PackAllocator<T>> in(nLines*stride);
+  std::vector<T,PackAllocator<T>> out(in.size(), T(0));
+  std::vector<T,PackAllocator<T>> control(in.size(), T(0));
+  std::generate(in.begin(), in.end(), []() {
+    return static_cast<T>(rand()%16); });
+  for (int line = 0; line < nLines; line++) {
+    Convolution<FILT,UnalignedMemory,UnalignedMemory,BOUNDARY>::NaiveConvolve(
+      in.data()+line*stride, control.data()+line*stride, 0, lineSize,
+      lineSize);
+  }
+
+  Transposed::ConvolveBatch(in.data(), out.data(), lineSize, nLines, stride);
+  bool isOK = std::equal(control.begin(), control.end(), out.begin());
+
+  std::vector<T,PackAllocator<T>> lanesIn(
+    Transposed::LaneSize(lineSize, nLines));
+  std::vector<T,PackAllocator<T>> lanesOut(lanesIn.size());
+  std::fill(out.begin(), out.end(), T(0));
+  Transposed::ToLanes(in.data(), lanesIn.data(), lineSize, nLines, stride);
+  Transposed::Convolve(lanesIn.data(), lanesOut.data(), lineSize, nLines);
+  Transposed::FromLanes(lanesOut.data(), out.data(), lineSize, nLines,
+    stride);
+  isOK &= std::equal(control.begin(), control.end(), out.begin());
+
+  //Runtime coefficients
+  typedef RuntimeFilter<Filter<T,FILT::TapSizeLeft,FILT::TapSizeRight>>
+    Runtime;
+  std::fill(out.begin(), out.end(), T(0));
+  TransposedConvolution<Runtime,BOUNDARY>::ConvolveBatch(Runtime(FILT::Buf),
+    in.data(), out.data(), lineSize, nLines, stride);
+  isOK &= std::equal(control.begin(), control.end(), out.begin());
+  return isOK;
+}
+
+template<class FILT>
+bool CheckBoundaries(int lineSize, int nLines, int stride) {
+  return Check<FILT,PeriodicBoundary>(lineSize, nLines, stride) &&
+    Check<FILT,MirrorBoundary>(lineSize, nLines, stride) &&
+    Check<FILT,ClampBoundary>(lineSize, nLines, stride) &&
+    Check<FILT,ZeroBoundary>(lineSize, nLines, stride);
+}
+
+template<class FILT>
+void Benchmark(BenchmarkRunner& runner, int lineSize) {
+  typedef TransposedConvolution<FILT> Transposed;
+  const int nLines = BATCHSIZE/lineSize;
+  std::vector<float,PackAllocator<float>> in(BATCHSIZE);
+  std::vector<float,PackAllocator<float>> out(BATCHSIZE);
+  std::vector<float,PackAllocator<float>> lanesIn(
+    Transposed::LaneSize(lineSize, nLines));
+  std::vector<float,PackAllocator<float>> lanesOut(lanesIn.size());
+  std::generate(in.begin(), in.end(), []() {
+    return static_cast<float>(rand())/static_cast<float>(RAND_MAX); });
+  Transposed::ToLanes(in.data(), lanesIn.data(), lineSize, nLines, lineSize);
+  const double bytes = 2.*sizeof(float)*BATCHSIZE;
+  const double flops = (2.*FILT::TapSize-1.)*BATCHSIZE;
+  const std::string name = std::to_string(FILT::TapSize)+" taps, "+
+    std::to_string(nLines)+" lines of "+std::to_string(lineSize);
+  const double refMsec = runner.Run(name+", line by line", [&]() {
+      for (int line = 0; line < nLines; line++) {
+        Convolution<FILT,UnalignedMemory,UnalignedMemory>::Convolve(
+          in.data()+line*lineSize, out.data()+line*lineSize, lineSize);
+      }
+      ClobberMemory();
+    }, bytes, flops).median;
+  runner.Run(name+", batch", [&]() {
+      Convolution<FILT,UnalignedMemory,UnalignedMemory>::ConvolveBatch(
+        in.data(), out.data(), lineSize, nLines, lineSize);
+      ClobberMemory();
+    }, bytes, flops);
+  const double msec = runner.Run(name+", transposed batch", [&]() {
+      Transposed::ConvolveBatch(in.data(), out.data(), lineSize, nLines,
+        lineSize);
+      ClobberMemory();
+    }, bytes, flops).median;
+  const double lanesMsec = runner.Run(name+", lane layout", [&]() {
+      Transposed::Convolve(lanesIn.data(), lanesOut.data(), lineSize, nLines);
+      ClobberMemory();
+    }, bytes, flops).median;
+  std::cout << "Speedup of the transposed batch for " << name << " is "
+    << refMsec/msec << ", " << refMsec/lanesMsec << " in lane layout"
+    << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  bool isOK = true;
+  for (int lineSize : {1, 2, 5, 8, 16, 23, 32}) {
+    for (int nLines : {1, 7, 16, 33}) {
+      isOK &= CheckBoundaries<MyFilter<float,1,1>>(lineSize, nLines,
+        lineSize);
+      isOK &= CheckBoundaries<MyFilter<float,3,3,FilterSymmetry::Symmetric>>(
+        lineSize, nLines, lineSize+3);
+      isOK &= CheckBoundaries<MyFilter<float,2,2,
+        FilterSymmetry::Antisymmetric>>(lineSize, nLines, lineSize);
+      isOK &= CheckBoundaries<MyFilter<float,7,7>>(lineSize, nLines,
+        lineSize+1);
+      isOK &= CheckBoundaries<MyFilter<double,3,3>>(lineSize, nLines,
+        lineSize);
+    }
+  }
+  if (isOK) {
+    std::cout << "All transposed tests returned True Value" << std::endl;
+  } else {
+    std::cout << " WARNING : There may be a bug in transposed convolution"
+      << std::endl;
+  }
+
+  BenchmarkRunner runner(argc, argv);
+  for (int lineSize : {8, 16, 32}) {
+    Benchmark<MyFilter<float,1,1>>(runner, lineSize);
+    Benchmark<MyFilter<float,3,3>>(runner, lineSize);
+    Benchmark<MyFilter<float,7,7>>(runner, lineSize);
+  }
+  return runner.Finish() && isOK ? EXIT_SUCCESS : EXIT_FAILURE;
+}
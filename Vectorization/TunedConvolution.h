@@ -0,0 +1,216 @@
+#ifndef TUNEDCONVOLUTION_H
+#define TUNEDCONVOLUTION_H
+
+//STL
+#include <atomic>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+//Local
+#include "Autotuner.h"
+#include "Convolution.h"
+
+#define VECTORIZATION_STRINGIFY(x) VECTORIZATION_STRINGIFY_IMPL(x)
+#define VECTORIZATION_STRINGIFY_IMPL(x) #x
+
+VECTORIZATION_NAMESPACE_BEGIN
+
+/*
+ * Convolution of a floating point filter whose implementation is picked by
+ * Autotuner on the first line of each size bucket, [2^b,2^(b+1)), among:
+ * - kernel: the rotating window of Convolution, only below LongTapSize,
+ *   that Convolution forwards to FftConvolution anyway
+ * - multi-output: the runtime loop of FftConvolution::ConvolveDirect, that
+ *   sums NbAccumulator output vectors at once
+ * - fft: the overlap-save path of FftConvolution, from 16 taps
+ * - scalar: one output at a time on the extended line, for the cases where
+ *   the setup of the vector paths costs more than it saves
+ * The vector width and the use of FMA are fixed at compile time by the
+ * instruction set namespace and -mfma, which is why the key of a decision,
+ * "isa/type/TapSizeLeft/TapSizeRight/symmetry/filter/bucket", names the
+ * instruction set: a binary built for several of them, see RuntimeDispatch,
+ * tunes each one apart.
+ * Tuning runs on the line of the call, and the decision is then read from
+ * a per bucket atomic, such that later calls only pay for a load
+ */
+template<class FILT, class BOUNDARY_POLICY=PeriodicBoundary>
+class TunedConvolution {
+public:
+  static_assert(std::is_floating_point<typename FILT::ScalarType>::value,
+    "TunedConvolution needs floating point filters");
+  typedef typename FILT::ScalarType T;
+  //Line sizes up to 2^NbBucket-1 have a bucket of their own
+  constexpr static int NbBucket = 31;
+
+  static void Convolve(const T* in, T* out, const int lineSize) {
+    Convolve(FILT(), in, out, lineSize);
+  }
+
+  //Filter with runtime coefficients, see RuntimeFilter
+  static void Convolve(const FILT& filter, const T* in, T* out,
+      const int lineSize) {
+    if (lineSize <= 0) {
+      return;
+    }
+    std::atomic<int>& choice = Choices()[Bucket(lineSize)];
+    int variant = choice.load(std::memory_order_relaxed);
+    if (variant < 0) {
+      variant = Autotuner::Select(Key(lineSize), Names(),
+        [&](const int i) { Candidates()[i].run(filter, in, out, lineSize); });
+      choice.store(variant, std::memory_order_relaxed);
+    }
+    Candidates()[variant].run(filter, in, out, lineSize);
+  }
+
+  //Variants that may be picked, in the order given to Autotuner
+  static const std::vector<std::string>& Names() {
+    static const std::vector<std::string> names = [] {
+      std::vector<std::string> list;
+      for (const Candidate& candidate : Candidates()) {
+        list.push_back(candidate.name);
+      }
+      return list;
+    }();
+    return names;
+  }
+
+  //Name of the variant used for lineSize, empty until it has been tuned
+  static std::string Variant(const int lineSize) {
+    const int variant = Choices()[Bucket(lineSize)].load(
+      std::memory_order_relaxed);
+    return variant < 0 ? std::string() : Names()[variant];
+  }
+
+  //Variant given by name, whatever the tuning, for checks and benchmarks
+  static void Run(const std::string& name, const FILT& filter, const T* in,
+      T* out, const int lineSize) {
+    for (const Candidate& candidate : Candidates()) {
+      if (candidate.name == name) {
+        candidate.run(filter, in, out, lineSize);
+      }
+    }
+  }
+
+  static std::string Key(const int lineSize) {
+    const char* symmetry[] = {"none", "symmetric", "antisymmetric"};
+    return std::string(VECTORIZATION_STRINGIFY(VECTORIZATION_ISA))+"/"+
+      (sizeof(T) == sizeof(float) ? "float" : "double")+"/"+
+      std::to_string(FILT::TapSizeLeft)+"/"+
+      std::to_string(FILT::TapSizeRight)+"/"+
+      symmetry[static_cast<int>(FILT::Symmetry)]+"/"+
+      (IsRuntime<FILT>(0) ? "runtime" : "static")+"/"+
+      std::to_string(1L << Bucket(lineSize));
+  }
+
+  //Forget the decisions of this filter, such that the next calls read
+  //TuningCache again
+  static void Reset() {
+    for (int b = 0; b < NbBucket; b++) {
+      Choices()[b].store(-1, std::memory_order_relaxed);
+    }
+  }
+
+protected:
+  typedef Convolution<FILT,UnalignedMemory,UnalignedMemory,BOUNDARY_POLICY>
+    Kernel;
+  typedef FftConvolution<FILT,BOUNDARY_POLICY> LongConvolution;
+
+  struct Candidate {
+    const char* name;
+    void (*run)(const FILT&, const T*, T*, int);
+  };
+
+  static int Bucket(const int lineSize) {
+    int bucket = 0;
+    while (bucket+1 < NbBucket && (lineSize >> (bucket+1)) > 0) {
+      bucket++;
+    }
+    return bucket;
+  }
+
+  static std::atomic<int>* Choices() {
+    static std::atomic<int> choices[NbBucket];
+    static const bool initialized = [] {
+      for (int b = 0; b < NbBucket; b++) {
+        choices[b].store(-1, std::memory_order_relaxed);
+      }
+      return true;
+    }();
+    (void)initialized;
+    return choices;
+  }
+
+  static const std::vector<Candidate>& Candidates() {
+    static const std::vector<Candidate> candidates = [] {
+      std::vector<Candidate> list;
+      if (FILT::TapSize < Kernel::LongTapSize) {
+        list.push_back(Candidate{"kernel", &RunKernel});
+      }
+      list.push_back(Candidate{"multi-output", &RunDirect});
+      if (FILT::TapSize >= 16) {
+        list.push_back(Candidate{"fft", &RunFft});
+      }
+      list.push_back(Candidate{"scalar", &RunScalar});
+      return list;
+    }();
+    return candidates;
+  }
+
+  //Runtime filters have Broadcast, static ones are read from FILT::Buf
+  template<class F>
+  constexpr static auto IsRuntime(int) ->
+      decltype(std::declval<F>().Broadcast(), bool()) {
+    return true;
+  }
+
+  template<class F>
+  constexpr static bool IsRuntime(long) {
+    return false;
+  }
+
+  static void RunKernel(const FILT& filter, const T* in, T* out,
+      const int lineSize) {
+    KernelConvolve(filter, in, out, lineSize, 0);
+  }
+
+  template<class F>
+  static auto KernelConvolve(const F& filter, const T* in, T* out,
+      const int lineSize, int) -> decltype(filter.Broadcast(), void()) {
+    Kernel::Convolve(filter, in, out, lineSize);
+  }
+
+  template<class F>
+  static void KernelConvolve(const F&, const T* in, T* out,
+      const int lineSize, long) {
+    Kernel::Convolve(in, out, lineSize);
+  }
+
+  static void RunDirect(const FILT& filter, const T* in, T* out,
+      const int lineSize) {
+    LongConvolution::ConvolveDirect(filter, in, out, lineSize);
+  }
+
+  static void RunFft(const FILT& filter, const T* in, T* out,
+      const int lineSize) {
+    LongConvolution::ConvolveFft(filter, in, out, lineSize);
+  }
+
+  static void RunScalar(const FILT& filter, const T* in, T* out,
+      const int lineSize) {
+    PERF_SCOPE("TunedConvolution::Scalar");
+    std::vector<T> extended(lineSize+FILT::TapSize-1);
+    BOUNDARY_POLICY::Extend(in, lineSize, -FILT::TapSizeLeft,
+      extended.data(), static_cast<int>(extended.size()));
+    for (int i = 0; i < lineSize; i++) {
+      T sum = T(0);
+      for (int k = 0; k < FILT::TapSize; k++) {
+        sum += filter.Buf[k]*extended[i+k];
+      }
+      out[i] = sum;
+    }
+  }
+};
+
+VECTORIZATION_NAMESPACE_END
+#endif //TUNEDCONVOLUTION_H
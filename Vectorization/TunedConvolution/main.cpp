@@ -0,0 +1,212 @@
+/*
+ * main.cpp
+ *
+ *  Created on: 17 oct. 2026
+ *      Author: gnthibault
+ */
+
+//STL
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//Local
+#include "../TunedConvolution.h"
+#include "../../Profiling/Benchmark.h"
+
+/*
+ * Every variant of TunedConvolution is checked against NaiveConvolve,
+ * exactly but for the FFT, then the decisions of the tuner are checked to
+ * be persisted and read back from the tuning file. Tuned convolutions are
+ * finally timed against Convolution::Convolve, for short and long filters
+ */
+template<> const float MyFilter<float,3,3>::Buf[7] = {-1.f/16.f,0.f,
+  9.f/16.f,1.f,9.f/16.f,0.f,-1.f/16.f};
+template<> const double MyFilter<double,2,4>::Buf[7] = {-1./8.,2./8.,3./8.,
+  5./8.,-3./8.,1./8.,1./8.};
+
+#define TUNING_FILE "tunedconvolution_tuning.txt"
+
+//build with
+//g++ ./main.cpp -std=c++14 -O3 -mavx2 -mfma -o test -DUSE_AVX2
+//g++ ./main.cpp -std=c++14 -O3 -march=skylake-avx512 -o test -DUSE_AVX512
+//./test --json tunedconvolution.json
+
+//Dyadic coefficients, such that sums of small integers are exact, mirrored
+//for symmetric filters
+template<class FILT>
+FILT RandomFilter() {
+  typedef typename FILT::ScalarType T;
+  std::vector<T> coefficients(FILT::TapSize);
+  std::generate(coefficients.begin(), coefficients.end(), []() {
+    return static_cast<T>(rand()%129-64)/T(64); });
+  if (FILT::Symmetry == FilterSymmetry::Symmetric) {
+    std::copy(coefficients.begin(), coefficients.begin()+FILT::TapSize/2,
+      coefficients.rbegin());
+  }
+  return FILT(coefficients.data());
+}
+
+template<typename T>
+bool Near(const std::vector<T>& control, const std::vector<T>& out,
+    const T* buf, const int tapSize, const T maxInput) {
+  T bound = T(0);
+  for (int k = 0; k < tapSize; k++) {
+    bound += std::abs(buf[k]);
+  }
+  const T tolerance = (sizeof(T) == sizeof(float) ? T(1e-5) : T(1e-13))*
+    bound*maxInput;
+  for (std::size_t i = 0; i < control.size(); i++) {
+    if (!(std::abs(control[i]-out[i]) <= tolerance)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template<class FILT, class BOUNDARY>
+bool Check(const FILT& filter, int size) {
+  typedef typename FILT::ScalarType T;
+  typedef TunedConvolution<FILT,BOUNDARY> Tuned;
+  std::vector<T> in(size);
+  std::generate(in.begin(), in.end(), []() {
+    return static_cast<T>(rand()%16-8); });
+  std::vector<T> control(size, T(0));
+  Convolution<FILT,UnalignedMemory,UnalignedMemory,BOUNDARY>::NaiveConvolve(
+    filter, in.data(), control.data(), 0, size, size);
+
+  bool isOK = true;
+  //One more element, that must not be written
+  std::vector<T> out(size+1);
+  for (const std::string& name : Tuned::Names()) {
+    std::fill(out.begin(), out.end(), T(-1));
+    Tuned::Run(name, filter, in.data(), out.data(), size);
+    if (name == "fft") {
+      isOK &= Near(control, out, filter.Buf, FILT::TapSize, T(8));
+    } else {
+      isOK &= std::equal(control.begin(), control.end(), out.begin());
+    }
+    isOK &= out.back() == T(-1);
+  }
+  std::fill(out.begin(), out.end(), T(-1));
+  Tuned::Convolve(filter, in.data(), out.data(), size);
+  isOK &= Near(control, out, filter.Buf, FILT::TapSize, T(8)) &&
+    out.back() == T(-1) && !Tuned::Variant(size).empty();
+  return isOK;
+}
+
+template<class FILT>
+bool CheckBoundaries(const FILT& filter) {
+  bool isOK = true;
+  for (int size : {1, 7, 100, 1000, 20000}) {
+    isOK &= Check<FILT,PeriodicBoundary>(filter, size) &&
+      Check<FILT,MirrorBoundary>(filter, size) &&
+      Check<FILT,ZeroBoundary>(filter, size);
+  }
+  return isOK;
+}
+
+/*
+ * The decision of the previous checks must be in the file, and be the one
+ * used once the tuner has forgotten everything it had in memory
+ */
+bool CheckPersistence() {
+  typedef MyFilter<float,3,3> FILT;
+  typedef TunedConvolution<FILT> Tuned;
+  const int size = 1000;
+  const std::string key = Tuned::Key(size);
+  const std::string variant = Tuned::Variant(size);
+  bool isOK = !variant.empty() && TuningCache::Instance().Find(key) == variant;
+  TuningCache::Instance().Clear();
+  isOK &= TuningCache::Instance().Find(key).empty();
+  TuningCache::Instance().Reload();
+  isOK &= TuningCache::Instance().Find(key) == variant;
+
+  Tuned::Reset();
+  std::vector<float> in(size, 1.f), out(size);
+  Tuned::Convolve(in.data(), out.data(), size);
+  isOK &= Tuned::Variant(size) == variant;
+  return isOK;
+}
+
+//Convolution::Convolve, with runtime or static coefficients
+template<class FILT>
+auto Reference(const FILT& filter, const typename FILT::ScalarType* in,
+    typename FILT::ScalarType* out, const int lineSize, int) ->
+    decltype(filter.Broadcast(), void()) {
+  Convolution<FILT,UnalignedMemory,UnalignedMemory>::Convolve(filter, in,
+    out, lineSize);
+}
+
+template<class FILT>
+void Reference(const FILT&, const typename FILT::ScalarType* in,
+    typename FILT::ScalarType* out, const int lineSize, long) {
+  Convolution<FILT,UnalignedMemory,UnalignedMemory>::Convolve(in, out,
+    lineSize);
+}
+
+template<class FILT>
+void Benchmark(BenchmarkRunner& runner, const FILT& filter,
+    const std::string& filterName) {
+  typedef typename FILT::ScalarType T;
+  typedef TunedConvolution<FILT> Tuned;
+  for (int lineSize : {1 << 8, 1 << 12, 1 << 16, 1 << 20}) {
+    std::vector<T,PackAllocator<T>> in(lineSize);
+    std::vector<T,PackAllocator<T>> out(lineSize);
+    std::generate(in.begin(), in.end(), []() {
+      return static_cast<T>(rand())/static_cast<T>(RAND_MAX); });
+    const double bytes = 2.*sizeof(T)*lineSize;
+    const double flops = (2.*FILT::TapSize-1.)*lineSize;
+    const std::string name = filterName+", "+std::to_string(lineSize)+
+      " elements";
+    const double refMsec = runner.Run(name+", convolution", [&]() {
+        Reference(filter, in.data(), out.data(), lineSize, 0);
+        ClobberMemory();
+      }, bytes, flops).median;
+    //First call tunes
+    Tuned::Convolve(filter, in.data(), out.data(), lineSize);
+    const double msec = runner.Run(name+", tuned", [&]() {
+        Tuned::Convolve(filter, in.data(), out.data(), lineSize);
+        ClobberMemory();
+      }, bytes, flops).median;
+    std::cout << "Tuned " << name << " uses " << Tuned::Variant(lineSize)
+      << ", speedup is " << refMsec/msec << std::endl;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  //Start from an empty tuning file, before the first use of TuningCache
+  std::remove(TUNING_FILE);
+  setenv("VECTORIZATION_TUNING_FILE", TUNING_FILE, 1);
+
+  typedef RuntimeFilter<Filter<float,10,9>> Runtime20;
+  typedef RuntimeFilter<Filter<float,20,20,FilterSymmetry::Symmetric>>
+    Runtime41;
+  typedef RuntimeFilter<Filter<double,31,32>> Runtime64;
+  bool isOK = CheckBoundaries(MyFilter<float,3,3>()) &&
+    CheckBoundaries(MyFilter<double,2,4>()) &&
+    CheckBoundaries(RandomFilter<Runtime20>()) &&
+    CheckBoundaries(RandomFilter<Runtime41>()) &&
+    CheckBoundaries(RandomFilter<Runtime64>()) &&
+    CheckPersistence();
+  if (isOK) {
+    std::cout << "All tuned convolution tests returned True Value"
+      << std::endl;
+  } else {
+    std::cout << " WARNING : There may be a bug in tuned convolution"
+      << std::endl;
+  }
+
+  BenchmarkRunner runner(argc, argv);
+  Benchmark(runner, MyFilter<float,3,3>(), "float, 7 taps");
+  Benchmark(runner, RandomFilter<Runtime20>(), "float, 20 taps");
+  Benchmark(runner, RandomFilter<RuntimeFilter<Filter<float,63,64>>>(),
+    "float, 128 taps");
+  Benchmark(runner, RandomFilter<Runtime64>(), "double, 64 taps");
+  std::remove(TUNING_FILE);
+  return runner.Finish() && isOK ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,111 @@
+#ifndef UPSAMPLEDCONCATANDCUT_H
+#define UPSAMPLEDCONCATANDCUT_H
+
+// Local
+#include "vectorization.h"
+
+VECTORIZATION_NAMESPACE_BEGIN
+
+/*
+ * Inverse of DyadicSplit (see SubsampledConcatAndCut.h): interleaves even
+ * and odd, a receives the first VecSize elements of the merged sequence,
+ * and b the next ones. Vectorized is false when there is no implementation
+ * for VecT, Merge must then not be used
+ */
+template<typename T, class VecT>
+struct DyadicMerge {
+  constexpr static bool Vectorized = false;
+};
+
+template<typename T>
+struct DyadicMerge<T,T> {
+  constexpr static bool Vectorized = true;
+  static void Merge( T even, T odd, T& a, T& b ) {
+    a = even;
+    b = odd;
+  }
+};
+
+#ifdef USE_AVX
+template<>
+struct DyadicMerge<float,__m128> {
+  constexpr static bool Vectorized = true;
+  static void Merge( __m128 even, __m128 odd, __m128& a, __m128& b ) {
+    a = _mm_unpacklo_ps(even,odd);
+    b = _mm_unpackhi_ps(even,odd);
+  }
+};
+template<>
+struct DyadicMerge<double,__m128d> {
+  constexpr static bool Vectorized = true;
+  static void Merge( __m128d even, __m128d odd, __m128d& a, __m128d& b ) {
+    a = _mm_unpacklo_pd(even,odd);
+    b = _mm_unpackhi_pd(even,odd);
+  }
+};
+#elif defined USE_AVX2
+//unpack works within 128 bits lanes, that are then reordered
+template<>
+struct DyadicMerge<float,__m256> {
+  constexpr static bool Vectorized = true;
+  static void Merge( __m256 even, __m256 odd, __m256& a, __m256& b ) {
+    const __m256 low = _mm256_unpacklo_ps(even,odd);
+    const __m256 high = _mm256_unpackhi_ps(even,odd);
+    a = _mm256_permute2f128_ps(low,high,0x20);
+    b = _mm256_permute2f128_ps(low,high,0x31);
+  }
+};
+template<>
+struct DyadicMerge<double,__m256d> {
+  constexpr static bool Vectorized = true;
+  static void Merge( __m256d even, __m256d odd, __m256d& a, __m256d& b ) {
+    const __m256d low = _mm256_unpacklo_pd(even,odd);
+    const __m256d high = _mm256_unpackhi_pd(even,odd);
+    a = _mm256_permute2f128_pd(low,high,0x20);
+    b = _mm256_permute2f128_pd(low,high,0x31);
+  }
+};
+#elif defined USE_AVX512
+template<>
+struct DyadicMerge<float,__m512> {
+  constexpr static bool Vectorized = true;
+  static void Merge( __m512 even, __m512 odd, __m512& a, __m512& b ) {
+    a = _mm512_permutex2var_ps(even,_mm512_setr_epi32(0,16,1,17,2,18,3,19,
+      4,20,5,21,6,22,7,23),odd);
+    b = _mm512_permutex2var_ps(even,_mm512_setr_epi32(8,24,9,25,10,26,11,27,
+      12,28,13,29,14,30,15,31),odd);
+  }
+};
+template<>
+struct DyadicMerge<double,__m512d> {
+  constexpr static bool Vectorized = true;
+  static void Merge( __m512d even, __m512d odd, __m512d& a, __m512d& b ) {
+    a = _mm512_permutex2var_pd(even,_mm512_setr_epi64(0,8,1,9,2,10,3,11),
+      odd);
+    b = _mm512_permutex2var_pd(even,_mm512_setr_epi64(4,12,5,13,6,14,7,15),
+      odd);
+  }
+};
+#endif
+
+/*
+ * Dyadic upsampling of the elements of a, by zero insertion: with PHASE 0,
+ * low is a0 0 a1 0 ... and high goes on with the second half of a, PHASE 1
+ * puts the elements of a at odd positions instead, 0 a0 0 a1 ...
+ */
+template<typename T, class VecT, int PHASE>
+struct UpsampledConcatAndCut {
+  static_assert(PHASE == 0 || PHASE == 1, "Dyadic upsampling has 2 phases");
+  constexpr static bool Vectorized = DyadicMerge<T,VecT>::Vectorized;
+  static void Concat( VecT a, VecT& low, VecT& high ) {
+    const VecT zero = VecT() + T(0);
+    if (PHASE == 0) {
+      DyadicMerge<T,VecT>::Merge(a,zero,low,high);
+    } else {
+      DyadicMerge<T,VecT>::Merge(zero,a,low,high);
+    }
+  }
+};
+
+VECTORIZATION_NAMESPACE_END
+#endif //UPSAMPLEDCONCATANDCUT_H
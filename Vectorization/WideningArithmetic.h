@@ -0,0 +1,217 @@
+#ifndef WIDENINGARITHMETIC_H
+#define WIDENINGARITHMETIC_H
+
+// STL
+#include <cstdint>
+
+// Local
+#include "vectorization.h"
+
+VECTORIZATION_NAMESPACE_BEGIN
+
+/*
+ * Integer building blocks needed to compute on 8 and 16 bits pixels without
+ * overflow: elements are widened to 16 bits, multiplied by pairs of 16 bits
+ * coefficients and summed into 32 bits (pmaddwd), then narrowed back with
+ * saturation on store.
+ * Unpack and pack instructions work inside 128 bits lanes, as long as each
+ * unpack is reverted by the matching pack, the elements order is preserved
+ */
+template<class VecT>
+class WideningOps {};
+
+#ifdef USE_AVX
+template<>
+class WideningOps<__m128i> {
+ public:
+  static __m128i Zero() { return _mm_setzero_si128(); }
+  static __m128i Set1_32( int32_t value ) { return _mm_set1_epi32(value); }
+  static __m128i UnpackLo8( __m128i a, __m128i b ) {
+    return _mm_unpacklo_epi8(a,b);
+  }
+  static __m128i UnpackHi8( __m128i a, __m128i b ) {
+    return _mm_unpackhi_epi8(a,b);
+  }
+  static __m128i UnpackLo16( __m128i a, __m128i b ) {
+    return _mm_unpacklo_epi16(a,b);
+  }
+  static __m128i UnpackHi16( __m128i a, __m128i b ) {
+    return _mm_unpackhi_epi16(a,b);
+  }
+  //a0*b0+a1*b1 for each pair of 16 bits elements, into 32 bits
+  static __m128i MulAddPairs( __m128i a, __m128i b ) {
+    return _mm_madd_epi16(a,b);
+  }
+  static __m128i Add32( __m128i a, __m128i b ) { return _mm_add_epi32(a,b); }
+  template<int SHIFT>
+  static __m128i ShiftRight32( __m128i a ) { return _mm_srai_epi32(a,SHIFT); }
+  static __m128i PackSigned32( __m128i a, __m128i b ) {
+    return _mm_packs_epi32(a,b);
+  }
+  static __m128i PackUnsigned16( __m128i a, __m128i b ) {
+    return _mm_packus_epi16(a,b);
+  }
+};
+#elif defined USE_AVX2
+template<>
+class WideningOps<__m256i> {
+ public:
+  static __m256i Zero() { return _mm256_setzero_si256(); }
+  static __m256i Set1_32( int32_t value ) { return _mm256_set1_epi32(value); }
+  static __m256i UnpackLo8( __m256i a, __m256i b ) {
+    return _mm256_unpacklo_epi8(a,b);
+  }
+  static __m256i UnpackHi8( __m256i a, __m256i b ) {
+    return _mm256_unpackhi_epi8(a,b);
+  }
+  static __m256i UnpackLo16( __m256i a, __m256i b ) {
+    return _mm256_unpacklo_epi16(a,b);
+  }
+  static __m256i UnpackHi16( __m256i a, __m256i b ) {
+    return _mm256_unpackhi_epi16(a,b);
+  }
+  static __m256i MulAddPairs( __m256i a, __m256i b ) {
+    return _mm256_madd_epi16(a,b);
+  }
+  static __m256i Add32( __m256i a, __m256i b ) {
+    return _mm256_add_epi32(a,b);
+  }
+  template<int SHIFT>
+  static __m256i ShiftRight32( __m256i a ) {
+    return _mm256_srai_epi32(a,SHIFT);
+  }
+  static __m256i PackSigned32( __m256i a, __m256i b ) {
+    return _mm256_packs_epi32(a,b);
+  }
+  static __m256i PackUnsigned16( __m256i a, __m256i b ) {
+    return _mm256_packus_epi16(a,b);
+  }
+};
+#elif defined USE_AVX512
+#ifdef __AVX512BW__
+template<>
+class WideningOps<__m512i> {
+ public:
+  static __m512i Zero() { return _mm512_setzero_si512(); }
+  static __m512i Set1_32( int32_t value ) { return _mm512_set1_epi32(value); }
+  static __m512i UnpackLo8( __m512i a, __m512i b ) {
+    return _mm512_unpacklo_epi8(a,b);
+  }
+  static __m512i UnpackHi8( __m512i a, __m512i b ) {
+    return _mm512_unpackhi_epi8(a,b);
+  }
+  static __m512i UnpackLo16( __m512i a, __m512i b ) {
+    return _mm512_unpacklo_epi16(a,b);
+  }
+  static __m512i UnpackHi16( __m512i a, __m512i b ) {
+    return _mm512_unpackhi_epi16(a,b);
+  }
+  static __m512i MulAddPairs( __m512i a, __m512i b ) {
+    return _mm512_madd_epi16(a,b);
+  }
+  static __m512i Add32( __m512i a, __m512i b ) {
+    return _mm512_add_epi32(a,b);
+  }
+  template<int SHIFT>
+  static __m512i ShiftRight32( __m512i a ) {
+    return _mm512_srai_epi32(a,SHIFT);
+  }
+  static __m512i PackSigned32( __m512i a, __m512i b ) {
+    return _mm512_packs_epi32(a,b);
+  }
+  static __m512i PackUnsigned16( __m512i a, __m512i b ) {
+    return _mm512_packus_epi16(a,b);
+  }
+};
+#endif //__AVX512BW__
+#endif
+
+/*
+ * Multiply accumulate of two vectors of T, a and b, by a pair of 16 bits
+ * coefficients (c0,c1), into NbAccumulator vectors of 32 bits integers:
+ * acc += c0*a + c1*b
+ * Finalize rounds the accumulators, shifts them right by SHIFT bits, and
+ * packs them back into a single vector of T with saturation.
+ * We use pmaddwd on zero/sign extended elements rather than pmaddubsw, that
+ * saturates its 16 bits pair sums, and thus is not exact for arbitrary
+ * coefficients.
+ */
+template<typename T, class VecT>
+class WideningMultiplyAccumulate {};
+
+template<class VecT>
+class WideningMultiplyAccumulate<uint8_t,VecT> {
+ public:
+  //Each 8 bits vector spans 4 vectors of 32 bits
+  constexpr static int NbAccumulator = 4;
+
+  static VecT Coefficients( int16_t c0, int16_t c1 ) {
+    return Ops::Set1_32( static_cast<int32_t>(static_cast<uint16_t>(c0) |
+      (static_cast<uint32_t>(static_cast<uint16_t>(c1)) << 16)) );
+  }
+
+  static void Accumulate( VecT a, VecT b, VecT coefs, VecT* acc ) {
+    //Zero extension to 16 bits
+    VecT aLo = Ops::UnpackLo8( a, Ops::Zero() );
+    VecT aHi = Ops::UnpackHi8( a, Ops::Zero() );
+    VecT bLo = Ops::UnpackLo8( b, Ops::Zero() );
+    VecT bHi = Ops::UnpackHi8( b, Ops::Zero() );
+    //Interleave a and b, such that each 32 bits element holds the pair
+    acc[0] = Ops::Add32( acc[0],
+      Ops::MulAddPairs( Ops::UnpackLo16( aLo, bLo ), coefs ) );
+    acc[1] = Ops::Add32( acc[1],
+      Ops::MulAddPairs( Ops::UnpackHi16( aLo, bLo ), coefs ) );
+    acc[2] = Ops::Add32( acc[2],
+      Ops::MulAddPairs( Ops::UnpackLo16( aHi, bHi ), coefs ) );
+    acc[3] = Ops::Add32( acc[3],
+      Ops::MulAddPairs( Ops::UnpackHi16( aHi, bHi ), coefs ) );
+  }
+
+  template<int SHIFT>
+  static VecT Finalize( VecT* acc ) {
+    return Ops::PackUnsigned16(
+      Ops::PackSigned32( Round<SHIFT>(acc[0]), Round<SHIFT>(acc[1]) ),
+      Ops::PackSigned32( Round<SHIFT>(acc[2]), Round<SHIFT>(acc[3]) ) );
+  }
+
+ protected:
+  typedef WideningOps<VecT> Ops;
+
+  //Round to nearest, then arithmetic shift
+  template<int SHIFT>
+  static VecT Round( VecT value ) {
+    if (SHIFT == 0) {
+      return value;
+    }
+    return Ops::template ShiftRight32<SHIFT>( Ops::Add32( value,
+      Ops::Set1_32( (1 << SHIFT) >> 1 ) ) );
+  }
+};
+
+template<class VecT>
+class WideningMultiplyAccumulate<int16_t,VecT> :
+    public WideningMultiplyAccumulate<uint8_t,VecT> {
+ public:
+  //Each 16 bits vector spans 2 vectors of 32 bits
+  constexpr static int NbAccumulator = 2;
+
+  static void Accumulate( VecT a, VecT b, VecT coefs, VecT* acc ) {
+    acc[0] = Ops::Add32( acc[0],
+      Ops::MulAddPairs( Ops::UnpackLo16( a, b ), coefs ) );
+    acc[1] = Ops::Add32( acc[1],
+      Ops::MulAddPairs( Ops::UnpackHi16( a, b ), coefs ) );
+  }
+
+  template<int SHIFT>
+  static VecT Finalize( VecT* acc ) {
+    return Ops::PackSigned32( Base::template Round<SHIFT>(acc[0]),
+      Base::template Round<SHIFT>(acc[1]) );
+  }
+
+ protected:
+  typedef WideningMultiplyAccumulate<uint8_t,VecT> Base;
+  typedef WideningOps<VecT> Ops;
+};
+
+VECTORIZATION_NAMESPACE_END
+#endif //WIDENINGARITHMETIC_H
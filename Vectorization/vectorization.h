@@ -10,6 +10,7 @@
 
 // STL
 #include <cassert>
+#include <cstdint>
 #include <exception>
 #include <vector>
 
@@ -25,32 +26,80 @@
  * https://gcc.gnu.org/onlinedocs/gcc-4.8.5/gcc/ARM-NEON-Intrinsics.html
  */
 #ifdef USE_AVX 			//compile using g++ -std=c++11 -mavx -O3
-  #include "xmmintrin.h"
-  #include "emmintrin.h"
+  #include "immintrin.h" //sse up to 4.2 and avx 128 bits variants
 #elif defined USE_AVX2 	//compile using g++ -std=c++11 -march=core-avx2 -O3
   #include "immintrin.h"
 #elif defined USE_AVX512 //compile using g++ -std=c++11 -mfma -mavx512f -O3 or
                          // -march=knl or -march=skylake-avx512
-  #include "zmmintrin.h"
+  #include "immintrin.h" //zmmintrin.h cannot be included directly
 #elif defined USE_NEON 	//compile using g++-arm-linux-gnu.x86_64 -std=c++11 -mfpu=neon -O3
   #include <arm_neon.h>
 #endif
 
+/*
+ * Every flavour of the vectorized headers is declared inside an inline
+ * namespace named after the instruction set it has been compiled for.
+ * User code does not see the difference, but translation units compiled
+ * with different USE_XXX flags can then be linked into a single binary
+ * without clashing template instances (see RuntimeDispatch example).
+ * The 128 bits path is named after the highest instruction set the compiler
+ * was allowed to use, so that a -msse4.1 and a -mavx build can coexist.
+ * Only the code of these headers is renamed: out of line STL or boost
+ * functions, that unoptimized builds do not inline, are still merged by the
+ * linker across flavours, such translation units are thus to be built with
+ * -O1 or higher, or linked as separate shared objects.
+ */
+#ifdef USE_AVX
+  #ifdef __AVX__
+    #define VECTORIZATION_ISA avx
+  #else
+    #define VECTORIZATION_ISA sse
+  #endif
+#elif defined USE_AVX2
+  #define VECTORIZATION_ISA avx2
+#elif defined USE_AVX512
+  #define VECTORIZATION_ISA avx512
+#elif defined USE_NEON
+  #define VECTORIZATION_ISA neon
+#else
+  #define VECTORIZATION_ISA scalar
+#endif
+#define VECTORIZATION_NAMESPACE_BEGIN inline namespace VECTORIZATION_ISA {
+#define VECTORIZATION_NAMESPACE_END }
+
 /**
 Check vectorization with:
 gcc -g -c test.c
 objdump -d -M intel -S test.o */
 
 
+VECTORIZATION_NAMESPACE_BEGIN
+
 //Specialize Packed types when they exist
 template<typename T> struct PackedType { typedef T type; };//Default packed type is... not packed
 
+//Integer types all share the same vector type, VectorizedMemOp and others
+//are thus specialized on both the scalar and the vector type
 #ifdef USE_AVX
   template<> struct PackedType<float> { using type = __m128; };
   template<> struct PackedType<double> { using type = __m128d; };
+  template<> struct PackedType<uint8_t> { using type = __m128i; };
+  template<> struct PackedType<int16_t> { using type = __m128i; };
+  template<> struct PackedType<int32_t> { using type = __m128i; };
 #elif defined USE_AVX2
   template<> struct PackedType<float> { using type = __m256; };
   template<> struct PackedType<double> { using type = __m256d; };
+  template<> struct PackedType<uint8_t> { using type = __m256i; };
+  template<> struct PackedType<int16_t> { using type = __m256i; };
+  template<> struct PackedType<int32_t> { using type = __m256i; };
+#elif defined USE_AVX512
+  template<> struct PackedType<float> { using type = __m512; };
+  template<> struct PackedType<double> { using type = __m512d; };
+  template<> struct PackedType<int32_t> { using type = __m512i; };
+  #ifdef __AVX512BW__ //8 and 16 bits arithmetic on 512 bits
+  template<> struct PackedType<uint8_t> { using type = __m512i; };
+  template<> struct PackedType<int16_t> { using type = __m512i; };
+  #endif
 #elif defined USE_NEON
   template<> struct PackedType<float> { using type = float32x4_t; };
   template<> struct PackedType<double> { using type = float64x2_t; };
@@ -59,4 +108,6 @@ template<typename T> using PackType = typename PackedType<T>::type;
 template<typename T> using PackAllocator =
   boost::alignment::aligned_allocator<T,sizeof(PackType<T>)>;
 
+VECTORIZATION_NAMESPACE_END
+
 #endif /* VECTORIZATION_H_ */